@@ -0,0 +1,139 @@
+
+/*
+ * hocr_bench.c
+ *
+ * timing example for the hebocr bitmap morphology.
+ * compile:
+ *    gcc -I /usr/include/hebocr -I ../checks -lm -lhebocr -o hocr_bench \
+ *      hocr_bench.c ../checks/hocr_check_page.c
+ *
+ * usage: hocr_bench [IMAGE_FILENAME]
+ *
+ * with no image the one column text page of the regression checks is drawn
+ * at 2480x3508 pixels (A4 at 300 dpi), each operation runs a few times and
+ * the best time is printed.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <sys/time.h>
+#include <hocr.h>
+
+#include "hocr_check_page.h"
+
+/* times each operation is run, the best time is printed */
+#define HOCR_BENCH_RUNS 5
+
+/*
+ * wall clock in milliseconds
+ */
+static double
+hocr_bench_now ()
+{
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+/*
+ * run op on m and print the best time
+ */
+static void
+hocr_bench_run (const char *name, const ho_bitmap * m,
+  ho_bitmap * (*op) (const ho_bitmap *))
+{
+  ho_bitmap *m_out = NULL;
+  double start, time, best = 0.0;
+  int i;
+
+  for (i = 0; i < HOCR_BENCH_RUNS; i++)
+  {
+    start = hocr_bench_now ();
+    m_out = op (m);
+    time = hocr_bench_now () - start;
+
+    if (!m_out)
+    {
+      printf ("%-10s failed\n", name);
+      return;
+    }
+    ho_bitmap_free (m_out);
+
+    if (i == 0 || time < best)
+      best = time;
+  }
+
+  printf ("%-10s %8.2f ms\n", name, best);
+}
+
+static ho_bitmap *
+hocr_bench_dilation_3 (const ho_bitmap * m)
+{
+  return ho_bitmap_dilation_n (m, 3);
+}
+
+static ho_bitmap *
+hocr_bench_erosion_3 (const ho_bitmap * m)
+{
+  return ho_bitmap_erosion_n (m, 3);
+}
+
+int
+main (int argc, char *argv[])
+{
+  ho_pixbuf *pix = NULL;
+  ho_bitmap *m = NULL;
+
+  /* load the pnm picture pointed to by argv[1], or draw a page */
+  if (argc > 1)
+  {
+    pix = ho_pixbuf_pnm_load (argv[1]);
+    if (!pix)
+    {
+      fprintf (stderr, "can't read input image\n");
+      return 1;
+    }
+
+    m = ho_pixbuf_to_bitmap (pix, 0);
+    ho_pixbuf_free (pix);
+  }
+  else
+    m = hocr_check_page_new (2480, 3508, 1, 0.0, 1);
+
+  if (!m)
+  {
+    fprintf (stderr, "can't create bitmap\n");
+    return 1;
+  }
+
+  printf ("bitmap %d by %d pixels, best of %d runs\n", m->width, m->height,
+    HOCR_BENCH_RUNS);
+
+  hocr_bench_run ("dilation", m, ho_bitmap_dilation);
+  hocr_bench_run ("erosion", m, ho_bitmap_erosion);
+  hocr_bench_run ("dilation3", m, hocr_bench_dilation_3);
+  hocr_bench_run ("erosion3", m, hocr_bench_erosion_3);
+  hocr_bench_run ("opening", m, ho_bitmap_opening);
+  hocr_bench_run ("closing", m, ho_bitmap_closing);
+
+  /* free bitmap */
+  ho_bitmap_free (m);
+
+  return 0;
+}
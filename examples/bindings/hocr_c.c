@@ -11,6 +11,9 @@
  *    gcc -I $HEBOCR_PREFIX/include/libhebocr/ -L $HEBOCR_PREFIX/lib/ -lm -lhebocr -o hocr_c hocr_c.c
  *    LD_LIBRARY_PATH=$HEBOCR_PREFIX/lib ./hocr_c
  *
+ * to read multi page tiff files, if hebocr was built with libtiff:
+ *    gcc -DUSE_TIFF -I /usr/include/hebhocr -lm -lhebocr -o hocr_c hocr_c.c
+ *
  * usage: hocr_c IMAGE_FILENAME
  *
  * Copyright (C) 2008  Yaacov Zamir <kzamir@walla.co.il>
@@ -38,28 +41,52 @@ int
 main (int argc, char *argv[])
 {
   ho_pixbuf *pix = NULL;
+  ho_bitmap *m = NULL;
   ho_string *text = NULL;
   int progress;
 
-  /* load the pnm picture pointed to by argv[1] */
-  /* NOTE: this function only load pnm images, you can use the hocr-gtk
-   * functions to load other image types */
-  pix = ho_pixbuf_pnm_load (argv[1]);
-
   /* get a new text buffer */
   text = ho_string_new ();
 
-  /* do ocr on picture */
-  /* NOTE: we do not use the progress indicator in this program. to use it,
-   * create a new thread and sample the value of progress periodically */
-  hocr_do_ocr (pix, text, 0, 0, 0, &progress);
+  /* a 1 bpp pbm picture is read straight to a b/w bitmap, and is not
+   * thresholded again */
+  m = ho_pixbuf_pnm_load_bitmap (argv[1]);
+  if (m)
+  {
+    /* do ocr on bitmap */
+    hocr_do_ocr_bitmap (m, text, 0, 0, 0, &progress);
+
+    /* free bitmap */
+    ho_bitmap_free (m);
+  }
+  else
+  {
+    /* load the pnm picture pointed to by argv[1] */
+    /* NOTE: this function only load pnm images, you can use the hocr-gtk
+     * functions to load other image types */
+    pix = ho_pixbuf_pnm_load (argv[1]);
+
+    /* do ocr on picture */
+    /* NOTE: we do not use the progress indicator in this program. to use
+     * it, create a new thread and sample the value of progress
+     * periodically */
+    if (pix)
+    {
+      hocr_do_ocr (pix, text, 0, 0, 0, &progress);
+
+      /* free picture */
+      ho_pixbuf_free (pix);
+    }
+#ifdef USE_TIFF
+    /* if this is not a pnm image file, do ocr on all the tiff pages */
+    else
+      hocr_do_ocr_tiff (argv[1], text, 0, 0, 0, &progress);
+#endif /* USE_TIFF */
+  }
 
   /* print out the text */
   printf ("%s\n", text->string);
 
-  /* free picture */
-  ho_pixbuf_free (pix);
-
   /* free string */
   ho_string_free (text);
 
@@ -0,0 +1,195 @@
+/*
+ * hocr_check_flat.c
+ *
+ * regression check for the flat page layout.
+ *
+ * usage: hocr_check_flat
+ *
+ * text pages are layed out, and the flat copy of each layout is read back
+ * word by word and font by font against the layout it was made from,
+ * the program returns 0 if the flat layouts hold the same text.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <hocr.h>
+#include <ho_layout.h>
+
+#include "hocr_check_page.h"
+
+/*
+ * TRUE if a bitmap and the text in a view are not the same, m is freed
+ */
+static int
+hocr_check_flat_view_diff (ho_bitmap * m, const ho_bitmap_view * v)
+{
+  ho_bitmap *m_view = NULL;
+  int diff;
+
+  m_view = ho_bitmap_new_from_view (v);
+  diff = (!m || !m_view || hocr_check_page_diff (m, m_view));
+
+  if (m)
+    ho_bitmap_free (m);
+  if (m_view)
+    ho_bitmap_free (m_view);
+
+  return diff;
+}
+
+/*
+ * TRUE if two bitmaps are not the same, both are freed
+ */
+static int
+hocr_check_flat_mask_diff (ho_bitmap * m_1, ho_bitmap * m_2)
+{
+  int diff;
+
+  diff = (!m_1 || !m_2 || hocr_check_page_diff (m_1, m_2));
+
+  if (m_1)
+    ho_bitmap_free (m_1);
+  if (m_2)
+    ho_bitmap_free (m_2);
+
+  return diff;
+}
+
+/*
+ * number of differences between a layout and its flat copy
+ */
+static int
+hocr_check_flat_diff (const ho_layout * l_page, const ho_layout_flat * l_flat)
+{
+  ho_bitmap_view v;
+  int block_index, line_index, word_index, font_index;
+  int line = 0;
+  int word = 0;
+  int font = 0;
+  int errors = 0;
+
+  if (l_flat->n_blocks != l_page->n_blocks)
+    return 1;
+
+  for (block_index = 0; block_index < l_page->n_blocks; block_index++)
+  {
+    if (l_flat->blocks[block_index].first_line != line
+      || l_flat->blocks[block_index].n_lines != l_page->n_lines[block_index])
+      return errors + 1;
+
+    for (line_index = 0; line_index < l_page->n_lines[block_index];
+      line_index++, line++)
+    {
+      if (l_flat->lines[line].block != block_index
+        || l_flat->lines[line].first_word != word
+        || l_flat->lines[line].n_words !=
+        l_page->n_words[block_index][line_index])
+        return errors + 1;
+
+      for (word_index = 0;
+        word_index < l_page->n_words[block_index][line_index];
+        word_index++, word++)
+      {
+        if (l_flat->words[word].line != line
+          || l_flat->words[word].first_font != font
+          || l_flat->words[word].n_fonts !=
+          l_page->n_fonts[block_index][line_index][word_index])
+          return errors + 1;
+
+        ho_layout_flat_get_word_view (l_flat, word, &v);
+        errors += hocr_check_flat_view_diff (ho_layout_get_word_text (l_page,
+            block_index, line_index, word_index), &v);
+
+        for (font_index = 0;
+          font_index < l_page->n_fonts[block_index][line_index][word_index];
+          font_index++, font++)
+        {
+          if (l_flat->fonts[font].word != word)
+            return errors + 1;
+
+          ho_layout_flat_get_font_view (l_flat, font, &v);
+          errors +=
+            hocr_check_flat_view_diff (ho_layout_get_font_text (l_page,
+              block_index, line_index, word_index, font_index), &v);
+          errors +=
+            hocr_check_flat_mask_diff (ho_layout_get_font_line_mask (l_page,
+              block_index, line_index, word_index, font_index),
+            ho_layout_flat_get_font_line_mask (l_flat, font));
+        }
+      }
+    }
+  }
+
+  /* nothing is left over at the end of the arrays */
+  if (l_flat->n_lines != line || l_flat->n_words != word
+    || l_flat->n_fonts != font)
+    errors++;
+
+  return errors;
+}
+
+int
+main ()
+{
+  const int n_columns[] = { 1, 3 };
+  HEBOCR_LAYOUT_OPTIONS layout_options;
+  ho_bitmap *m = NULL;
+  ho_layout *l_page = NULL;
+  ho_layout_flat *l_flat = NULL;
+  int i, errors, progress;
+  int failures = 0;
+
+  memset (&layout_options, 0, sizeof (layout_options));
+  layout_options.threads = 1;
+
+  for (i = 0; i < 2; i++)
+  {
+    m = hocr_check_page_new (1240, 1754, n_columns[i], 0.0, i + 1);
+    if (!m)
+    {
+      printf ("can't create bitmap\n");
+      return 1;
+    }
+
+    l_page = hocr_layout_analysis (m, &layout_options, &progress);
+    ho_bitmap_free (m);
+    l_flat = (l_page) ? ho_layout_flat_new (l_page) : NULL;
+    if (!l_flat)
+    {
+      printf ("%d columns: can't make layout\n", n_columns[i]);
+      if (l_page)
+        ho_layout_free (l_page);
+      failures++;
+      continue;
+    }
+
+    errors = hocr_check_flat_diff (l_page, l_flat);
+    printf ("%d columns, %d lines, %d words, %d fonts: %s\n", n_columns[i],
+      l_flat->n_lines, l_flat->n_words, l_flat->n_fonts,
+      (errors) ? "FAIL" : "ok");
+    if (errors)
+      failures++;
+
+    ho_layout_flat_free (l_flat);
+    ho_layout_free (l_page);
+  }
+
+  printf ("flat layout: %s\n", (failures) ? "FAIL" : "ok");
+
+  return (failures) ? 1 : 0;
+}
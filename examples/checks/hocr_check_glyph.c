@@ -0,0 +1,207 @@
+/*
+ * hocr_check_glyph.c
+ *
+ * regression check for the shared glyph context of the recognizers.
+ *
+ * usage: hocr_check_glyph
+ *
+ * the features of each font of a text page are read once with the bitmap
+ * recognizers, each on its own glyph context, and once with all the glyph
+ * recognizers on one shared context, in the opposite order,
+ * the program returns 0 if all the features are the same.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <hocr.h>
+#include <ho_layout.h>
+#include <ho_font.h>
+#include <ho_recognize.h>
+
+#include "hocr_check_page.h"
+
+/* number of features read by all the recognizers */
+#define HOCR_CHECK_GLYPH_N_FEATURES 103
+
+/*
+ * read all the features with the bitmap recognizers
+ */
+static int
+hocr_check_glyph_bitmap_features (const ho_bitmap * m_text,
+  const ho_bitmap * m_mask, double *f)
+{
+  int return_val = FALSE;
+
+  return_val |= ho_recognize_dimentions (m_text, m_mask, f, f + 1, f + 2,
+    f + 3, f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11, f + 12,
+    f + 13, f + 14, f + 15);
+  f += 16;
+  return_val |= ho_recognize_bars (m_text, m_mask, f, f + 1, f + 2, f + 3,
+    f + 4, f + 5, f + 6, f + 7);
+  f += 8;
+  return_val |= ho_recognize_edges (m_text, m_mask, f, f + 1, f + 2, f + 3,
+    f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11);
+  f += 12;
+  return_val |= ho_recognize_edges_big (m_text, m_mask, f, f + 1, f + 2,
+    f + 3, f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11);
+  f += 12;
+  return_val |= ho_recognize_notches (m_text, m_mask, f, f + 1, f + 2, f + 3,
+    f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11);
+  f += 12;
+  return_val |= ho_recognize_parts (m_text, m_mask, f, f + 1, f + 2, f + 3,
+    f + 4);
+  f += 5;
+  return_val |= ho_recognize_ends (m_text, m_mask, f, f + 1, f + 2, f + 3,
+    f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11, f + 12, f + 13,
+    f + 14, f + 15, f + 16, f + 17);
+  f += 18;
+  return_val |= ho_recognize_holes_dimentions (m_text, m_mask, f, f + 1,
+    f + 2, f + 3, f + 4, f + 5, f + 6, f + 7);
+  f += 8;
+  return_val |= ho_recognize_holes_edges (m_text, m_mask, f, f + 1, f + 2,
+    f + 3, f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11);
+
+  return return_val;
+}
+
+/*
+ * read all the features with the glyph recognizers on one context, last
+ * recognizer first
+ */
+static int
+hocr_check_glyph_ctx_features (const ho_bitmap * m_text,
+  const ho_bitmap * m_mask, double *f)
+{
+  ho_glyph_ctx *glyph = NULL;
+  int return_val = FALSE;
+
+  glyph = ho_glyph_ctx_new (m_text, m_mask);
+  if (!glyph)
+    return TRUE;
+
+  f += HOCR_CHECK_GLYPH_N_FEATURES - 12;
+  return_val |= ho_recognize_glyph_holes_edges (glyph, f, f + 1, f + 2,
+    f + 3, f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11);
+  f -= 8;
+  return_val |= ho_recognize_glyph_holes_dimentions (glyph, f, f + 1, f + 2,
+    f + 3, f + 4, f + 5, f + 6, f + 7);
+  f -= 18;
+  return_val |= ho_recognize_glyph_ends (glyph, f, f + 1, f + 2, f + 3,
+    f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11, f + 12, f + 13,
+    f + 14, f + 15, f + 16, f + 17);
+  f -= 5;
+  return_val |= ho_recognize_glyph_parts (glyph, f, f + 1, f + 2, f + 3,
+    f + 4);
+  f -= 12;
+  return_val |= ho_recognize_glyph_notches (glyph, f, f + 1, f + 2, f + 3,
+    f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11);
+  f -= 12;
+  return_val |= ho_recognize_glyph_edges_big (glyph, f, f + 1, f + 2, f + 3,
+    f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11);
+  f -= 12;
+  return_val |= ho_recognize_glyph_edges (glyph, f, f + 1, f + 2, f + 3,
+    f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11);
+  f -= 8;
+  return_val |= ho_recognize_glyph_bars (glyph, f, f + 1, f + 2, f + 3,
+    f + 4, f + 5, f + 6, f + 7);
+  f -= 16;
+  return_val |= ho_recognize_glyph_dimentions (glyph, f, f + 1, f + 2,
+    f + 3, f + 4, f + 5, f + 6, f + 7, f + 8, f + 9, f + 10, f + 11, f + 12,
+    f + 13, f + 14, f + 15);
+
+  ho_glyph_ctx_free (glyph);
+
+  return return_val;
+}
+
+int
+main ()
+{
+  HEBOCR_LAYOUT_OPTIONS layout_options;
+  ho_bitmap *m = NULL;
+  ho_layout *l_page = NULL;
+  ho_layout_flat *l_flat = NULL;
+  ho_bitmap_view v_text;
+  ho_bitmap *m_text = NULL;
+  ho_bitmap *m_mask = NULL;
+  double f_bitmap[HOCR_CHECK_GLYPH_N_FEATURES];
+  double f_glyph[HOCR_CHECK_GLYPH_N_FEATURES];
+  int i, progress;
+  int n_glyphs = 0;
+  int failures = 0;
+
+  memset (&layout_options, 0, sizeof (layout_options));
+  layout_options.threads = 1;
+
+  m = hocr_check_page_new (1240, 1754, 2, 0.0, 1);
+  if (!m)
+  {
+    printf ("can't create bitmap\n");
+    return 1;
+  }
+
+  l_page = hocr_layout_analysis (m, &layout_options, &progress);
+  ho_bitmap_free (m);
+  l_flat = (l_page) ? ho_layout_flat_new (l_page) : NULL;
+  if (l_page)
+    ho_layout_free (l_page);
+  if (!l_flat)
+  {
+    printf ("can't make layout\n");
+    return 1;
+  }
+
+  for (i = 0; i < l_flat->n_fonts; i++)
+  {
+    ho_layout_flat_get_font_view (l_flat, i, &v_text);
+    m_mask = ho_layout_flat_get_font_line_mask (l_flat, i);
+    m_text = (m_mask) ? ho_font_main_sign_view (&v_text, m_mask) : NULL;
+
+    if (m_text)
+    {
+      /* unset features stay the same in both */
+      memset (f_bitmap, 0, sizeof (f_bitmap));
+      memset (f_glyph, 0, sizeof (f_glyph));
+
+      if (hocr_check_glyph_bitmap_features (m_text, m_mask, f_bitmap) !=
+        hocr_check_glyph_ctx_features (m_text, m_mask, f_glyph)
+        || memcmp (f_bitmap, f_glyph, sizeof (f_bitmap)))
+      {
+        printf ("font %d: FAIL\n", i);
+        failures++;
+      }
+
+      n_glyphs++;
+      ho_bitmap_free (m_text);
+    }
+
+    if (m_mask)
+      ho_bitmap_free (m_mask);
+  }
+
+  ho_layout_flat_free (l_flat);
+
+  /* a page with no fonts checks nothing */
+  if (n_glyphs == 0)
+    failures++;
+
+  printf ("glyph context, %d fonts: %s\n", n_glyphs,
+    (failures) ? "FAIL" : "ok");
+
+  return (failures) ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+
+/*
+ * hocr_check_layout.c
+ *
+ * regression check for the threaded layout analysis.
+ *
+ * usage: hocr_check_layout
+ *
+ * the layout of text pages is made on one thread, on several threads and
+ * with thread counts out of range, the program returns 0 if all the
+ * layouts are the same.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <hocr.h>
+#include <ho_layout.h>
+
+#include "hocr_check_page.h"
+
+/*
+ * number of differences between two layouts of the same page
+ */
+static int
+hocr_check_layout_diff (const ho_layout * l_1, const ho_layout * l_2)
+{
+  ho_layout_flat *f_1 = NULL;
+  ho_layout_flat *f_2 = NULL;
+  int i, j;
+  int errors = 0;
+
+  /* the masks the threads make */
+  if (hocr_check_page_diff (l_1->m_page_blocks_mask,
+      l_2->m_page_blocks_mask))
+    errors++;
+
+  if (l_1->n_blocks != l_2->n_blocks)
+    return errors + 1;
+
+  for (i = 0; i < l_1->n_blocks; i++)
+  {
+    if (hocr_check_page_diff (l_1->m_blocks_lines_mask[i],
+        l_2->m_blocks_lines_mask[i]))
+      errors++;
+
+    if (l_1->n_lines[i] != l_2->n_lines[i])
+    {
+      errors++;
+      continue;
+    }
+
+    for (j = 0; j < l_1->n_lines[i]; j++)
+      if (hocr_check_page_diff (l_1->m_lines_words_mask[i][j],
+          l_2->m_lines_words_mask[i][j]))
+        errors++;
+  }
+
+  /* the blocks, lines, words and fonts found in the masks */
+  f_1 = ho_layout_flat_new (l_1);
+  f_2 = ho_layout_flat_new (l_2);
+  if (!f_1 || !f_2)
+    errors++;
+  else if (f_1->n_blocks != f_2->n_blocks || f_1->n_lines != f_2->n_lines
+    || f_1->n_words != f_2->n_words || f_1->n_fonts != f_2->n_fonts)
+    errors++;
+  else
+  {
+    if (memcmp (f_1->blocks, f_2->blocks,
+        f_1->n_blocks * sizeof (ho_layout_block)))
+      errors++;
+    if (memcmp (f_1->words, f_2->words,
+        f_1->n_words * sizeof (ho_layout_word)))
+      errors++;
+    if (memcmp (f_1->fonts, f_2->fonts,
+        f_1->n_fonts * sizeof (ho_layout_font)))
+      errors++;
+
+    /* lines hold a mask, compare its pixels and not its data pointer */
+    for (i = 0; i < f_1->n_lines; i++)
+      if (memcmp (&(f_1->lines[i]), &(f_2->lines[i]),
+          offsetof (ho_layout_line, m_line_mask))
+        || hocr_check_page_diff (&(f_1->lines[i].m_line_mask),
+          &(f_2->lines[i].m_line_mask)))
+        errors++;
+  }
+
+  if (f_1)
+    ho_layout_flat_free (f_1);
+  if (f_2)
+    ho_layout_flat_free (f_2);
+
+  return errors;
+}
+
+int
+main ()
+{
+  const int n_columns[] = { 1, 3 };
+  /* out of range values are taken as one thread */
+  const int n_threads[] = { 2, 4, 7, 0, -3, HEBOCR_MAX_THREADS + 1 };
+  const int n_runs = sizeof (n_threads) / sizeof (n_threads[0]);
+  HEBOCR_LAYOUT_OPTIONS layout_options;
+  ho_bitmap *m = NULL;
+  ho_layout *l_one = NULL;
+  ho_layout *l_many = NULL;
+  int i, j, errors, progress;
+  int failures = 0;
+
+  memset (&layout_options, 0, sizeof (layout_options));
+
+  for (i = 0; i < 2; i++)
+  {
+    m = hocr_check_page_new (1240, 1754, n_columns[i], 0.0, i + 1);
+    if (!m)
+    {
+      printf ("can't create bitmap\n");
+      return 1;
+    }
+
+    layout_options.threads = 1;
+    l_one = hocr_layout_analysis (m, &layout_options, &progress);
+    if (!l_one)
+    {
+      printf ("%d columns: can't make layout\n", n_columns[i]);
+      ho_bitmap_free (m);
+      failures++;
+      continue;
+    }
+
+    for (j = 0; j < n_runs; j++)
+    {
+      layout_options.threads = n_threads[j];
+      l_many = hocr_layout_analysis (m, &layout_options, &progress);
+      if (!l_many)
+      {
+        printf ("%d columns, %d threads: can't make layout\n", n_columns[i],
+          n_threads[j]);
+        failures++;
+        continue;
+      }
+
+      errors = hocr_check_layout_diff (l_one, l_many);
+      printf ("%d columns, %d blocks, %d threads: %s\n", n_columns[i],
+        l_one->n_blocks, n_threads[j], (errors) ? "FAIL" : "ok");
+      if (errors)
+        failures++;
+
+      ho_layout_free (l_many);
+    }
+
+    ho_layout_free (l_one);
+    ho_bitmap_free (m);
+  }
+
+  printf ("layout threads: %s\n", (failures) ? "FAIL" : "ok");
+
+  return (failures) ? 1 : 0;
+}
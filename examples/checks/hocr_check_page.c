@@ -0,0 +1,112 @@
+
+/*
+ * hocr_check_page.c
+ *
+ * synthetic text pages for the hebocr regression checks.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <math.h>
+#include <hocr.h>
+
+#include "hocr_check_page.h"
+
+/* page margins and line pitch in pixels */
+#define HOCR_CHECK_PAGE_MARGIN 150
+#define HOCR_CHECK_PAGE_LINE_PITCH 60
+#define HOCR_CHECK_PAGE_FONT_HEIGHT 30
+
+ho_bitmap *
+hocr_check_page_new (const int width, const int height, const int n_columns,
+  const double angle, unsigned int seed)
+{
+  ho_bitmap *m = NULL;
+  double slope;
+  int x, y, y_font, font_width;
+  int column, column_width, x_start, x_end;
+
+  m = ho_bitmap_new (width, height);
+  if (!m)
+    return NULL;
+
+  /* lines rise to the right, and y grows down the page */
+  slope = -tan (M_PI * angle / 180.0);
+
+  /* columns are a margin apart */
+  column_width = (width - (n_columns + 1) * HOCR_CHECK_PAGE_MARGIN)
+    / n_columns;
+
+  for (column = 0; column < n_columns; column++)
+  {
+    x_start = HOCR_CHECK_PAGE_MARGIN
+      + column * (column_width + HOCR_CHECK_PAGE_MARGIN);
+    x_end = x_start + column_width;
+
+    for (y = HOCR_CHECK_PAGE_MARGIN; y < height - HOCR_CHECK_PAGE_MARGIN;
+      y += HOCR_CHECK_PAGE_LINE_PITCH)
+      for (x = x_start; x < x_end; x += font_width)
+      {
+        seed = seed * 1103515245 + 12345;
+        font_width = 18 + (seed >> 16) % 12;
+
+        /* a space between words */
+        if ((seed >> 8) % 7 == 0)
+          continue;
+
+        y_font = y + (int) floor (slope * (x - width / 2) + 0.5);
+        if (y_font < 0 || y_font + HOCR_CHECK_PAGE_FONT_HEIGHT >= height)
+          continue;
+
+        ho_bitmap_draw_box (m, x, y_font, font_width - 6,
+          HOCR_CHECK_PAGE_FONT_HEIGHT);
+        ho_bitmap_delete_hline (m, x + 4, y_font + 10, font_width - 14);
+        ho_bitmap_delete_vline (m, x + 4 + (seed >> 4) % 8, y_font + 4,
+          20);
+      }
+  }
+
+  return m;
+}
+
+int
+hocr_check_page_diff (const ho_bitmap * m_1, const ho_bitmap * m_2)
+{
+  int x, y;
+  int errors = 0;
+
+  if (!m_1 || !m_2)
+    return (m_1 == m_2) ? 0 : -1;
+
+  if (m_1->width != m_2->width || m_1->height != m_2->height)
+    return -1;
+
+  for (y = 0; y < m_1->height; y++)
+  {
+    /* most rows are the same, only count pixels of rows that are not */
+    if (m_1->rowstride == m_2->rowstride
+      && !memcmp (m_1->data + y * m_1->rowstride,
+        m_2->data + y * m_2->rowstride, m_1->rowstride))
+      continue;
+
+    for (x = 0; x < m_1->width; x++)
+      if (ho_bitmap_get (m_1, x, y) != ho_bitmap_get (m_2, x, y))
+        errors++;
+  }
+
+  return errors;
+}
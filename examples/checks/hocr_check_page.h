@@ -0,0 +1,50 @@
+
+/*
+ * hocr_check_page.h
+ *
+ * synthetic text pages for the hebocr regression checks.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOCR_CHECK_PAGE_H
+#define HOCR_CHECK_PAGE_H 1
+
+#include <hocr.h>
+
+/**
+ draw a page of text lines, words are made of font sized boxes with holes
+ and strokes, the same seed draws the same page
+ @param width page width in pixels
+ @param height page height in pixels
+ @param n_columns number of text columns side by side
+ @param angle angle of the lines in deg., positive if lines rise to the right
+ @param seed seed of the random glyph shapes
+ @return newly allocated ho_bitmap
+ */
+ho_bitmap *hocr_check_page_new (const int width, const int height,
+  const int n_columns, const double angle, unsigned int seed);
+
+/**
+ compare two bitmaps pixel by pixel
+ @param m_1 pointer to an ho_bitmap or NULL
+ @param m_2 pointer to an ho_bitmap or NULL
+ @return number of pixels that differ, -1 if the sizes differ or only one
+  bitmap is NULL
+ */
+int hocr_check_page_diff (const ho_bitmap * m_1, const ho_bitmap * m_2);
+
+#endif /* HOCR_CHECK_PAGE_H */
@@ -0,0 +1,161 @@
+
+/*
+ * hocr_check_pnm.c
+ *
+ * regression check for the pnm loaders.
+ *
+ * usage: hocr_check_pnm
+ *
+ * a text page is written as a 1 bpp (P4) and as a gray (P5) pnm file,
+ * and read back with the copying, the mapping and the bitmap loaders, the
+ * program returns 0 if all the loaders read the same page.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <hocr.h>
+
+#include "hocr_check_page.h"
+
+#define HOCR_CHECK_PNM_P4 "hocr_check_pnm.pbm"
+#define HOCR_CHECK_PNM_P5 "hocr_check_pnm.pgm"
+
+/*
+ * write m as a P4 file, black pixels are 1 as in the bitmap rows
+ */
+static int
+hocr_check_pnm_save_p4 (const ho_bitmap * m, const char *filename)
+{
+  FILE *file = NULL;
+  int y;
+
+  file = fopen (filename, "wb");
+  if (!file)
+    return TRUE;
+
+  /* a comment in the header, as some scanners write */
+  fprintf (file, "P4\n# hocr check\n%d %d\n", m->width, m->height);
+  for (y = 0; y < m->height; y++)
+    fwrite (m->data + y * m->rowstride, 1, (m->width + 7) / 8, file);
+
+  fclose (file);
+
+  return FALSE;
+}
+
+/*
+ * number of differences between two gray pixbufs
+ */
+static int
+hocr_check_pnm_pixbuf_diff (const ho_pixbuf * pix_1, const ho_pixbuf * pix_2)
+{
+  int y;
+  int errors = 0;
+
+  if (!pix_1 || !pix_2 || pix_1->width != pix_2->width
+    || pix_1->height != pix_2->height
+    || pix_1->n_channels != pix_2->n_channels)
+    return -1;
+
+  for (y = 0; y < pix_1->height; y++)
+    if (memcmp (pix_1->data + y * pix_1->rowstride,
+        pix_2->data + y * pix_2->rowstride,
+        pix_1->width * pix_1->n_channels))
+      errors++;
+
+  return errors;
+}
+
+int
+main ()
+{
+  ho_bitmap *m = NULL;
+  ho_bitmap *m_load = NULL;
+  ho_bitmap *m_gray = NULL;
+  ho_pixbuf *pix = NULL;
+  ho_pixbuf *pix_load = NULL;
+  ho_pixbuf *pix_map = NULL;
+  int errors;
+  int failures = 0;
+
+  /* an odd width leaves padding bits at the end of the P4 rows */
+  m = hocr_check_page_new (1237, 1754, 2, 0.0, 5);
+  pix = (m) ? ho_pixbuf_new_from_bitmap (m) : NULL;
+  if (!pix)
+  {
+    printf ("can't create page\n");
+    return 1;
+  }
+
+  if (hocr_check_pnm_save_p4 (m, HOCR_CHECK_PNM_P4)
+    || ho_pixbuf_pnm_save (pix, HOCR_CHECK_PNM_P5))
+  {
+    printf ("can't write pnm files\n");
+    return 1;
+  }
+
+  /* a P4 file is read straight to a bitmap */
+  m_load = ho_pixbuf_pnm_load_bitmap (HOCR_CHECK_PNM_P4);
+  errors = hocr_check_page_diff (m, m_load);
+  printf ("P4 bitmap load: %s\n", (errors) ? "FAIL" : "ok");
+  failures += (errors != 0);
+
+  /* and mapped to the same gray page as the bitmap */
+  pix_map = ho_pixbuf_pnm_map (HOCR_CHECK_PNM_P4);
+  m_gray = (pix_map) ? ho_pixbuf_to_bitmap (pix_map, 50) : NULL;
+  errors = hocr_check_page_diff (m, m_gray);
+  printf ("P4 map: %s\n", (errors) ? "FAIL" : "ok");
+  failures += (errors != 0);
+
+  if (m_load)
+    ho_bitmap_free (m_load);
+  if (m_gray)
+    ho_bitmap_free (m_gray);
+  if (pix_map)
+    ho_pixbuf_free (pix_map);
+
+  /* a gray file is not a bitmap */
+  m_load = ho_pixbuf_pnm_load_bitmap (HOCR_CHECK_PNM_P5);
+  printf ("P5 bitmap load: %s\n", (m_load) ? "FAIL" : "ok");
+  failures += (m_load != NULL);
+  if (m_load)
+    ho_bitmap_free (m_load);
+
+  /* the mapped pixels are the same as the copied ones */
+  pix_load = ho_pixbuf_pnm_load (HOCR_CHECK_PNM_P5);
+  pix_map = ho_pixbuf_pnm_map (HOCR_CHECK_PNM_P5);
+  errors = hocr_check_pnm_pixbuf_diff (pix, pix_load)
+    || hocr_check_pnm_pixbuf_diff (pix, pix_map);
+  printf ("P5 load and map: %s\n", (errors) ? "FAIL" : "ok");
+  failures += (errors != 0);
+
+  if (pix_load)
+    ho_pixbuf_free (pix_load);
+  if (pix_map)
+    ho_pixbuf_free (pix_map);
+
+  ho_pixbuf_free (pix);
+  ho_bitmap_free (m);
+
+  remove (HOCR_CHECK_PNM_P4);
+  remove (HOCR_CHECK_PNM_P5);
+
+  printf ("pnm: %s\n", (failures) ? "FAIL" : "ok");
+
+  return (failures) ? 1 : 0;
+}
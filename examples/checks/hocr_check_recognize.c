@@ -0,0 +1,113 @@
+
+/*
+ * hocr_check_recognize.c
+ *
+ * regression check for the threaded font recognition.
+ *
+ * usage: hocr_check_recognize
+ *
+ * the fonts of a text page are recognized on one thread, on several
+ * threads and with thread counts out of range, the program returns 0 if
+ * all the texts are the same.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <hocr.h>
+
+#include "hocr_check_page.h"
+
+int
+main ()
+{
+  /* out of range values are taken as one thread */
+  const int n_threads[] = { 2, 4, 7, 0, -3, HEBOCR_MAX_THREADS + 1 };
+  const int n_runs = sizeof (n_threads) / sizeof (n_threads[0]);
+  HEBOCR_LAYOUT_OPTIONS layout_options;
+  HEBOCR_FONT_OPTIONS font_options;
+  ho_bitmap *m = NULL;
+  ho_layout *l_page = NULL;
+  ho_string *s_one = NULL;
+  ho_string *s_many = NULL;
+  int html, j, failed, progress;
+  int failures = 0;
+
+  memset (&layout_options, 0, sizeof (layout_options));
+  memset (&font_options, 0, sizeof (font_options));
+  font_options.nikud = 1;
+
+  /* two columns, so the text has blocks, lines and words to keep in order */
+  m = hocr_check_page_new (1240, 1754, 2, 0.0, 3);
+  if (!m)
+  {
+    printf ("can't create bitmap\n");
+    return 1;
+  }
+
+  layout_options.threads = 1;
+  l_page = hocr_layout_analysis (m, &layout_options, &progress);
+  ho_bitmap_free (m);
+  if (!l_page)
+  {
+    printf ("can't make layout\n");
+    return 1;
+  }
+
+  for (html = 0; html < 2; html++)
+  {
+    font_options.threads = 1;
+    s_one = ho_string_new ();
+    if (!s_one || hocr_font_recognition (l_page, s_one, &font_options, html,
+        &progress))
+    {
+      printf ("html %d: can't recognize fonts\n", html);
+      failures++;
+      if (s_one)
+        ho_string_free (s_one);
+      continue;
+    }
+
+    for (j = 0; j < n_runs; j++)
+    {
+      font_options.threads = n_threads[j];
+      s_many = ho_string_new ();
+      if (!s_many || hocr_font_recognition (l_page, s_many, &font_options,
+          html, &progress))
+        failed = TRUE;
+      else
+        failed = (s_one->size != s_many->size
+          || strcmp (s_one->string, s_many->string));
+
+      printf ("html %d, %d bytes, %d threads: %s\n", html, s_one->size,
+        n_threads[j], (failed) ? "FAIL" : "ok");
+      if (failed)
+        failures++;
+
+      if (s_many)
+        ho_string_free (s_many);
+    }
+
+    ho_string_free (s_one);
+  }
+
+  ho_layout_free (l_page);
+
+  printf ("recognition threads: %s\n", (failures) ? "FAIL" : "ok");
+
+  return (failures) ? 1 : 0;
+}
@@ -0,0 +1,195 @@
+
+/*
+ * hocr_check_rotate.c
+ *
+ * regression check for the exact quarter turn rotation.
+ *
+ * usage: hocr_check_rotate
+ *
+ * random bitmaps of odd sizes are turned by ho_bitmap_rotate_right_angle
+ * and compared pixel by pixel with a plain per pixel turn, the program
+ * returns 0 if all the turns match.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <hocr.h>
+
+/*
+ * a bitmap of random pixels
+ */
+static ho_bitmap *
+hocr_check_random_new (const int width, const int height, unsigned int seed)
+{
+  ho_bitmap *m = NULL;
+  int x, y;
+
+  m = ho_bitmap_new (width, height);
+  if (!m)
+    return NULL;
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+    {
+      seed = seed * 1103515245 + 12345;
+      if ((seed >> 16) & 1)
+        ho_bitmap_set (m, x, y);
+    }
+
+  return m;
+}
+
+/*
+ * number of pixels where m_out is not m turned clockwise by one quarter
+ * turn, -1 if the sizes do not match
+ */
+static int
+hocr_check_quarter_turn (const ho_bitmap * m, const ho_bitmap * m_out)
+{
+  int x, y;
+  int errors = 0;
+
+  if (m_out->width != m->height || m_out->height != m->width)
+    return -1;
+
+  for (y = 0; y < m_out->height; y++)
+    for (x = 0; x < m_out->width; x++)
+      if (ho_bitmap_get (m_out, x, y) !=
+        ho_bitmap_get (m, y, m->height - 1 - x))
+        errors++;
+
+  return errors;
+}
+
+/*
+ * number of pixels where m_1 and m_2 differ, -1 if the sizes do not match
+ */
+static int
+hocr_check_same (const ho_bitmap * m_1, const ho_bitmap * m_2)
+{
+  int x, y;
+  int errors = 0;
+
+  if (m_1->width != m_2->width || m_1->height != m_2->height)
+    return -1;
+
+  for (y = 0; y < m_1->height; y++)
+    for (x = 0; x < m_1->width; x++)
+      if (ho_bitmap_get (m_1, x, y) != ho_bitmap_get (m_2, x, y))
+        errors++;
+
+  return errors;
+}
+
+/*
+ * check all the turns of one bitmap, return the number of failures
+ */
+static int
+hocr_check_turns (const int width, const int height)
+{
+  ho_bitmap *m = NULL;
+  ho_bitmap *m_turn = NULL;
+  ho_bitmap *m_next = NULL;
+  ho_bitmap *m_back = NULL;
+  int i, errors;
+  int failures = 0;
+
+  m = hocr_check_random_new (width, height, width * 1000 + height);
+  if (!m)
+    return 1;
+
+  /* one turn at a time, four turns come back to m */
+  m_turn = ho_bitmap_rotate_right_angle (m, 0);
+  for (i = 1; m_turn && i <= 4; i++)
+  {
+    m_next = ho_bitmap_rotate_right_angle (m_turn, 1);
+    if (!m_next)
+      break;
+
+    errors = hocr_check_quarter_turn (m_turn, m_next);
+    if (errors)
+    {
+      printf ("%dx%d: turn %d, %d pixels differ\n", width, height, i,
+        errors);
+      failures++;
+    }
+
+    ho_bitmap_free (m_turn);
+    m_turn = m_next;
+  }
+
+  if (!m_turn || i <= 4)
+  {
+    printf ("%dx%d: can't turn bitmap\n", width, height);
+    failures++;
+  }
+  else if (hocr_check_same (m, m_turn))
+  {
+    printf ("%dx%d: four turns are not the same bitmap\n", width, height);
+    failures++;
+  }
+  if (m_turn)
+    ho_bitmap_free (m_turn);
+
+  /* n turns and n - 4 turns, and n turns then -n turns */
+  for (i = -5; i <= 5; i++)
+  {
+    m_turn = ho_bitmap_rotate_right_angle (m, i);
+    m_next = ho_bitmap_rotate_right_angle (m, i - 4);
+    m_back = (m_turn) ? ho_bitmap_rotate_right_angle (m_turn, -i) : NULL;
+
+    if (!m_turn || !m_next || !m_back)
+    {
+      printf ("%dx%d: can't turn bitmap %d times\n", width, height, i);
+      failures++;
+    }
+    else if (hocr_check_same (m_turn, m_next) || hocr_check_same (m, m_back))
+    {
+      printf ("%dx%d: %d turns do not match\n", width, height, i);
+      failures++;
+    }
+
+    if (m_turn)
+      ho_bitmap_free (m_turn);
+    if (m_next)
+      ho_bitmap_free (m_next);
+    if (m_back)
+      ho_bitmap_free (m_back);
+  }
+
+  ho_bitmap_free (m);
+
+  return failures;
+}
+
+int
+main ()
+{
+  /* sizes around the byte and word boundaries of a bitmap row */
+  const int sizes[] = { 1, 7, 8, 9, 63, 64, 65, 130 };
+  const int n_sizes = sizeof (sizes) / sizeof (sizes[0]);
+  int i, j;
+  int failures = 0;
+
+  for (i = 0; i < n_sizes; i++)
+    for (j = 0; j < n_sizes; j++)
+      failures += hocr_check_turns (sizes[i], sizes[j]);
+
+  printf ("quarter turns: %s\n", (failures) ? "FAIL" : "ok");
+
+  return (failures) ? 1 : 0;
+}
@@ -0,0 +1,186 @@
+
+/*
+ * hocr_check_scale.c
+ *
+ * regression check for the gray pixbuf resampler.
+ *
+ * usage: hocr_check_scale
+ *
+ * gray pictures are resampled by ho_pixbuf_resample up and down, and the
+ * sizes and pixels are checked against what a resampler must keep, the
+ * program returns 0 if all the checks pass.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <hocr.h>
+
+/* most a smooth picture may change when scaled up and back down */
+#define HOCR_CHECK_SCALE_ROUND_TRIP 3
+
+/*
+ * a gray picture, flat if step is 0, else a smooth diagonal ramp
+ */
+static ho_pixbuf *
+hocr_check_scale_pixbuf_new (const int width, const int height,
+  const int value, const int step)
+{
+  ho_pixbuf *pix = NULL;
+  int x, y;
+
+  pix = ho_pixbuf_new (1, width, height, 0);
+  if (!pix)
+    return NULL;
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      pix->data[x + y * pix->rowstride] =
+        (unsigned char) ((value + step * (x + y)) % 256);
+
+  return pix;
+}
+
+/*
+ * largest difference between two gray pixbufs, -1 if the sizes differ
+ */
+static int
+hocr_check_scale_diff (const ho_pixbuf * pix_1, const ho_pixbuf * pix_2)
+{
+  int x, y, diff;
+  int max_diff = 0;
+
+  if (pix_1->width != pix_2->width || pix_1->height != pix_2->height)
+    return -1;
+
+  for (y = 0; y < pix_1->height; y++)
+    for (x = 0; x < pix_1->width; x++)
+    {
+      diff = abs (pix_1->data[x + y * pix_1->rowstride] -
+        pix_2->data[x + y * pix_2->rowstride]);
+      if (diff > max_diff)
+        max_diff = diff;
+    }
+
+  return max_diff;
+}
+
+/*
+ * TRUE if a picture of a ramp does not go down along its rows and columns
+ */
+static int
+hocr_check_scale_ramp (const ho_pixbuf * pix)
+{
+  int x, y;
+
+  for (y = 0; y < pix->height; y++)
+    for (x = 0; x < pix->width; x++)
+      if ((x > 0 && pix->data[x + y * pix->rowstride] <
+          pix->data[x - 1 + y * pix->rowstride])
+        || (y > 0 && pix->data[x + y * pix->rowstride] <
+          pix->data[x + (y - 1) * pix->rowstride]))
+        return FALSE;
+
+  return TRUE;
+}
+
+int
+main ()
+{
+  /* factors up, down and rational, as num / den */
+  const int factors[][2] = { {1, 1}, {2, 1}, {3, 1}, {1, 2}, {1, 3},
+  {3, 2}, {2, 3}, {7, 5}, {5, 7}
+  };
+  const int n_factors = sizeof (factors) / sizeof (factors[0]);
+  ho_pixbuf *pix = NULL;
+  ho_pixbuf *pix_flat = NULL;
+  ho_pixbuf *pix_out = NULL;
+  ho_pixbuf *pix_back = NULL;
+  int i, num, den, width, height, diff, failed;
+  int failures = 0;
+
+  /* a ramp that stays below 256, and a flat picture, of odd sizes */
+  pix = hocr_check_scale_pixbuf_new (101, 77, 20, 1);
+  pix_flat = hocr_check_scale_pixbuf_new (101, 77, 137, 0);
+  if (!pix || !pix_flat)
+  {
+    printf ("can't create pixbuf\n");
+    return 1;
+  }
+
+  for (i = 0; i < n_factors; i++)
+  {
+    num = factors[i][0];
+    den = factors[i][1];
+    failed = FALSE;
+
+    /* sizes are rounded to the nearest pixel */
+    width = (pix->width * num + den / 2) / den;
+    height = (pix->height * num + den / 2) / den;
+
+    pix_out = ho_pixbuf_resample (pix, num, den);
+    if (!pix_out)
+      failed = TRUE;
+    else
+    {
+      failed = (pix_out->width != width || pix_out->height != height);
+      failed |= !hocr_check_scale_ramp (pix_out);
+
+      /* scaling by one is a copy */
+      if (num == den)
+        failed |= (hocr_check_scale_diff (pix, pix_out) != 0);
+
+      /* scaling up keeps all the details, so scaling back down gives the
+       * same picture */
+      if (num > den)
+      {
+        pix_back = ho_pixbuf_resample (pix_out, den, num);
+        diff = (pix_back) ? hocr_check_scale_diff (pix, pix_back) : -1;
+        failed |= (diff < 0 || diff > HOCR_CHECK_SCALE_ROUND_TRIP);
+        if (pix_back)
+          ho_pixbuf_free (pix_back);
+      }
+
+      ho_pixbuf_free (pix_out);
+    }
+
+    /* a flat picture stays flat */
+    pix_out = ho_pixbuf_resample (pix_flat, num, den);
+    if (!pix_out)
+      failed = TRUE;
+    else
+    {
+      pix_back = hocr_check_scale_pixbuf_new (pix_out->width,
+        pix_out->height, 137, 0);
+      if (!pix_back || hocr_check_scale_diff (pix_out, pix_back))
+        failed = TRUE;
+      if (pix_back)
+        ho_pixbuf_free (pix_back);
+      ho_pixbuf_free (pix_out);
+    }
+
+    printf ("scale %d/%d: %s\n", num, den, (failed) ? "FAIL" : "ok");
+    failures += failed;
+  }
+
+  ho_pixbuf_free (pix);
+  ho_pixbuf_free (pix_flat);
+
+  printf ("scale: %s\n", (failures) ? "FAIL" : "ok");
+
+  return (failures) ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+
+/*
+ * hocr_check_skew.c
+ *
+ * regression check for the page skew estimator.
+ *
+ * usage: hocr_check_skew
+ *
+ * text pages are drawn with lines at known angles, and the angle
+ * ho_dimentions_page_metrics finds is compared with the drawn one, then
+ * a page big enough to split the candidate angles between threads is
+ * measured on one thread and on several, the program returns 0 if all the
+ * angles are found and the threads find the same angles.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <hocr.h>
+#include <ho_dimentions.h>
+
+#include "hocr_check_page.h"
+
+/* how far a found angle may be from the drawn one, in deg. */
+#define HOCR_CHECK_SKEW_TOLERANCE 0.1
+
+/* threads the candidate angles of the big page are split between */
+#define HOCR_CHECK_SKEW_THREADS 4
+
+/*
+ * TRUE if a page measured on one thread and on several gets different
+ * angles, each candidate angle is scored the same on any thread
+ */
+static int
+hocr_check_skew_threads (const double angle)
+{
+  ho_bitmap *m = NULL;
+  ho_page_metrics metrics;
+  ho_page_metrics metrics_threads;
+  int failed;
+
+  /* A3 at 300 dpi has enough fonts for more than one job per pass */
+  m = hocr_check_page_new (3508, 4960, 1, angle, 1);
+  if (!m)
+    return TRUE;
+
+  failed = ho_dimentions_page_metrics (m, 1, 1, &metrics);
+  failed |= ho_dimentions_page_metrics (m, 1, HOCR_CHECK_SKEW_THREADS,
+    &metrics_threads);
+  ho_bitmap_free (m);
+
+  if (!failed)
+    failed = (metrics_threads.angle != metrics.angle
+      || metrics_threads.angle_confidence != metrics.angle_confidence);
+
+  printf ("drawn %6.2f %d threads %s\n", angle, HOCR_CHECK_SKEW_THREADS,
+    (failed) ? "FAIL" : "ok");
+
+  return failed;
+}
+
+int
+main ()
+{
+  /* a straight page must give exactly no skew */
+  const double angles[] = { 0.0, 0.3, -0.7, 1.5, -2.5, 4.0, -8.0, 12.0 };
+  const int n_angles = sizeof (angles) / sizeof (angles[0]);
+  ho_bitmap *m = NULL;
+  ho_page_metrics metrics;
+  int i, failed;
+  int failures = 0;
+
+  for (i = 0; i < n_angles; i++)
+  {
+    m = hocr_check_page_new (1240, 1754, 1, angles[i], 1);
+    if (!m)
+    {
+      printf ("can't create bitmap\n");
+      return 1;
+    }
+
+    /* the angle is found after the font size, as when a page is read */
+    failed = ho_dimentions_page_metrics (m, 1, 1, &metrics);
+    ho_bitmap_free (m);
+
+    if (failed)
+      printf ("drawn %6.2f can't measure page\n", angles[i]);
+    else
+    {
+      if (angles[i] == 0.0)
+        failed = (metrics.angle != 0.0);
+      else
+        failed =
+          (fabs (metrics.angle - angles[i]) > HOCR_CHECK_SKEW_TOLERANCE);
+
+      printf ("drawn %6.2f found %6.2f confidence %.2f %s\n", angles[i],
+        metrics.angle, metrics.angle_confidence, (failed) ? "FAIL" : "ok");
+    }
+    failures += failed;
+
+    failures += hocr_check_skew_threads (angles[i]);
+  }
+
+  printf ("skew: %s\n", (failures) ? "FAIL" : "ok");
+
+  return (failures) ? 1 : 0;
+}
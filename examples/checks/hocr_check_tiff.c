@@ -0,0 +1,271 @@
+
+/*
+ * hocr_check_tiff.c
+ *
+ * regression check for the page by page tiff reader.
+ *
+ * usage: hocr_check_tiff
+ *
+ * a tiff file of a 1 bpp page, a gray page, a broken page and a color page
+ * is written with libtiff and read back page by page, with and without
+ * decoding in the background, the program returns 0 if the pages read are
+ * the pages written and the broken page is reported as failed.
+ */
+
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tiffio.h>
+#include <hocr.h>
+
+#define HOCR_CHECK_TIFF_FILE "hocr_check_tiff.tif"
+
+/* a compression scheme no libtiff codec is registered for */
+#define HOCR_CHECK_TIFF_NO_CODEC 40000
+
+/* odd sizes, so rows of the 1 bpp page end inside a byte */
+#define HOCR_CHECK_TIFF_WIDTH 45
+#define HOCR_CHECK_TIFF_HEIGHT 33
+
+/*
+ * the sample at x, y of a page with n_bytes bytes in a row
+ */
+static unsigned char
+hocr_check_tiff_sample (const int x, const int y, const int n_bytes)
+{
+  unsigned char value;
+
+  value = (unsigned char) ((x * 7 + y * 13 + (x * y) % 5) & 0xff);
+
+  /* clear the padding bits at the end of 1 bpp rows */
+  if (n_bytes == (HOCR_CHECK_TIFF_WIDTH + 7) / 8 && x == n_bytes - 1)
+    value &= 0xff << (8 - HOCR_CHECK_TIFF_WIDTH % 8);
+
+  return value;
+}
+
+/*
+ * write one page, a broken page is marked with a compression libtiff has no
+ * decoder for and its samples are written as they are
+ */
+static int
+hocr_check_tiff_write_page (TIFF * tiff, const int bps, const int spp,
+  const int photo, const int broken)
+{
+  unsigned char *row = NULL;
+  int n_bytes, x, y;
+  int return_val = FALSE;
+
+  n_bytes = (HOCR_CHECK_TIFF_WIDTH * bps * spp + 7) / 8;
+
+  TIFFSetField (tiff, TIFFTAG_IMAGEWIDTH, HOCR_CHECK_TIFF_WIDTH);
+  TIFFSetField (tiff, TIFFTAG_IMAGELENGTH, HOCR_CHECK_TIFF_HEIGHT);
+  TIFFSetField (tiff, TIFFTAG_BITSPERSAMPLE, bps);
+  TIFFSetField (tiff, TIFFTAG_SAMPLESPERPIXEL, spp);
+  TIFFSetField (tiff, TIFFTAG_PHOTOMETRIC, photo);
+  TIFFSetField (tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+  TIFFSetField (tiff, TIFFTAG_COMPRESSION,
+    (broken) ? HOCR_CHECK_TIFF_NO_CODEC : COMPRESSION_NONE);
+  TIFFSetField (tiff, TIFFTAG_ROWSPERSTRIP, HOCR_CHECK_TIFF_HEIGHT);
+
+  row = (unsigned char *) malloc (n_bytes * HOCR_CHECK_TIFF_HEIGHT);
+  if (!row)
+    return TRUE;
+
+  for (y = 0; y < HOCR_CHECK_TIFF_HEIGHT; y++)
+    for (x = 0; x < n_bytes; x++)
+      row[x + y * n_bytes] = hocr_check_tiff_sample (x, y, n_bytes);
+
+  if (broken)
+  {
+    if (TIFFWriteRawStrip (tiff, 0, row, n_bytes * HOCR_CHECK_TIFF_HEIGHT) < 0)
+      return_val = TRUE;
+  }
+  else
+  {
+    for (y = 0; y < HOCR_CHECK_TIFF_HEIGHT && !return_val; y++)
+      if (TIFFWriteScanline (tiff, row + y * n_bytes, y, 0) < 0)
+        return_val = TRUE;
+  }
+
+  free (row);
+
+  if (!TIFFWriteDirectory (tiff))
+    return_val = TRUE;
+
+  return return_val;
+}
+
+/*
+ * write the check file
+ */
+static int
+hocr_check_tiff_save (const char *filename)
+{
+  TIFF *tiff = NULL;
+  int return_val = FALSE;
+
+  tiff = TIFFOpen (filename, "w");
+  if (!tiff)
+    return TRUE;
+
+  return_val |= hocr_check_tiff_write_page (tiff, 1, 1,
+    PHOTOMETRIC_MINISWHITE, FALSE);
+  return_val |= hocr_check_tiff_write_page (tiff, 8, 1,
+    PHOTOMETRIC_MINISBLACK, FALSE);
+  return_val |= hocr_check_tiff_write_page (tiff, 8, 1,
+    PHOTOMETRIC_MINISBLACK, TRUE);
+  return_val |= hocr_check_tiff_write_page (tiff, 8, 3, PHOTOMETRIC_RGB,
+    FALSE);
+
+  TIFFClose (tiff);
+
+  return return_val;
+}
+
+/*
+ * number of rows of a page that are not the rows written
+ */
+static int
+hocr_check_tiff_diff (const unsigned char *data, const int rowstride,
+  const int width, const int height, const int n_bytes)
+{
+  int x, y;
+  int errors = 0;
+
+  if (width != HOCR_CHECK_TIFF_WIDTH || height != HOCR_CHECK_TIFF_HEIGHT)
+    return -1;
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < n_bytes; x++)
+      if (data[x + y * rowstride] != hocr_check_tiff_sample (x, y, n_bytes))
+      {
+        errors++;
+        break;
+      }
+
+  return errors;
+}
+
+/*
+ * read the check file page by page, return the number of errors
+ */
+static int
+hocr_check_tiff_read (const char *filename, const unsigned char prefetch)
+{
+  ho_pixbuf_tiff_reader *reader = NULL;
+  ho_bitmap *m = NULL;
+  ho_pixbuf *pix = NULL;
+  int errors = 0;
+
+  reader = ho_pixbuf_tiff_reader_new (filename, prefetch);
+  if (!reader)
+    return 1;
+
+  if (ho_pixbuf_tiff_reader_n_pages (reader) != 4)
+    errors++;
+
+  /* 1 bpp page, read as a bitmap */
+  if (ho_pixbuf_tiff_reader_next (reader, &m, &pix) || !m || pix
+    || hocr_check_tiff_diff (m->data, m->rowstride, m->width, m->height,
+      (HOCR_CHECK_TIFF_WIDTH + 7) / 8))
+    errors++;
+  if (m)
+    ho_bitmap_free (m);
+  if (pix)
+    ho_pixbuf_free (pix);
+
+  /* gray page, read as a gray pixbuf */
+  if (ho_pixbuf_tiff_reader_next (reader, &m, &pix) || m || !pix
+    || pix->n_channels != 1
+    || hocr_check_tiff_diff (pix->data, pix->rowstride, pix->width,
+      pix->height, HOCR_CHECK_TIFF_WIDTH))
+    errors++;
+  if (m)
+    ho_bitmap_free (m);
+  if (pix)
+    ho_pixbuf_free (pix);
+
+  /* broken page, failed and not the end of the file */
+  if (!ho_pixbuf_tiff_reader_next (reader, &m, &pix)
+    || !ho_pixbuf_tiff_reader_failed (reader) || m || pix)
+    errors++;
+  if (m)
+    ho_bitmap_free (m);
+  if (pix)
+    ho_pixbuf_free (pix);
+
+  /* color page, read after the broken one */
+  if (ho_pixbuf_tiff_reader_next (reader, &m, &pix)
+    || ho_pixbuf_tiff_reader_failed (reader) || m || !pix
+    || pix->n_channels != 3
+    || hocr_check_tiff_diff (pix->data, pix->rowstride, pix->width,
+      pix->height, 3 * HOCR_CHECK_TIFF_WIDTH))
+    errors++;
+  if (m)
+    ho_bitmap_free (m);
+  if (pix)
+    ho_pixbuf_free (pix);
+
+  /* end of file, not failed */
+  if (!ho_pixbuf_tiff_reader_next (reader, &m, &pix)
+    || ho_pixbuf_tiff_reader_failed (reader) || m || pix)
+    errors++;
+  if (m)
+    ho_bitmap_free (m);
+  if (pix)
+    ho_pixbuf_free (pix);
+
+  ho_pixbuf_tiff_reader_free (reader);
+
+  return errors;
+}
+
+int
+main ()
+{
+  int prefetch, errors;
+  int failures = 0;
+
+  /* the broken page is broken on purpose, don't print libtiff errors */
+  TIFFSetErrorHandler (NULL);
+  TIFFSetWarningHandler (NULL);
+
+  if (hocr_check_tiff_save (HOCR_CHECK_TIFF_FILE))
+  {
+    printf ("can't write tiff file\n");
+    remove (HOCR_CHECK_TIFF_FILE);
+    return 1;
+  }
+
+  for (prefetch = 0; prefetch < 2; prefetch++)
+  {
+    errors = hocr_check_tiff_read (HOCR_CHECK_TIFF_FILE,
+      (prefetch) ? TRUE : FALSE);
+    printf ("%s: %s\n", (prefetch) ? "prefetch" : "no prefetch",
+      (errors) ? "FAIL" : "ok");
+    if (errors)
+      failures++;
+  }
+
+  remove (HOCR_CHECK_TIFF_FILE);
+
+  printf ("tiff reader: %s\n", (failures) ? "FAIL" : "ok");
+
+  return (failures) ? 1 : 0;
+}
@@ -250,7 +250,7 @@ static GOptionEntry file_entries[] = {
 static GOptionEntry image_entries[] = {
   {"thresholding-type", 'T', 0, G_OPTION_ARG_INT,
       &adaptive_threshold_type,
-      "thresholding type, 0 normal, 1 none, 2 fine",
+      "thresholding type, 0 normal, 1 none, 2 fine, 3 bradley, 4 sauvola, 5 otsu",
     "NUM"},
   {"threshold", 't', 0, G_OPTION_ARG_INT, &threshold,
       "use NUM as threshold value, 1..100",
@@ -440,7 +440,7 @@ hocr_cmd_parser (int *argc, char **argv[])
     g_print ("%s - Hebrew OCR utility\n", PACKAGE_STRING);
 
   /* sanity check */
-  if (adaptive_threshold_type > 2 || adaptive_threshold_type < 0)
+  if (adaptive_threshold_type > 5 || adaptive_threshold_type < 0)
   {
     hocr_printerr ("unknown thresholding type using normal settings");
     adaptive_threshold_type = 0;
@@ -494,7 +494,7 @@ hocr_pixbuf_load_with_debug ()
   /* read image from file */
   if (no_gtk)
   {
-    pix = ho_pixbuf_pnm_load (image_in_filename);
+    pix = ho_pixbuf_pnm_map (image_in_filename);
 #ifdef USE_TIFF
     /* if this is not a pnm image file, try b/w tiff */
     if (!pix)
@@ -1543,24 +1543,50 @@ main (int argc, char *argv[])
   if (debug || verbose)
     g_print ("start image proccesing.\n");
 
-  /* load the image from input filename */
-  pix = hocr_pixbuf_load_with_debug ();
+  /* a 1 bpp pbm page is read straight to a b/w bitmap, and is not
+   * thresholded again */
+  if (no_gtk && !debug && !verbose && !save_copy)
+    m_page_text_temp = ho_pixbuf_pnm_load_bitmap (image_in_filename);
 
-  /* if user do not nead fidback just do image proccesing */
-  if (!debug && !verbose)
+  if (m_page_text_temp)
   {
+    HEBOCR_IMAGE_OPTIONS image_options;
+
+    image_options.scale = scale_by;
+    image_options.auto_scale = !do_not_auto_scale;
+    image_options.rotation_angle = rotate_angle;
+    image_options.auto_rotate = !do_not_auto_rotate;
+    image_options.adaptive = adaptive_threshold_type;
+    image_options.threshold = threshold;
+    image_options.a_threshold = adaptive_threshold;
+    image_options.threads = HEBOCR_DEFAULT_THREADS;
+
     m_page_text =
-      hocr_image_processing (pix,
-      scale_by,
-      do_not_auto_scale,
-      rotate_angle,
-      do_not_auto_rotate,
-      adaptive_threshold_type, threshold, adaptive_threshold, &progress);
+      hocr_bitmap_processing (m_page_text_temp, &image_options, &progress);
+    ho_bitmap_free (m_page_text_temp);
+    m_page_text_temp = NULL;
   }
   else
-    /* do image proccesing with fidback */
   {
-    m_page_text = hocr_image_processing_with_debug (pix);
+    /* load the image from input filename */
+    pix = hocr_pixbuf_load_with_debug ();
+
+    /* if user do not nead fidback just do image proccesing */
+    if (!debug && !verbose)
+    {
+      m_page_text =
+        hocr_image_processing (pix,
+        scale_by,
+        do_not_auto_scale,
+        rotate_angle,
+        do_not_auto_rotate,
+        adaptive_threshold_type, threshold, adaptive_threshold, &progress);
+    }
+    else
+      /* do image proccesing with fidback */
+    {
+      m_page_text = hocr_image_processing_with_debug (pix);
+    }
   }
 
   /* do extra image proccesing */
@@ -50,6 +50,17 @@
 
 #ifndef VERSION
 #	define VERSION "0.12"
+#endif
+
+// threads the hocr_do_ocr functions use
+#ifndef HEBOCR_DEFAULT_THREADS
+#	define HEBOCR_DEFAULT_THREADS 4
+#endif
+
+// most threads an options struct may ask for, values out of
+// 1..HEBOCR_MAX_THREADS are taken as unset and use one thread
+#ifndef HEBOCR_MAX_THREADS
+#	define HEBOCR_MAX_THREADS 64
 #endif    
 
 typedef struct HEBOCR_IMAGE_OPTIONS{
@@ -57,9 +68,10 @@ typedef struct HEBOCR_IMAGE_OPTIONS{
 	unsigned char auto_scale;	// do try to autoscale
 	double rotation_angle;		// rotation angle
 	unsigned char auto_rotate;	// do try to autorotate
-	unsigned char adaptive;		// type of thresholding to use. 0-normal,1-no,2-fine.
+	unsigned char adaptive;		// type of thresholding to use. 0-normal,1-no,2-fine,3-bradley,4-sauvola,5-otsu.
 	unsigned char threshold;	// threshold the threshold to use 0..100 (0-auto)
 	unsigned char a_threshold;	// threshold to use for adaptive thresholding 0..100 (0-auto)
+	int threads;			// threads to use for image processing 1..HEBOCR_MAX_THREADS (must be set, other values-one thread)
 } HEBOCR_IMAGE_OPTIONS;
 
 typedef struct HEBOCR_LAYOUT_OPTIONS {
@@ -70,12 +82,14 @@ typedef struct HEBOCR_LAYOUT_OPTIONS {
 	int line_leeway;
 	unsigned char dir_ltr;		// true=ltr false=rtl
 	unsigned char html;		// 1 -> output format is html, 0 -> text
+	int threads;			// threads to use for blocks and lines 1..HEBOCR_MAX_THREADS (must be set, other values-one thread)
 } HEBOCR_LAYOUT_OPTIONS;
 
 typedef struct HEBOCR_FONT_OPTIONS {
 	int font_code;			// code for the font to use (use 0)
 	unsigned char nikud;		// recognize nikud in image
 	unsigned char do_linguistics;	// unused
+	int threads;			// threads to recognize fonts with 1..HEBOCR_MAX_THREADS (must be set, other values-one thread)
 } HEBOCR_FONT_OPTIONS;
 
 
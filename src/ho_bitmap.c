@@ -26,6 +26,13 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include <stdint.h>
+
+/* sse2/avx2 bulk operations, selected at run time */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HO_BITMAP_X86 1
+#include <immintrin.h>
+#endif
 
 #ifdef USE_TIFF
 #include <tiffio.h>
@@ -126,12 +133,174 @@ ho_bitmap_clone (const ho_bitmap * m)
   return m_out;
 }
 
+int
+ho_bitmap_view_init (ho_bitmap_view * v, const ho_bitmap * m,
+  const int x, const int y, const int width, const int height)
+{
+  int x1, y1, x2, y2;
+
+  /* clip window to parent */
+  x1 = (x < 0) ? 0 : x;
+  y1 = (y < 0) ? 0 : y;
+  x2 = (x + width > m->width) ? m->width : x + width;
+  y2 = (y + height > m->height) ? m->height : y + height;
+  if (x2 < x1)
+    x2 = x1;
+  if (y2 < y1)
+    y2 = y1;
+
+  v->parent = m;
+  v->x = m->x + x1;
+  v->y = m->y + y1;
+  v->width = x2 - x1;
+  v->height = y2 - y1;
+  v->bit_offset = x1 % 8;
+  v->rowstride = m->rowstride;
+  v->data = m->data + y1 * m->rowstride + x1 / 8;
+
+  return FALSE;
+}
+
+int
+ho_bitmap_view_get_row_words (const ho_bitmap_view * v, const int y,
+  uint64_t * row)
+{
+  const unsigned char *data = v->data + y * v->rowstride;
+  int n_words = ho_bitmap_view_get_n_words (v);
+  int n_bytes = (v->bit_offset + v->width + 7) / 8;
+  int i, k, byte;
+  uint64_t word;
+
+  for (i = 0; i < n_words; i++)
+  {
+    byte = i * 8;
+
+    /* full word inside the row */
+    if (byte + 8 <= n_bytes)
+      word = ((uint64_t) data[byte] << 56) | ((uint64_t) data[byte + 1] << 48) |
+        ((uint64_t) data[byte + 2] << 40) | ((uint64_t) data[byte + 3] << 32) |
+        ((uint64_t) data[byte + 4] << 24) | ((uint64_t) data[byte + 5] << 16) |
+        ((uint64_t) data[byte + 6] << 8) | (uint64_t) data[byte + 7];
+    else
+    {
+      word = 0;
+      for (k = 0; k < 8; k++)
+      {
+        word <<= 8;
+        if (byte + k < n_bytes)
+          word |= data[byte + k];
+      }
+    }
+
+    /* shift in the high bits of the next byte */
+    if (v->bit_offset)
+    {
+      word <<= v->bit_offset;
+      if (byte + 8 < n_bytes)
+        word |= (uint64_t) (data[byte + 8] >> (8 - v->bit_offset));
+    }
+
+    row[i] = word;
+  }
+
+  /* clear the bits right of the last pixel */
+  if (v->width % 64)
+    row[(v->width - 1) / 64] &= ~(uint64_t) 0 << (64 - v->width % 64);
+
+  return FALSE;
+}
+
+/* copy a view into m_out, with its top left pixel at x_dst, y_dst */
+static int
+ho_bitmap_view_paste (const ho_bitmap_view * v, ho_bitmap * m_out,
+  const int x_dst, const int y_dst)
+{
+  uint64_t *row;
+  uint64_t *out;
+  int n_words, n_out_words;
+  int word_shift, bit_shift;
+  int i, j, y;
+
+  if (v->width < 1 || v->height < 1)
+    return FALSE;
+
+  n_words = ho_bitmap_view_get_n_words (v);
+  n_out_words = ho_bitmap_get_n_words (m_out);
+  row = (uint64_t *) malloc ((n_words + n_out_words) * sizeof (uint64_t));
+  if (!row)
+    return TRUE;
+  out = row + n_words;
+
+  word_shift = x_dst / 64;
+  bit_shift = x_dst % 64;
+
+  for (y = 0; y < v->height && y + y_dst < m_out->height; y++)
+  {
+    ho_bitmap_view_get_row_words (v, y, row);
+
+    /* shift the row right by x_dst pixels */
+    for (i = 0; i < n_out_words; i++)
+    {
+      j = i - word_shift;
+      out[i] = 0;
+      if (j >= 0 && j < n_words)
+        out[i] = row[j] >> bit_shift;
+      if (bit_shift && j - 1 >= 0 && j - 1 < n_words)
+        out[i] |= row[j - 1] << (64 - bit_shift);
+    }
+
+    ho_bitmap_set_row_words (m_out, y + y_dst, out);
+  }
+
+  free (row);
+
+  return FALSE;
+}
+
+ho_bitmap *
+ho_bitmap_new_from_view (const ho_bitmap_view * v)
+{
+  ho_bitmap *m_out;
+  const ho_bitmap *m = v->parent;
+
+  /* 
+   * allocate memory 
+   */
+  m_out = ho_bitmap_new (v->width, v->height);
+  if (!m_out)
+    return NULL;
+
+  m_out->x = v->x;
+  m_out->y = v->y;
+
+  m_out->type = m->type;
+  m_out->font_height = m->font_height;
+  m_out->font_width = m->font_width;
+  m_out->font_spacing = m->font_spacing;
+  m_out->line_spacing = m->line_spacing;
+  m_out->avg_line_fill = m->avg_line_fill;
+  m_out->com_line_fill = m->com_line_fill;
+  m_out->nikud = m->nikud;
+
+  /* 
+   * copy data 
+   */
+  if (ho_bitmap_view_paste (v, m_out, 0, 0))
+  {
+    ho_bitmap_free (m_out);
+    return NULL;
+  }
+
+  return m_out;
+}
+
 ho_bitmap *
 ho_bitmap_clone_window (const ho_bitmap * m, const int x, const int y,
   const int width, const int height)
 {
   ho_bitmap *m_out;
-  int x1, y1;
+  ho_bitmap_view v;
+  int i;
 
   /* 
    * allocate memory 
@@ -156,15 +325,23 @@ ho_bitmap_clone_window (const ho_bitmap * m, const int x, const int y,
   m_out->nikud = m->nikud;
 
   /* 
-   * copy data 
+   * copy data, the part of the window outside m stays white 
    */
-  for (x1 = 0; x1 < width && x1 < m->width; x1++)
-    for (y1 = 0; y1 < height && y1 < m->height; y1++)
-    {
-      if ((x + x1) > 0 && (y + y1) > 0 && ho_bitmap_get (m, x + x1, y + y1))
-        ho_bitmap_set (m_out, x1, y1);
-    }
-  
+  ho_bitmap_view_init (&v, m, x, y, width, height);
+  if (ho_bitmap_view_paste (&v, m_out, v.x - m_out->x, v.y - m_out->y))
+  {
+    ho_bitmap_free (m_out);
+    return NULL;
+  }
+
+  /* pixels on the first row and column of m were never copied */
+  if (x <= 0 && -x < width)
+    for (i = 0; i < height; i++)
+      ho_bitmap_unset (m_out, -x, i);
+  if (y <= 0 && -y < height)
+    for (i = 0; i < width; i++)
+      ho_bitmap_unset (m_out, i, -y);
+
   return m_out;
 }
 
@@ -204,111 +381,286 @@ ho_bitmap_binop_window (ho_bitmap * m_left, const ho_bitmap * m_right,
   return FALSE;
 }
 
-int
-ho_bitmap_and (ho_bitmap * m_left, const ho_bitmap * m_right)
+/* 
+ * bulk boolean operations on the packed bitmap data 
+ */
+
+/* bulk operation codes */
+enum
+{
+  HO_BITMAP_OP_AND,
+  HO_BITMAP_OP_OR,
+  HO_BITMAP_OP_XOR,
+  HO_BITMAP_OP_ANDNOT,
+  HO_BITMAP_OP_COPY,
+  HO_BITMAP_OP_NOT
+};
+
+typedef void (*ho_bitmap_bulk_func) (unsigned char *out,
+  const unsigned char *a, const unsigned char *b, const int n, const int op);
+
+static void
+ho_bitmap_bulk_scalar (unsigned char *out, const unsigned char *a,
+  const unsigned char *b, const int n, const int op)
 {
   int i;
 
-  /* 
-   * check sizes 
-   */
-  if (m_left->width != m_right->width || m_left->height != m_right->height)
-    return TRUE;
+  switch (op)
+  {
+  case HO_BITMAP_OP_AND:
+    for (i = 0; i < n; i++)
+      out[i] = a[i] & b[i];
+    break;
+  case HO_BITMAP_OP_OR:
+    for (i = 0; i < n; i++)
+      out[i] = a[i] | b[i];
+    break;
+  case HO_BITMAP_OP_XOR:
+    for (i = 0; i < n; i++)
+      out[i] = a[i] ^ b[i];
+    break;
+  case HO_BITMAP_OP_ANDNOT:
+    for (i = 0; i < n; i++)
+      out[i] = a[i] & ~b[i];
+    break;
+  case HO_BITMAP_OP_COPY:
+    for (i = 0; i < n; i++)
+      out[i] = b[i];
+    break;
+  case HO_BITMAP_OP_NOT:
+    for (i = 0; i < n; i++)
+      out[i] = ~a[i];
+    break;
+  }
+}
 
-  /* 
-   * copy data 
-   */
-  for (i = 0; i < m_right->height * m_right->rowstride; i++)
-    m_left->data[i] &= m_right->data[i];
+#ifdef HO_BITMAP_X86
 
-  return FALSE;
+__attribute__ ((target ("sse2")))
+static void
+ho_bitmap_bulk_sse2 (unsigned char *out, const unsigned char *a,
+  const unsigned char *b, const int n, const int op)
+{
+  __m128i va, vb, vr;
+  __m128i ones = _mm_set1_epi32 (-1);
+  int i;
+
+  for (i = 0; i + 16 <= n; i += 16)
+  {
+    va = _mm_loadu_si128 ((const __m128i *) (a + i));
+    vb = _mm_loadu_si128 ((const __m128i *) (b + i));
+
+    switch (op)
+    {
+    case HO_BITMAP_OP_AND:
+      vr = _mm_and_si128 (va, vb);
+      break;
+    case HO_BITMAP_OP_OR:
+      vr = _mm_or_si128 (va, vb);
+      break;
+    case HO_BITMAP_OP_XOR:
+      vr = _mm_xor_si128 (va, vb);
+      break;
+    case HO_BITMAP_OP_ANDNOT:
+      vr = _mm_andnot_si128 (vb, va);
+      break;
+    case HO_BITMAP_OP_COPY:
+      vr = vb;
+      break;
+    default:
+      vr = _mm_xor_si128 (va, ones);
+      break;
+    }
+
+    _mm_storeu_si128 ((__m128i *) (out + i), vr);
+  }
+
+  /* the tail */
+  ho_bitmap_bulk_scalar (out + i, a + i, b + i, n - i, op);
 }
 
-int
-ho_bitmap_or (ho_bitmap * m_left, const ho_bitmap * m_right)
+__attribute__ ((target ("avx2")))
+static void
+ho_bitmap_bulk_avx2 (unsigned char *out, const unsigned char *a,
+  const unsigned char *b, const int n, const int op)
 {
+  __m256i va, vb, vr;
+  __m256i ones = _mm256_set1_epi32 (-1);
   int i;
 
-  /* 
-   * check sizes 
-   */
-  if (m_left->width != m_right->width || m_left->height != m_right->height)
-    return TRUE;
+  for (i = 0; i + 32 <= n; i += 32)
+  {
+    va = _mm256_loadu_si256 ((const __m256i *) (a + i));
+    vb = _mm256_loadu_si256 ((const __m256i *) (b + i));
 
-  /* 
-   * copy data 
-   */
-  for (i = 0; i < m_right->height * m_right->rowstride; i++)
-    m_left->data[i] |= m_right->data[i];
+    switch (op)
+    {
+    case HO_BITMAP_OP_AND:
+      vr = _mm256_and_si256 (va, vb);
+      break;
+    case HO_BITMAP_OP_OR:
+      vr = _mm256_or_si256 (va, vb);
+      break;
+    case HO_BITMAP_OP_XOR:
+      vr = _mm256_xor_si256 (va, vb);
+      break;
+    case HO_BITMAP_OP_ANDNOT:
+      vr = _mm256_andnot_si256 (vb, va);
+      break;
+    case HO_BITMAP_OP_COPY:
+      vr = vb;
+      break;
+    default:
+      vr = _mm256_xor_si256 (va, ones);
+      break;
+    }
 
-  return FALSE;
+    _mm256_storeu_si256 ((__m256i *) (out + i), vr);
+  }
+
+  /* the tail */
+  ho_bitmap_bulk_scalar (out + i, a + i, b + i, n - i, op);
 }
 
-int
-ho_bitmap_xor (ho_bitmap * m_left, const ho_bitmap * m_right)
+#endif /* HO_BITMAP_X86 */
+
+/* implementation used by ho_bitmap_bulk, it is selected once when the
+ * library is loaded, so threads only read it */
+static ho_bitmap_bulk_func ho_bitmap_bulk_func_selected =
+  ho_bitmap_bulk_scalar;
+
+#ifdef HO_BITMAP_X86
+
+static void __attribute__ ((constructor))
+ho_bitmap_bulk_select (void)
 {
-  int i;
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    ho_bitmap_bulk_func_selected = ho_bitmap_bulk_avx2;
+  else if (__builtin_cpu_supports ("sse2"))
+    ho_bitmap_bulk_func_selected = ho_bitmap_bulk_sse2;
+}
+
+#endif /* HO_BITMAP_X86 */
+
+/**
+ run a bulk operation using the best implementation for this cpu
+ 
+ out may be the same buffer as a or b
+ 
+ @param out the output buffer
+ @param a left hand buffer
+ @param b right hand buffer
+ @param n number of bytes
+ @param op operation code
+ */
+static void
+ho_bitmap_bulk (unsigned char *out, const unsigned char *a,
+  const unsigned char *b, const int n, const int op)
+{
+  ho_bitmap_bulk_func_selected (out, a, b, n, op);
+}
 
+/**
+ run a bulk operation on bitmaps
+
+ @param m_out the output bitmap
+ @param m_left the left hand bitmap
+ @param m_right the right hand bitmap
+ @param op operation code
+ @return FALSE
+ */
+static int
+ho_bitmap_bulk_op (ho_bitmap * m_out, const ho_bitmap * m_left,
+  const ho_bitmap * m_right, const int op)
+{
   /* 
    * check sizes 
    */
-  if (m_left->width != m_right->width || m_left->height != m_right->height)
+  if (m_out->width != m_left->width || m_out->height != m_left->height)
+    return TRUE;
+  if (m_out->width != m_right->width || m_out->height != m_right->height)
     return TRUE;
 
-  /* 
-   * copy data 
-   */
-  for (i = 0; i < m_right->height * m_right->rowstride; i++)
-    m_left->data[i] ^= m_right->data[i];
+  ho_bitmap_bulk (m_out->data, m_left->data, m_right->data,
+    m_out->height * m_out->rowstride, op);
 
   return FALSE;
 }
 
 int
-ho_bitmap_andnot (ho_bitmap * m_left, const ho_bitmap * m_right)
+ho_bitmap_and (ho_bitmap * m_left, const ho_bitmap * m_right)
 {
-  int i;
+  return ho_bitmap_bulk_op (m_left, m_left, m_right, HO_BITMAP_OP_AND);
+}
 
-  /* 
-   * check sizes 
-   */
-  if (m_left->width != m_right->width || m_left->height != m_right->height)
-    return TRUE;
+int
+ho_bitmap_or (ho_bitmap * m_left, const ho_bitmap * m_right)
+{
+  return ho_bitmap_bulk_op (m_left, m_left, m_right, HO_BITMAP_OP_OR);
+}
 
-  /* 
-   * copy data 
-   */
-  for (i = 0; i < m_right->height * m_right->rowstride; i++)
-    m_left->data[i] &= ~m_right->data[i];
+int
+ho_bitmap_xor (ho_bitmap * m_left, const ho_bitmap * m_right)
+{
+  return ho_bitmap_bulk_op (m_left, m_left, m_right, HO_BITMAP_OP_XOR);
+}
 
-  return FALSE;
+int
+ho_bitmap_andnot (ho_bitmap * m_left, const ho_bitmap * m_right)
+{
+  return ho_bitmap_bulk_op (m_left, m_left, m_right, HO_BITMAP_OP_ANDNOT);
 }
 
 int
 ho_bitmap_copy (ho_bitmap * m_left, const ho_bitmap * m_right)
 {
-  int i;
+  return ho_bitmap_bulk_op (m_left, m_left, m_right, HO_BITMAP_OP_COPY);
+}
 
-  /* 
-   * check sizes 
-   */
-  if (m_left->width != m_right->width || m_left->height != m_right->height)
-    return TRUE;
+int
+ho_bitmap_and_to (ho_bitmap * m_out, const ho_bitmap * m_left,
+  const ho_bitmap * m_right)
+{
+  return ho_bitmap_bulk_op (m_out, m_left, m_right, HO_BITMAP_OP_AND);
+}
 
-  /* 
-   * copy data 
-   */
-  for (i = 0; i < m_right->height * m_right->rowstride; i++)
-    m_left->data[i] = m_right->data[i];
+int
+ho_bitmap_or_to (ho_bitmap * m_out, const ho_bitmap * m_left,
+  const ho_bitmap * m_right)
+{
+  return ho_bitmap_bulk_op (m_out, m_left, m_right, HO_BITMAP_OP_OR);
+}
 
-  return FALSE;
+int
+ho_bitmap_xor_to (ho_bitmap * m_out, const ho_bitmap * m_left,
+  const ho_bitmap * m_right)
+{
+  return ho_bitmap_bulk_op (m_out, m_left, m_right, HO_BITMAP_OP_XOR);
+}
+
+int
+ho_bitmap_andnot_to (ho_bitmap * m_out, const ho_bitmap * m_left,
+  const ho_bitmap * m_right)
+{
+  return ho_bitmap_bulk_op (m_out, m_left, m_right, HO_BITMAP_OP_ANDNOT);
+}
+
+int
+ho_bitmap_not_to (ho_bitmap * m_out, const ho_bitmap * m)
+{
+  return ho_bitmap_bulk_op (m_out, m, m, HO_BITMAP_OP_NOT);
+}
+
+int
+ho_bitmap_not_inplace (ho_bitmap * m)
+{
+  return ho_bitmap_bulk_op (m, m, m, HO_BITMAP_OP_NOT);
 }
 
 ho_bitmap *
 ho_bitmap_not (const ho_bitmap * m)
 {
-  int i;
-
   ho_bitmap *m_out;
 
   /* 
@@ -316,6 +668,12 @@ ho_bitmap_not (const ho_bitmap * m)
    */
   m_out = ho_bitmap_new (m->width, m->height);
 
+  /* 
+   * check valid memory 
+   */
+  if (!m_out)
+    return NULL;
+
   /* 
    * copy header data 
    */
@@ -331,87 +689,138 @@ ho_bitmap_not (const ho_bitmap * m)
   m_out->com_line_fill = m->com_line_fill;
   m_out->nikud = m->nikud;
 
-  /* 
-   * check valid memory 
-   */
-  if (!m_out)
-    return NULL;
-
   /* 
    * copy data 
    */
-  for (i = 0; i < m->height * m->rowstride; i++)
-    m_out->data[i] = ~m->data[i];
+  ho_bitmap_bulk (m_out->data, m->data, m->data, m->height * m->rowstride,
+    HO_BITMAP_OP_NOT);
 
   return m_out;
 }
 
-ho_bitmap *
-ho_bitmap_dilation_n (const ho_bitmap * m, const unsigned char n)
+/* 
+ * word parallel helpers 
+ */
+
+int
+ho_bitmap_get_row_words (const ho_bitmap * m, const int y, uint64_t * row)
 {
-  ho_bitmap *m_out;
-  int x, y;
-  unsigned char sum;
+  const unsigned char *data = m->data + y * m->rowstride;
+  int n_full = m->rowstride / 8;
+  int i, k;
+  uint64_t word;
+
+  for (i = 0; i < n_full; i++, data += 8)
+    row[i] = ((uint64_t) data[0] << 56) | ((uint64_t) data[1] << 48) |
+      ((uint64_t) data[2] << 40) | ((uint64_t) data[3] << 32) |
+      ((uint64_t) data[4] << 24) | ((uint64_t) data[5] << 16) |
+      ((uint64_t) data[6] << 8) | (uint64_t) data[7];
+
+  /* last partial word */
+  if (m->rowstride % 8)
+  {
+    word = 0;
+    for (k = 0; k < 8; k++)
+    {
+      word <<= 8;
+      if (k < m->rowstride % 8)
+        word |= data[k];
+    }
+    row[i] = word;
+  }
 
-  if (!m)
-    return NULL;
-  
-  /* 
-   * allocate memory 
-   */
-  m_out = ho_bitmap_new (m->width, m->height);
-  if (!m_out)
-    return NULL;
-  m_out->x = m->x;
-  m_out->y = m->y;
+  /* clear the bits right of the last pixel */
+  if (m->width % 64)
+    row[(m->width - 1) / 64] &= ~(uint64_t) 0 << (64 - m->width % 64);
 
-  m_out->type = m->type;
-  m_out->font_height = m->font_height;
-  m_out->font_width = m->font_width;
-  m_out->font_spacing = m->font_spacing;
-  m_out->line_spacing = m->line_spacing;
-  m_out->avg_line_fill = m->avg_line_fill;
-  m_out->com_line_fill = m->com_line_fill;
-  m_out->nikud = m->nikud;
+  return FALSE;
+}
 
-  /* 
-   * do dilation 
-   */
-  for (x = 1; x < m->width - 1; x++)
-    for (y = 1; y < m->height - 1; y++)
+int
+ho_bitmap_set_row_words (ho_bitmap * m, const int y, const uint64_t * row)
+{
+  unsigned char *data = m->data + y * m->rowstride;
+  int i;
+
+  for (i = 0; i < m->rowstride; i++)
+    data[i] = (unsigned char) (row[i / 8] >> (56 - 8 * (i % 8)));
+
+  return FALSE;
+}
+
+/* set mask bits for pixels x_start .. x_end - 1 */
+static void
+ho_bitmap_row_mask (uint64_t * row, const int n_words, const int x_start,
+  const int x_end)
+{
+  int x;
+
+  memset (row, 0, n_words * sizeof (uint64_t));
+  for (x = x_start; x < x_end; x++)
+    row[x / 64] |= (uint64_t) 1 << (63 - x % 64);
+}
+
+/* 
+ * bit sliced counter, add one bit plane into a 4 bit counter 
+ */
+#define ho_bitmap_count_add(s,a) \
+  do { \
+    uint64_t c0_, c1_, c2_; \
+    c0_ = (s)[0] & (a); (s)[0] ^= (a); \
+    c1_ = (s)[1] & c0_; (s)[1] ^= c0_; \
+    c2_ = (s)[2] & c1_; (s)[2] ^= c1_; \
+    (s)[3] |= c2_; \
+  } while (0)
+
+/* 
+ * bit sliced compare, return mask of counters that are >= t (t is 0..8)
+ */
+static uint64_t
+ho_bitmap_count_ge (const uint64_t * s, const int t)
+{
+  uint64_t gt = 0;
+  uint64_t eq = ~(uint64_t) 0;
+  int bit;
+
+  for (bit = 3; bit >= 0; bit--)
+  {
+    if (t & (1 << bit))
+      eq &= s[bit];
+    else
     {
-      /* 
-       * if white pixel 
-       */
-      if (!ho_bitmap_get (m, x, y))
-      {
-        sum = ho_bitmap_get (m, x - 1, y - 1) +
-          ho_bitmap_get (m, x - 1, y) +
-          ho_bitmap_get (m, x - 1, y + 1) +
-          ho_bitmap_get (m, x, y - 1) +
-          ho_bitmap_get (m, x, y + 1) +
-          ho_bitmap_get (m, x + 1, y - 1) +
-          ho_bitmap_get (m, x + 1, y) + ho_bitmap_get (m, x + 1, y + 1);
-        if (sum >= n)
-          ho_bitmap_set (m_out, x, y);
-      }
-      else
-        ho_bitmap_set (m_out, x, y);
+      gt |= eq & s[bit];
+      eq &= ~s[bit];
     }
+  }
 
-  return m_out;
+  return gt | eq;
 }
 
-ho_bitmap *
-ho_bitmap_erosion_n (const ho_bitmap * m, const unsigned char n)
+/**
+ 3x3 morphology step on 64 bit words
+ 
+ a pixel in the output is set if it has at least threshold black neighbors,
+ for dilation a black pixel stays black and for erosion a white pixel
+ stays white, the one pixel frame of the output is always white
+
+ @param m the bitmap to work on
+ @param threshold minimal number of black neighbors 0..9
+ @param erode TRUE-erosion FALSE-dilation
+ @return newly allocated ho_bitmap
+ */
+static ho_bitmap *
+ho_bitmap_morph_3x3 (const ho_bitmap * m, const int threshold,
+  const unsigned char erode)
 {
   ho_bitmap *m_out;
-  int x, y;
-  unsigned char sum;
+  uint64_t *buffer;
+  uint64_t *up, *mid, *down, *temp, *out, *mask;
+  uint64_t n[8];
+  uint64_t s[4];
+  uint64_t center, result;
+  int n_words;
+  int i, k, y;
 
-  if (!m)
-    return NULL;
-  
   /* 
    * allocate memory 
    */
@@ -430,32 +839,125 @@ ho_bitmap_erosion_n (const ho_bitmap * m, const unsigned char n)
   m_out->com_line_fill = m->com_line_fill;
   m_out->nikud = m->nikud;
 
+  if (m->width < 3 || m->height < 3)
+    return m_out;
+
   /* 
-   * do erosion 
+   * three input rows, an output row and a mask row, the input rows have a
+   * white word on each side 
    */
-  for (x = 1; x < m->width - 1; x++)
-    for (y = 1; y < m->height - 1; y++)
+  n_words = ho_bitmap_get_n_words (m);
+  buffer = (uint64_t *) calloc (5 * (n_words + 2), sizeof (uint64_t));
+  if (!buffer)
+  {
+    ho_bitmap_free (m_out);
+    return NULL;
+  }
+  up = buffer + 1;
+  mid = up + n_words + 2;
+  down = mid + n_words + 2;
+  out = down + n_words + 2;
+  mask = out + n_words + 2;
+
+  /* only the inner pixels are changed */
+  ho_bitmap_row_mask (mask, n_words, 1, m->width - 1);
+
+  ho_bitmap_get_row_words (m, 0, mid);
+  ho_bitmap_get_row_words (m, 1, down);
+
+  for (y = 1; y < m->height - 1; y++)
+  {
+    /* slide the rows window one row down */
+    temp = up;
+    up = mid;
+    mid = down;
+    down = temp;
+    ho_bitmap_get_row_words (m, y + 1, down);
+
+    for (i = 0; i < n_words; i++)
     {
-      /* 
-       * if black pixel 
-       */
-      if (ho_bitmap_get (m, x, y))
+      /* get neigbors, shifted so each bit is aligned with its pixel */
+      n[0] = (up[i] >> 1) | (up[i - 1] << 63);
+      n[1] = up[i];
+      n[2] = (up[i] << 1) | (up[i + 1] >> 63);
+      n[3] = (mid[i] >> 1) | (mid[i - 1] << 63);
+      n[4] = (mid[i] << 1) | (mid[i + 1] >> 63);
+      n[5] = (down[i] >> 1) | (down[i - 1] << 63);
+      n[6] = down[i];
+      n[7] = (down[i] << 1) | (down[i + 1] >> 63);
+      center = mid[i];
+
+      if (!erode && threshold == 1)
       {
-        sum = ho_bitmap_get (m, x - 1, y - 1) +
-          ho_bitmap_get (m, x - 1, y) +
-          ho_bitmap_get (m, x - 1, y + 1) +
-          ho_bitmap_get (m, x, y - 1) +
-          ho_bitmap_get (m, x, y + 1) +
-          ho_bitmap_get (m, x + 1, y - 1) +
-          ho_bitmap_get (m, x + 1, y) + ho_bitmap_get (m, x + 1, y + 1);
-        if ((8 - sum) < n)
-          ho_bitmap_set (m_out, x, y);
+        /* plain dilation, any black neighbor */
+        result = center | n[0] | n[1] | n[2] | n[3] | n[4] | n[5] | n[6] |
+          n[7];
       }
+      else if (erode && threshold == 8)
+      {
+        /* plain erosion, no white neighbor */
+        result = center & n[0] & n[1] & n[2] & n[3] & n[4] & n[5] & n[6] &
+          n[7];
+      }
+      else
+      {
+        /* count black neighbors */
+        s[0] = s[1] = s[2] = s[3] = 0;
+        for (k = 0; k < 8; k++)
+          ho_bitmap_count_add (s, n[k]);
+
+        if (threshold > 8)
+          result = 0;
+        else
+          result = ho_bitmap_count_ge (s, threshold);
+
+        if (erode)
+          result &= center;
+        else
+          result |= center;
+      }
+
+      out[i] = result & mask[i];
     }
 
+    ho_bitmap_set_row_words (m_out, y, out);
+  }
+
+  free (buffer);
+
   return m_out;
 }
 
+ho_bitmap *
+ho_bitmap_dilation_n (const ho_bitmap * m, const unsigned char n)
+{
+  if (!m)
+    return NULL;
+
+  /* 
+   * white pixel with n black neighbors or more turns black 
+   */
+  return ho_bitmap_morph_3x3 (m, n, FALSE);
+}
+
+ho_bitmap *
+ho_bitmap_erosion_n (const ho_bitmap * m, const unsigned char n)
+{
+  if (!m)
+    return NULL;
+
+  /* 
+   * black pixel with n white neighbors or more turns white, e.g. it stays
+   * black if it has more then 8 - n black neighbors 
+   */
+  if (!n)
+    return ho_bitmap_morph_3x3 (m, 9, TRUE);
+  if (n > 8)
+    return ho_bitmap_morph_3x3 (m, 0, TRUE);
+
+  return ho_bitmap_morph_3x3 (m, 9 - n, TRUE);
+}
+
 ho_bitmap *
 ho_bitmap_set_height (const ho_bitmap * m, const int height, const int top,
   const int bottom)
@@ -818,11 +1320,111 @@ ho_bitmap_edge (const ho_bitmap * m, const int n)
   return m_out;
 }
 
+/* number of set bits in a word */
+static int
+ho_bitmap_popcount64 (uint64_t word)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll (word);
+#else
+  word = word - ((word >> 1) & 0x5555555555555555ULL);
+  word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+  word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (int) ((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/* count the black pixels of a row span starting at pixel x of data */
+static int
+ho_bitmap_count_bits (const unsigned char *data, const int x, const int width)
+{
+  unsigned char mask_start, mask_end;
+  uint64_t word;
+  int byte_start, byte_end;
+  int i, count;
+
+  if (width < 1)
+    return 0;
+
+  byte_start = x / 8;
+  byte_end = (x + width - 1) / 8;
+  mask_start = 0xff >> (x % 8);
+  mask_end = 0xff << (7 - (x + width - 1) % 8);
+
+  /* span inside one byte */
+  if (byte_start == byte_end)
+    return ho_bitmap_popcount64 (data[byte_start] & mask_start & mask_end);
+
+  count = ho_bitmap_popcount64 (data[byte_start] & mask_start);
+  count += ho_bitmap_popcount64 (data[byte_end] & mask_end);
+
+  /* full bytes, 8 at a time */
+  for (i = byte_start + 1; i + 8 <= byte_end; i += 8)
+  {
+    memcpy (&word, data + i, 8);
+    count += ho_bitmap_popcount64 (word);
+  }
+  for (; i < byte_end; i++)
+    count += ho_bitmap_popcount64 (data[i]);
+
+  return count;
+}
+
+int
+ho_bitmap_count_row (const ho_bitmap * m, const int x, const int y,
+  const int width)
+{
+  return ho_bitmap_count_bits (m->data + y * m->rowstride, x, width);
+}
+
+int
+ho_bitmap_view_count_row (const ho_bitmap_view * v, const int x,
+  const int y, const int width)
+{
+  return ho_bitmap_count_bits (v->data + y * v->rowstride,
+    v->bit_offset + x, width);
+}
+
+int
+ho_bitmap_count_columns (const ho_bitmap * m, const int y, const int height,
+  int *sums)
+{
+  uint64_t *row;
+  uint64_t word;
+  int n_words;
+  int i, x, y1, y2;
+
+  /* clip to bitmap */
+  y1 = (y < 0) ? 0 : y;
+  y2 = (y + height > m->height) ? m->height : y + height;
+  if (y2 <= y1)
+    return FALSE;
+
+  n_words = ho_bitmap_get_n_words (m);
+  row = (uint64_t *) malloc (n_words * sizeof (uint64_t));
+  if (!row)
+    return TRUE;
+
+  for (; y1 < y2; y1++)
+  {
+    ho_bitmap_get_row_words (m, y1, row);
+
+    /* bits right of the last pixel are zero, stop at the last black pixel */
+    for (i = 0; i < n_words; i++)
+      for (word = row[i], x = i * 64; word; word <<= 1, x++)
+        sums[x] += (int) (word >> 63);
+  }
+
+  free (row);
+
+  return FALSE;
+}
+
 double
 ho_bitmap_get_fill (const ho_bitmap * m, const int x, const int y,
   const int width, const int height)
 {
-  int current_x, current_y;
+  int current_y;
   int fill;
 
   if (!width || !height || x < 0 || y < 0 || (x + width) > m->width
@@ -831,8 +1433,25 @@ ho_bitmap_get_fill (const ho_bitmap * m, const int x, const int y,
 
   fill = 0;
   for (current_y = y; current_y < y + height; current_y++)
-    for (current_x = x; current_x < x + width; current_x++)
-      fill += ho_bitmap_get (m, current_x, current_y);
+    fill += ho_bitmap_count_row (m, x, current_y, width);
+
+  return (double) fill / (double) (width * height);
+}
+
+double
+ho_bitmap_view_get_fill (const ho_bitmap_view * v, const int x,
+  const int y, const int width, const int height)
+{
+  int current_y;
+  int fill;
+
+  if (!width || !height || x < 0 || y < 0 || (x + width) > v->width
+    || (y + height) > v->height)
+    return -1.0;
+
+  fill = 0;
+  for (current_y = y; current_y < y + height; current_y++)
+    fill += ho_bitmap_view_count_row (v, x, current_y, width);
 
   return (double) fill / (double) (width * height);
 }
@@ -946,12 +1565,27 @@ ho_bitmap_draw_box_empty (ho_bitmap * m, const int x, const int y,
 ho_bitmap *
 ho_bitmap_filter_by_size (const ho_bitmap * m,
   int min_height, int max_height, int min_width, int max_width)
+{
+  return ho_bitmap_filter_by_size_threads (m, min_height, max_height,
+    min_width, max_width, 1);
+}
+
+ho_bitmap *
+ho_bitmap_filter_by_size_threads (const ho_bitmap * m,
+  int min_height, int max_height, int min_width, int max_width,
+  const int n_threads)
 {
   ho_objmap *m_obj;
   ho_bitmap *m_out;
 
-  /* create a new objmap */
-  m_obj = ho_objmap_new_from_bitmap (m);
+  /* 
+   * create a new objmap, one thread uses compact runs storage, threads 
+   * label a full map 
+   */
+  if (n_threads > 1)
+    m_obj = ho_objmap_new_from_bitmap_threads (m, n_threads);
+  else
+    m_obj = ho_objmap_new_from_bitmap_runs (m);
 
   if (!m_obj)
     return NULL;
@@ -975,7 +1609,7 @@ ho_bitmap_filter_boxes (const ho_bitmap * m, const int leeway_down,
   int x, y, width, height;
 
   /* allocate memory */
-  m_obj = ho_objmap_new_from_bitmap (m);
+  m_obj = ho_objmap_new_from_bitmap_runs (m);
   if (!m_obj)
     return NULL;
   m_out = ho_bitmap_new (m->width, m->height);
@@ -1026,10 +1660,11 @@ ho_bitmap_filter_fill (const ho_bitmap * m)
   ho_bitmap *m_temp1;
   ho_bitmap *m_temp2;
   int index;
+  int x, y, x1, y1;
   int width, height;
 
-  /* allocate memory */
-  m_obj = ho_objmap_new_from_bitmap (m);
+  /* allocate memory, the objects are labeled once as runs */
+  m_obj = ho_objmap_new_from_bitmap_runs (m);
   if (!m_obj)
     return NULL;
 
@@ -1055,23 +1690,39 @@ ho_bitmap_filter_fill (const ho_bitmap * m)
   for (index = 0; index < m_obj->obj_list->size; index++)
   {
     /* get a dimention factor */
+    x1 = (((m_obj->obj_list)->objects)[index]).x;
+    y1 = (((m_obj->obj_list)->objects)[index]).y;
     width = (((m_obj->obj_list)->objects)[index]).width;
     height = (((m_obj->obj_list)->objects)[index]).height;
 
-    /* copy only the current object to a new bitmap */
-    m_temp1 = ho_objmap_to_bitmap_by_index (m_obj, index);
+    /* 
+     * copy only the current object to a bitmap of its box, linking inside
+     * the box is the same as linking the object on a full page 
+     */
+    m_temp1 = ho_objmap_to_bitmap_by_index_window (m_obj, index, 0);
+    if (!m_temp1)
+      continue;
 
     /* fill the current object */
     m_temp2 = ho_bitmap_hlink (m_temp1, width / 4);
     ho_bitmap_free (m_temp1);
+    if (!m_temp2)
+      continue;
     m_temp1 = ho_bitmap_vlink (m_temp2, height / 4);
     ho_bitmap_free (m_temp2);
+    if (!m_temp1)
+      continue;
 
     /* add to matrix out */
-    ho_bitmap_or (m_out, m_temp1);
+    for (y = 0; y < height; y++)
+      for (x = 0; x < width; x++)
+        if (ho_bitmap_get (m_temp1, x, y))
+          ho_bitmap_set (m_out, x + x1, y + y1);
     ho_bitmap_free (m_temp1);
   }
 
+  ho_objmap_free (m_obj);
+
   return m_out;
 }
 
@@ -1209,6 +1860,15 @@ ho_bitmap_filter_hlink (ho_bitmap * m, int size, int max_height)
   return m_out;
 }
 
+/* keep objects bigger than a quarter of the bitmap in user_data */
+static int
+ho_bitmap_filter_keep_big (const ho_obj * object, void *user_data)
+{
+  const ho_bitmap *m = (const ho_bitmap *) user_data;
+
+  return (object->width > m->width / 4 || object->height > m->height / 4);
+}
+
 ho_bitmap *
 ho_bitmap_filter_remove_dots (const ho_bitmap * m,
   const unsigned char erosion_n, const unsigned char dilation_n)
@@ -1216,10 +1876,8 @@ ho_bitmap_filter_remove_dots (const ho_bitmap * m,
   int x, y;
   unsigned char sum;
   ho_bitmap *m_temp;
+  ho_bitmap *m_big;
   ho_bitmap *m_out;
-  ho_objmap *m_obj;
-  int index;
-  int width, height;
 
   /* allocate memory */
   m_out = ho_bitmap_new (m->width, m->height);
@@ -1239,30 +1897,27 @@ ho_bitmap_filter_remove_dots (const ho_bitmap * m,
 
   /* connect all the small dots */
   m_temp = ho_bitmap_dilation (m);
+  if (!m_temp)
+  {
+    ho_bitmap_free (m_out);
+    return NULL;
+  }
 
-  /* check the size of objects */
-  m_obj = ho_objmap_new_from_bitmap (m_temp);
+  /* mark the pixels of big objects */
+  m_big = ho_objmap_filter_bitmap (m_temp, ho_bitmap_filter_keep_big,
+    (void *) m);
   ho_bitmap_free (m_temp);
+  if (!m_big)
+  {
+    ho_bitmap_free (m_out);
+    return NULL;
+  }
 
   for (x = 1; x < (m->width - 1); x++)
     for (y = 1; y < (m->height - 1); y++)
     {
-
-      /* check the size of this pixel's object */
-      index = ho_objmap_get (m_obj, x, y);
-      if (index)
-      {
-        width = (((m_obj->obj_list)->objects)[index - 1]).width;
-        height = (((m_obj->obj_list)->objects)[index - 1]).height;
-      }
-      else
-      {
-        width = 0;
-        height = 0;
-      }
-
       /* in a big object do erosion */
-      if (width > m->width / 4 || height > m->height / 4)
+      if (ho_bitmap_get (m_big, x, y))
       {
         if (ho_bitmap_get (m, x, y))  /* black pixel */
         {
@@ -1298,7 +1953,7 @@ ho_bitmap_filter_remove_dots (const ho_bitmap * m,
       }
     }
 
-  ho_objmap_free (m_obj);
+  ho_bitmap_free (m_big);
 
   return m_out;
 }
@@ -1392,7 +2047,7 @@ ho_bitmap_filter_count_objects (const ho_bitmap * m)
   ho_objmap *o_obj;
   int count;
 
-  o_obj = ho_objmap_new_from_bitmap (m);
+  o_obj = ho_objmap_new_from_bitmap_runs (m);
   if (!o_obj)
     return -1;
 
@@ -1482,6 +2137,308 @@ ho_bitmap_rotate (const ho_bitmap * m, const double angle)
   return m_out;
 }
 
+/* copy the page information of m to m_out */
+static void
+ho_bitmap_copy_info (ho_bitmap * m_out, const ho_bitmap * m)
+{
+  m_out->x = m->x;
+  m_out->y = m->y;
+
+  m_out->type = m->type;
+  m_out->font_height = m->font_height;
+  m_out->font_width = m->font_width;
+  m_out->font_spacing = m->font_spacing;
+  m_out->line_spacing = m->line_spacing;
+  m_out->avg_line_fill = m->avg_line_fill;
+  m_out->com_line_fill = m->com_line_fill;
+  m_out->nikud = m->nikud;
+}
+
+/* 
+ * out pixel x is in pixel x + shift, pixels outside in are white 
+ */
+static void
+ho_bitmap_words_shift (uint64_t * out, const int n_out, const uint64_t * in,
+  const int n_in, const int shift)
+{
+  int word_shift, bit_shift;
+  int i, j;
+
+  /* floor division, shift may be negative */
+  word_shift = (shift >= 0) ? shift / 64 : -((-shift + 63) / 64);
+  bit_shift = shift - word_shift * 64;
+
+  for (i = 0; i < n_out; i++)
+  {
+    j = i + word_shift;
+    out[i] = 0;
+    if (j >= 0 && j < n_in)
+      out[i] = in[j] << bit_shift;
+    if (bit_shift && j + 1 >= 0 && j + 1 < n_in)
+      out[i] |= in[j + 1] >> (64 - bit_shift);
+  }
+}
+
+/* clear the bits right of pixel width - 1 */
+static void
+ho_bitmap_words_clip (uint64_t * row, const int n_words, const int width)
+{
+  int i;
+
+  for (i = (width + 63) / 64; i < n_words; i++)
+    row[i] = 0;
+  if (width % 64)
+    row[width / 64] &= ~(uint64_t) 0 << (64 - width % 64);
+}
+
+/* 
+ * horizontal mirror of a row, out pixel x is in pixel width - 1 - x 
+ */
+static void
+ho_bitmap_words_mirror (uint64_t * out, uint64_t * temp, const uint64_t * in,
+  const int n_words, const int width)
+{
+  uint64_t w;
+  int i;
+
+  /* reverse the bits of all words, then the word order */
+  for (i = 0; i < n_words; i++)
+  {
+    w = in[n_words - 1 - i];
+    w = ((w >> 1) & 0x5555555555555555ULL) | ((w & 0x5555555555555555ULL) << 1);
+    w = ((w >> 2) & 0x3333333333333333ULL) | ((w & 0x3333333333333333ULL) << 2);
+    w = ((w >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((w & 0x0f0f0f0f0f0f0f0fULL) << 4);
+    w = ((w >> 8) & 0x00ff00ff00ff00ffULL) | ((w & 0x00ff00ff00ff00ffULL) << 8);
+    w = ((w >> 16) & 0x0000ffff0000ffffULL) | ((w & 0x0000ffff0000ffffULL) <<
+      16);
+    temp[i] = (w >> 32) | (w << 32);
+  }
+
+  /* the mirrored row starts with the padding bits */
+  ho_bitmap_words_shift (out, n_words, temp, n_words, n_words * 64 - width);
+}
+
+/* 
+ * transpose of m, out pixel x,y is m pixel y,x. 8x8 pixel blocks are
+ * transposed as one 64 bit word 
+ */
+static ho_bitmap *
+ho_bitmap_transpose (const ho_bitmap * m)
+{
+  ho_bitmap *m_out;
+  uint64_t block, t;
+  int bx, by, i, row;
+
+  m_out = ho_bitmap_new (m->height, m->width);
+  if (!m_out)
+    return NULL;
+  ho_bitmap_copy_info (m_out, m);
+
+  for (by = 0; by < m_out->rowstride; by++)
+    for (bx = 0; bx < m->rowstride; bx++)
+    {
+      /* eight rows of one byte column, first row in the high byte */
+      block = 0;
+      for (i = 0; i < 8; i++)
+      {
+        row = by * 8 + i;
+        block <<= 8;
+        if (row < m->height)
+          block |= m->data[row * m->rowstride + bx];
+      }
+      if (!block)
+        continue;
+
+      t = (block ^ (block >> 7)) & 0x00aa00aa00aa00aaULL;
+      block = block ^ t ^ (t << 7);
+      t = (block ^ (block >> 14)) & 0x0000cccc0000ccccULL;
+      block = block ^ t ^ (t << 14);
+      t = (block ^ (block >> 28)) & 0x00000000f0f0f0f0ULL;
+      block = block ^ t ^ (t << 28);
+
+      /* byte i is now column bx * 8 + i */
+      for (i = 0; i < 8 && bx * 8 + i < m->width; i++)
+        m_out->data[(bx * 8 + i) * m_out->rowstride + by] =
+          (unsigned char) (block >> (56 - 8 * i));
+    }
+
+  return m_out;
+}
+
+ho_bitmap *
+ho_bitmap_rotate_right_angle (const ho_bitmap * m, const int quarter_turns)
+{
+  ho_bitmap *m_out;
+  ho_bitmap *m_temp;
+  uint64_t *row;
+  int n_words, turns;
+  int y;
+
+  turns = ((quarter_turns % 4) + 4) % 4;
+
+  /* 90 and 270 are a transpose and a mirror */
+  if (turns == 1 || turns == 3)
+  {
+    m_temp = ho_bitmap_transpose (m);
+    if (!m_temp)
+      return NULL;
+  }
+  else
+  {
+    m_temp = ho_bitmap_clone (m);
+    if (!m_temp || turns == 0)
+      return m_temp;
+  }
+
+  m_out = ho_bitmap_new (m_temp->width, m_temp->height);
+  n_words = ho_bitmap_get_n_words (m_temp);
+  row = (uint64_t *) malloc (3 * n_words * sizeof (uint64_t));
+  if (!m_out || !row)
+  {
+    if (m_out)
+      ho_bitmap_free (m_out);
+    if (row)
+      free (row);
+    ho_bitmap_free (m_temp);
+    return NULL;
+  }
+  ho_bitmap_copy_info (m_out, m);
+
+  for (y = 0; y < m_temp->height; y++)
+  {
+    if (turns == 3)
+    {
+      /* 270: out x,y is m x,width - 1 - y, transposed rows upside down */
+      memcpy (m_out->data + (m_temp->height - 1 - y) * m_out->rowstride,
+        m_temp->data + y * m_temp->rowstride, m_temp->rowstride);
+      continue;
+    }
+
+    /* 90: out x,y is m y,height - 1 - x, transposed rows mirrored */
+    /* 180: out x,y is m width - 1 - x,height - 1 - y */
+    ho_bitmap_get_row_words (m_temp, y, row);
+    ho_bitmap_words_mirror (row + n_words, row + 2 * n_words, row, n_words,
+      m_temp->width);
+    ho_bitmap_set_row_words (m_out,
+      (turns == 2) ? m_temp->height - 1 - y : y, row + n_words);
+  }
+
+  free (row);
+  ho_bitmap_free (m_temp);
+
+  return m_out;
+}
+
+ho_bitmap *
+ho_bitmap_shear_rotate (const ho_bitmap * m, const double angle)
+{
+  ho_bitmap *m_out = NULL;
+  uint64_t *canvas1 = NULL;
+  uint64_t *canvas2 = NULL;
+  uint64_t *row = NULL;
+  uint64_t *band_mask = NULL;
+  double angle_rads, a, b;
+  int n_words, n_canvas_words;
+  int pad_x, pad_y, canvas_width, canvas_height;
+  int y, i, dy, band_start, band_end, word_start, word_end;
+
+  /* 
+   * the rotation of ho_bitmap_rotate, out x,y is m x * cos + y * sin, 
+   * -x * sin + y * cos, as three shears: along x by tan(angle / 2), 
+   * along y by -sin(angle) and along x again. every shear moves whole
+   * rows or column bands by whole pixels 
+   */
+  angle_rads = angle * (2.0 * M_PI / 360);
+  a = tan (angle_rads / 2.0);
+  b = -sin (angle_rads);
+
+  /* the middle shear needs pixels the first one moved out of the page */
+  pad_x = (int) ceil (fabs (a) * m->height) + 1;
+  pad_y = (int) ceil (fabs (b) * (m->width + pad_x)) + 1;
+  canvas_width = m->width + 2 * pad_x;
+  canvas_height = m->height + 2 * pad_y;
+
+  n_words = ho_bitmap_get_n_words (m);
+  n_canvas_words = (canvas_width + 63) / 64;
+
+  m_out = ho_bitmap_new (m->width, m->height);
+  canvas1 = (uint64_t *) calloc ((size_t) canvas_height * n_canvas_words,
+    sizeof (uint64_t));
+  canvas2 = (uint64_t *) calloc ((size_t) canvas_height * n_canvas_words,
+    sizeof (uint64_t));
+  row = (uint64_t *) malloc ((n_words + n_canvas_words) * sizeof (uint64_t));
+  band_mask = (uint64_t *) malloc (n_canvas_words * sizeof (uint64_t));
+  if (!m_out || !canvas1 || !canvas2 || !row || !band_mask)
+  {
+    if (m_out)
+      ho_bitmap_free (m_out);
+    if (canvas1)
+      free (canvas1);
+    if (canvas2)
+      free (canvas2);
+    if (row)
+      free (row);
+    if (band_mask)
+      free (band_mask);
+    return NULL;
+  }
+  ho_bitmap_copy_info (m_out, m);
+
+  /* first shear, canvas1 x,y is m x + a * y,y */
+  for (y = 0; y < m->height; y++)
+  {
+    ho_bitmap_get_row_words (m, y, row);
+    ho_bitmap_words_shift (canvas1 + (size_t) (y + pad_y) * n_canvas_words,
+      n_canvas_words, row, n_words, (int) floor (a * y + 0.5) - pad_x);
+  }
+
+  /* second shear, canvas2 x,y is canvas1 x,y + b * x, in bands of 
+   * columns moved by the same number of rows */
+  for (band_start = 0; band_start < canvas_width; band_start = band_end)
+  {
+    dy = (int) floor (b * (band_start - pad_x) + 0.5);
+    for (band_end = band_start + 1; band_end < canvas_width
+      && (int) floor (b * (band_end - pad_x) + 0.5) == dy; band_end++);
+
+    word_start = band_start / 64;
+    word_end = (band_end - 1) / 64;
+    for (i = word_start; i <= word_end; i++)
+    {
+      band_mask[i] = ~(uint64_t) 0;
+      if (i == word_start)
+        band_mask[i] &= ~(uint64_t) 0 >> (band_start % 64);
+      if (i == word_end && band_end % 64)
+        band_mask[i] &= ~(uint64_t) 0 << (64 - band_end % 64);
+    }
+
+    for (y = 0; y < canvas_height; y++)
+    {
+      if (y + dy < 0 || y + dy >= canvas_height)
+        continue;
+      for (i = word_start; i <= word_end; i++)
+        canvas2[(size_t) y * n_canvas_words + i] |=
+          canvas1[(size_t) (y + dy) * n_canvas_words + i] & band_mask[i];
+    }
+  }
+
+  /* third shear, out x,y is canvas2 x + a * y,y */
+  for (y = 0; y < m->height; y++)
+  {
+    ho_bitmap_words_shift (row, n_words,
+      canvas2 + (size_t) (y + pad_y) * n_canvas_words, n_canvas_words,
+      (int) floor (a * y + 0.5) + pad_x);
+    ho_bitmap_words_clip (row, n_words, m->width);
+    ho_bitmap_set_row_words (m_out, y, row);
+  }
+
+  free (canvas1);
+  free (canvas2);
+  free (row);
+  free (band_mask);
+
+  return m_out;
+}
+
 int
 ho_bitmap_pnm_save (const ho_bitmap * m, const char *filename)
 {
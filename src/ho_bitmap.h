@@ -31,6 +31,8 @@
 #ifndef HO_BITMAP_H
 #define HO_BITMAP_H 1
 
+#include <stdint.h>
+
 /* hocr bitmap set/get macros */
 #define ho_bitmap_get(m,x,y) (((((m)->data[(x) / 8 + (y) * (m)->rowstride]) & (0x80 >> ((x) % 8))) > 0)?1:0)
 #define ho_bitmap_set(m,x,y) (((m)->data[(x) / 8 + (y) * (m)->rowstride]) |= (0x80 >> ((x) % 8)))
@@ -43,6 +45,18 @@
 #define ho_bitmap_get_width(m) ((m)->width)
 #define ho_bitmap_get_height(m) ((m)->height)
 
+/* number of 64 bit words in a bitmap row */
+#define ho_bitmap_get_n_words(m) (((m)->rowstride + 7) / 8)
+
+/* hocr bitmap view get macros */
+#define ho_bitmap_view_get(v,x,y) (((((v)->data[((x) + (v)->bit_offset) / 8 + (y) * (v)->rowstride]) & (0x80 >> (((x) + (v)->bit_offset) % 8))) > 0)?1:0)
+
+#define ho_bitmap_view_get_width(v) ((v)->width)
+#define ho_bitmap_view_get_height(v) ((v)->height)
+
+/* number of 64 bit words in a bitmap view row */
+#define ho_bitmap_view_get_n_words(v) (((v)->width + 63) / 64)
+
 /** @struct ho_bitmap
   @brief libhocr bitmap struct
 */
@@ -67,6 +81,27 @@ typedef struct
   unsigned char *data;
 } ho_bitmap;
 
+/** @struct ho_bitmap_view
+  @brief libhocr read only window into an ho_bitmap
+  
+  a view does not own its data, it is valid as long as the parent bitmap
+  is not freed. x and y are the origin of the window in page coordinates
+  like in ho_bitmap, data points to the first byte of the window in the
+  parent and bit_offset is the first pixel column inside that byte
+*/
+typedef struct
+{
+  const ho_bitmap *parent;
+
+  int x;
+  int y;
+  int height;
+  int width;
+  int bit_offset;
+  int rowstride;
+  const unsigned char *data;
+} ho_bitmap_view;
+
 /**
  new ho_bitamp
  
@@ -95,6 +130,10 @@ ho_bitmap *ho_bitmap_clone (const ho_bitmap * m);
 /**
  copy a window from a bitmap
  
+ the new bitmap is width x height at m->x + x, m->y + y even if the window
+ is not inside m, parts outside m are white. pixels on the first row and
+ column of m are not copied
+ 
  @param m the bitmap to copy
  @param x x-start of window
  @param y y-start of window
@@ -105,6 +144,69 @@ ho_bitmap *ho_bitmap_clone (const ho_bitmap * m);
 ho_bitmap *ho_bitmap_clone_window (const ho_bitmap * m, const int x,
   const int y, const int width, const int height);
 
+/**
+ set a view to a window of a bitmap, no data is copied
+ 
+ @param v the view to set
+ @param m the parent bitmap
+ @param x x-start of window
+ @param y y-start of window
+ @param width width of window
+ @param height height of window
+ @return FALSE, the window is clipped to the parent bitmap
+ */
+int ho_bitmap_view_init (ho_bitmap_view * v, const ho_bitmap * m,
+  const int x, const int y, const int width, const int height);
+
+/**
+ copy a bitmap view into a new bitmap
+ 
+ unlike ho_bitmap_clone_window the new bitmap has the clipped size and
+ origin of the view, and pixels on the first row and column of the parent
+ are copied
+ 
+ @param v the view to copy
+ @return newly allocated ho_bitmap
+ */
+ho_bitmap *ho_bitmap_new_from_view (const ho_bitmap_view * v);
+
+/**
+ read a bitmap view row as 64 bit words, same layout as 
+ ho_bitmap_get_row_words
+ 
+ @param v the view to read
+ @param y the row to read
+ @param row array of ho_bitmap_view_get_n_words(v) words to fill
+ @return FALSE
+ */
+int ho_bitmap_view_get_row_words (const ho_bitmap_view * v, const int y,
+  uint64_t * row);
+
+/**
+ count the black pixels in a row span of a view
+ 
+ @param v pointer to an ho_bitmap_view
+ @param x x-start of span
+ @param y the row
+ @param width width of span
+ @return number of black pixels
+ */
+int ho_bitmap_view_count_row (const ho_bitmap_view * v, const int x,
+  const int y, const int width);
+
+/**
+ return the ratio fill/volume value of a rectangle in a view
+ 
+ @param v pointer to an ho_bitmap_view
+ @param x x of rectangel
+ @param y y of rectangel
+ @param width width of rectangel
+ @param height height of rectangel
+ @return the ratio value
+ */
+double ho_bitmap_view_get_fill (const ho_bitmap_view * v, const int x,
+  const int y, const int width, const int height);
+
 /**
  do bitwise and of two bitmaps
  
@@ -158,6 +260,96 @@ int ho_bitmap_copy (ho_bitmap * m_left, const ho_bitmap * m_right);
  */
 ho_bitmap *ho_bitmap_not (const ho_bitmap * m);
 
+/**
+ do bitwise and of two bitmaps into a third bitmap
+ 
+ m_out may be one of the operands
+ 
+ @param m_out the bitmap to write into
+ @param m_left the left hand bitmap
+ @param m_right the right hand bitmap
+ @return FALSE
+ */
+int ho_bitmap_and_to (ho_bitmap * m_out, const ho_bitmap * m_left,
+  const ho_bitmap * m_right);
+
+/**
+ do bitwise or of two bitmaps into a third bitmap
+ 
+ m_out may be one of the operands
+ 
+ @param m_out the bitmap to write into
+ @param m_left the left hand bitmap
+ @param m_right the right hand bitmap
+ @return FALSE
+ */
+int ho_bitmap_or_to (ho_bitmap * m_out, const ho_bitmap * m_left,
+  const ho_bitmap * m_right);
+
+/**
+ do bitwise xor of two bitmaps into a third bitmap
+ 
+ m_out may be one of the operands
+ 
+ @param m_out the bitmap to write into
+ @param m_left the left hand bitmap
+ @param m_right the right hand bitmap
+ @return FALSE
+ */
+int ho_bitmap_xor_to (ho_bitmap * m_out, const ho_bitmap * m_left,
+  const ho_bitmap * m_right);
+
+/**
+ do bitwise and not of two bitmaps into a third bitmap
+ 
+ m_out may be one of the operands
+ 
+ @param m_out the bitmap to write into
+ @param m_left the left hand bitmap
+ @param m_right the right hand bitmap
+ @return FALSE
+ */
+int ho_bitmap_andnot_to (ho_bitmap * m_out, const ho_bitmap * m_left,
+  const ho_bitmap * m_right);
+
+/**
+ do bitwise not of a bitmap into another bitmap
+ 
+ @param m_out the bitmap to write into
+ @param m the bitmap to invert
+ @return FALSE
+ */
+int ho_bitmap_not_to (ho_bitmap * m_out, const ho_bitmap * m);
+
+/**
+ do bitwise not of a bitmap in place
+ 
+ @param m the bitmap to invert
+ @return FALSE
+ */
+int ho_bitmap_not_inplace (ho_bitmap * m);
+
+/**
+ read a bitmap row as 64 bit words, the left most pixel of a word is its
+ most significant bit, bits right of the last pixel are zero
+ 
+ @param m the bitmap to read
+ @param y the row to read
+ @param row array of ho_bitmap_get_n_words(m) words to fill
+ @return FALSE
+ */
+int ho_bitmap_get_row_words (const ho_bitmap * m, const int y, uint64_t * row);
+
+/**
+ write a bitmap row from 64 bit words
+ 
+ @param m the bitmap to write into
+ @param y the row to write
+ @param row array of ho_bitmap_get_n_words(m) words
+ @return FALSE
+ */
+int ho_bitmap_set_row_words (ho_bitmap * m, const int y, const uint64_t * row);
+
 /**
  dilation of a a bitmap with 3x3 box
  
@@ -268,6 +460,30 @@ ho_bitmap *ho_bitmap_vlink (const ho_bitmap * m, const int size);
  */
 ho_bitmap *ho_bitmap_edge (const ho_bitmap * m, const int n);
 
+/**
+ count the black pixels in a row span
+ 
+ @param m pointer to an ho_bitmap
+ @param x x-start of span
+ @param y the row
+ @param width width of span
+ @return number of black pixels
+ */
+int ho_bitmap_count_row (const ho_bitmap * m, const int x, const int y,
+  const int width);
+
+/**
+ count the black pixels in each column of a span of rows
+ 
+ @param m pointer to an ho_bitmap
+ @param y y-start of span
+ @param height height of span, the span is clipped to the bitmap
+ @param sums array of m->width counts, the counts are added to it
+ @return FALSE
+ */
+int ho_bitmap_count_columns (const ho_bitmap * m, const int y,
+  const int height, int *sums);
+
 /**
  return the ratio fill/volume value of a rectangle in the bitmap
  
@@ -305,6 +521,21 @@ ho_bitmap *ho_bitmap_filter_hlink (ho_bitmap * m, int size, int max_height);
 ho_bitmap *ho_bitmap_filter_by_size (const ho_bitmap * m,
   int min_height, int max_height, int min_width, int max_width);
 
+/**
+ copy objects from bitmap to bitmap by size, label objects on threads
+ 
+ @param m pointer to an ho_bitmap
+ @param min_height only objects with this minimal height are copied
+ @param max_height only objects with this maximal height are copied
+ @param min_width only objects with this minimal width are copied
+ @param max_width only objects with this maximal width are copied
+ @param n_threads number of threads to use, 0 or 1 for one thread
+ @return a newly allocated bitmap
+ */
+ho_bitmap *ho_bitmap_filter_by_size_threads (const ho_bitmap * m,
+  int min_height, int max_height, int min_width, int max_width,
+  const int n_threads);
+
 /**
  copy boxed objects from bitmap
  
@@ -466,6 +697,27 @@ ho_bitmap_delete_hline (ho_bitmap * m, const int x, const int y,
 ho_bitmap *
 ho_bitmap_rotate (const ho_bitmap * m, const double angle);
 
+/**
+ rotate a bitmap by three shears, same as ho_bitmap_rotate for small
+ angles but moves whole words of pixels
+ 
+ @param m the bitmap to rotate
+ @param angle the angle in deg.
+ @return newly allocated ho_bitmap
+ */
+ho_bitmap *
+ho_bitmap_shear_rotate (const ho_bitmap * m, const double angle);
+
+/**
+ rotate a bitmap clockwise by whole quarter turns, exact
+ 
+ @param m the bitmap to rotate
+ @param quarter_turns number of 90 deg. turns
+ @return newly allocated ho_bitmap, width and height are swapped for odd turns
+ */
+ho_bitmap *
+ho_bitmap_rotate_right_angle (const ho_bitmap * m, const int quarter_turns);
+
 /**
  writes ho_bitmap to pnm file
  
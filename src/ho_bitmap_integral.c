@@ -0,0 +1,189 @@
+/***************************************************************************
+ *            ho_bitmap_integral.c
+ *
+ *  Sat Oct 17 2026
+ *  Copyright  2026  hebocr authors
+ ****************************************************************************/
+
+/*  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "hebocr_globals.h"
+#include "ho_bitmap.h"
+#include "ho_bitmap_integral.h"
+
+ho_bitmap_integral *
+ho_bitmap_integral_new (const ho_bitmap * m)
+{
+  ho_bitmap_view v;
+
+  if (!m)
+    return NULL;
+
+  ho_bitmap_view_init (&v, m, 0, 0, m->width, m->height);
+
+  return ho_bitmap_integral_new_from_view (&v);
+}
+
+ho_bitmap_integral *
+ho_bitmap_integral_new_from_view (const ho_bitmap_view * v)
+{
+  ho_bitmap_integral *m_new = NULL;
+  uint64_t *row;
+  uint64_t word;
+  int *sum_above;
+  int *sum;
+  int n_words;
+  int running;
+  int i, x, x_end, y;
+
+  if (!v)
+    return NULL;
+
+  /* 
+   * allocate memory
+   */
+  m_new = (ho_bitmap_integral *) malloc (sizeof (ho_bitmap_integral));
+  if (!m_new)
+    return NULL;
+
+  m_new->width = v->width;
+  m_new->height = v->height;
+
+  /* first row and column are zero */
+  m_new->data =
+    (int *) calloc ((v->width + 1) * (v->height + 1), sizeof (int));
+  if (!(m_new->data))
+  {
+    free (m_new);
+    return NULL;
+  }
+
+  n_words = ho_bitmap_view_get_n_words (v);
+  row = (uint64_t *) malloc (n_words * sizeof (uint64_t));
+  if (!row)
+  {
+    ho_bitmap_integral_free (m_new);
+    return NULL;
+  }
+
+  /* 
+   * fill the table row by row, cell = cell above + black pixels left of 
+   * it in this row
+   */
+  for (y = 0; y < v->height; y++)
+  {
+    ho_bitmap_view_get_row_words (v, y, row);
+    sum_above = m_new->data + y * (v->width + 1) + 1;
+    sum = sum_above + v->width + 1;
+    running = 0;
+
+    for (i = 0; i < n_words; i++)
+    {
+      word = row[i];
+      x = i * 64;
+      x_end = x + 64;
+      if (x_end > v->width)
+        x_end = v->width;
+
+      /* white word, most of a text page */
+      if (!word)
+      {
+        for (; x < x_end; x++)
+          sum[x] = sum_above[x] + running;
+        continue;
+      }
+
+      for (; x < x_end; x++, word <<= 1)
+      {
+        running += (int) (word >> 63);
+        sum[x] = sum_above[x] + running;
+      }
+    }
+  }
+
+  free (row);
+
+  return m_new;
+}
+
+int
+ho_bitmap_integral_free (ho_bitmap_integral * m)
+{
+  if (!m)
+    return TRUE;
+
+  if (m->data)
+    free (m->data);
+
+  free (m);
+
+  return FALSE;
+}
+
+int
+ho_bitmap_integral_count (const ho_bitmap_integral * m, const int x,
+  const int y, const int width, const int height)
+{
+  int x1 = x, y1 = y;
+  int x2 = x + width, y2 = y + height;
+
+  /* clip to bitmap */
+  if (x1 < 0)
+    x1 = 0;
+  if (y1 < 0)
+    y1 = 0;
+  if (x2 > m->width)
+    x2 = m->width;
+  if (y2 > m->height)
+    y2 = m->height;
+
+  if (x2 <= x1 || y2 <= y1)
+    return 0;
+
+  return ho_bitmap_integral_get (m, x2, y2) - ho_bitmap_integral_get (m, x1,
+    y2) - ho_bitmap_integral_get (m, x2, y1) + ho_bitmap_integral_get (m, x1,
+    y1);
+}
+
+int
+ho_bitmap_integral_row_sum (const ho_bitmap_integral * m, const int x,
+  const int y, const int width)
+{
+  return ho_bitmap_integral_count (m, x, y, width, 1);
+}
+
+int
+ho_bitmap_integral_column_sum (const ho_bitmap_integral * m, const int x,
+  const int y, const int height)
+{
+  return ho_bitmap_integral_count (m, x, y, 1, height);
+}
+
+double
+ho_bitmap_integral_get_fill (const ho_bitmap_integral * m, const int x,
+  const int y, const int width, const int height)
+{
+  if (!width || !height || x < 0 || y < 0 || (x + width) > m->width
+    || (y + height) > m->height)
+    return -1.0;
+
+  return (double) ho_bitmap_integral_count (m, x, y, width, height) /
+    (double) (width * height);
+}
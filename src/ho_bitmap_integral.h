@@ -0,0 +1,132 @@
+/***************************************************************************
+ *            ho_bitmap_integral.h
+ *
+ *  Sat Oct 17 2026
+ *  Copyright  2026  hebocr authors
+ ****************************************************************************/
+
+/*  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file ho_bitmap_integral.h
+    @brief libhocr C language header.
+    
+    libhocr - LIBrary for Hebrew Optical Character Recognition 
+*/
+
+#ifndef HO_BITMAP_INTEGRAL_H
+#define HO_BITMAP_INTEGRAL_H 1
+
+#include <ho_bitmap.h>
+
+/* hocr bitmap_integral get macros */
+
+#define ho_bitmap_integral_get_width(m) ((m)->width)
+#define ho_bitmap_integral_get_height(m) ((m)->height)
+
+/* number of black pixels in the rectangle 0,0 .. x-1,y-1 */
+#define ho_bitmap_integral_get(m,x,y) (((m)->data)[(x) + (y) * ((m)->width + 1)])
+
+/** @struct ho_bitmap_integral
+  @brief libhocr bitmap summed area table struct
+  
+  data holds (width + 1) x (height + 1) cells, the first row and column 
+  are zero
+*/
+typedef struct
+{
+  int height;
+  int width;
+
+  int *data;
+} ho_bitmap_integral;
+
+/**
+ new ho_bitmap_integral from ho_bitmap data
+ 
+ @param m pointer to an ho_bitmap
+ @return newly allocated ho_bitmap_integral
+ */
+ho_bitmap_integral *ho_bitmap_integral_new (const ho_bitmap * m);
+
+/**
+ new ho_bitmap_integral from an ho_bitmap_view window
+ 
+ @param v pointer to an ho_bitmap_view
+ @return newly allocated ho_bitmap_integral
+ */
+ho_bitmap_integral *ho_bitmap_integral_new_from_view (const ho_bitmap_view *
+  v);
+
+/**
+ free an ho_bitmap_integral
+ 
+ @param m pointer to an ho_bitmap_integral
+ @return FALSE
+ */
+int ho_bitmap_integral_free (ho_bitmap_integral * m);
+
+/**
+ count the black pixels in a rectangle
+ 
+ @param m pointer to an ho_bitmap_integral
+ @param x x of rectangle
+ @param y y of rectangle
+ @param width width of rectangle
+ @param height height of rectangle
+ @return number of black pixels, rectangle is clipped to the bitmap
+ */
+int ho_bitmap_integral_count (const ho_bitmap_integral * m, const int x,
+  const int y, const int width, const int height);
+
+/**
+ count the black pixels in a row of a rectangle
+ 
+ @param m pointer to an ho_bitmap_integral
+ @param x x-start of row
+ @param y the row
+ @param width width of row
+ @return number of black pixels
+ */
+int ho_bitmap_integral_row_sum (const ho_bitmap_integral * m, const int x,
+  const int y, const int width);
+
+/**
+ count the black pixels in a column of a rectangle
+ 
+ @param m pointer to an ho_bitmap_integral
+ @param x the column
+ @param y y-start of column
+ @param height height of column
+ @return number of black pixels
+ */
+int ho_bitmap_integral_column_sum (const ho_bitmap_integral * m, const int x,
+  const int y, const int height);
+
+/**
+ return the ratio fill/volume value of a rectangle, same as 
+ ho_bitmap_get_fill 
+ 
+ @param m pointer to an ho_bitmap_integral
+ @param x x of rectangel
+ @param y y of rectangel
+ @param width width of rectangel
+ @param height height of rectangel
+ @return the ratio value
+ */
+double ho_bitmap_integral_get_fill (const ho_bitmap_integral * m,
+  const int x, const int y, const int width, const int height);
+
+#endif /* HO_BITMAP_INTEGRAL_H */
@@ -27,11 +27,14 @@
 #include <stdlib.h>
 #include <math.h>
 
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+
 #include "hebocr_globals.h"
 #include "ho_bitmap.h"
 #include "ho_objmap.h"
 #include "ho_dimentions.h"
-#include "ho_segment.h"
 
 int
 ho_dimentions_font_width_height_nikud (ho_bitmap * m,
@@ -45,7 +48,7 @@ ho_dimentions_font_width_height_nikud (ho_bitmap * m,
   unsigned char nikud;
 
   /* create an object map from b/w image */
-  m_obj = ho_objmap_new_from_bitmap (m);
+  m_obj = ho_objmap_new_from_bitmap_runs (m);
   if (!m_obj)
     return TRUE;
 
@@ -109,7 +112,7 @@ ho_dimentions_line_spacing (ho_bitmap * m)
       ho_bitmap_unset (m_temp2, x, y);
 
   /* create an object map from b/w image */
-  m_obj = ho_objmap_new_from_bitmap (m_temp2);
+  m_obj = ho_objmap_new_from_bitmap_runs (m_temp2);
   ho_bitmap_free (m_temp2);
 
   /* get interline size */
@@ -163,12 +166,7 @@ ho_dimentions_font_spacing (ho_bitmap * m, const ho_bitmap * m_line_map)
     return TRUE;
   m_out = m_temp;
 
-  m_temp = ho_bitmap_clone (m_line_map);
-  if (!m_temp)
-    return TRUE;
-  ho_bitmap_and (m_temp, m_out);
-  ho_bitmap_free (m_out);
-  m_out = m_temp;
+  ho_bitmap_and (m_out, m_line_map);
 
   m_temp = ho_bitmap_hlink (m_out, m->font_width / 4);
   if (!m_temp)
@@ -186,12 +184,7 @@ ho_dimentions_font_spacing (ho_bitmap * m, const ho_bitmap * m_line_map)
     return FALSE;
   }
 
-  m_temp = ho_bitmap_clone (m_line_map);
-  ho_bitmap_andnot (m_temp, m_out);
-  ho_bitmap_free (m_out);
-  if (!m_temp)
-    return TRUE;
-  m_out = m_temp;
+  ho_bitmap_andnot_to (m_out, m_line_map, m_out);
 
   m_temp = ho_bitmap_filter_by_size (m_out, 5, m->height, 1, m->font_width / 2);
   ho_bitmap_free (m_out);
@@ -205,7 +198,7 @@ ho_dimentions_font_spacing (ho_bitmap * m, const ho_bitmap * m_line_map)
       ho_bitmap_unset (m_out, x, y);
 
   /* create an object map from b/w image */
-  o_obj = ho_objmap_new_from_bitmap (m_out);
+  o_obj = ho_objmap_new_from_bitmap_runs (m_out);
   ho_bitmap_free (m_out);
   if (!o_obj)
     return TRUE;
@@ -374,7 +367,7 @@ ho_dimentions_get_columns (const ho_bitmap * m)
     return 1;
 
   /* create an object map from b/w image */
-  m_obj = ho_objmap_new_from_bitmap (m_cols);
+  m_obj = ho_objmap_new_from_bitmap_runs (m_cols);
   ho_bitmap_free (m_cols);
   if (!m_obj)
     return 1;
@@ -435,7 +428,7 @@ ho_dimentions_get_columns_with_x_start (const ho_bitmap * m,
   m_cols = m_temp;
 
   /* create an object map from b/w image */
-  m_obj = ho_objmap_new_from_bitmap (m_cols);
+  m_obj = ho_objmap_new_from_bitmap_runs (m_cols);
   ho_bitmap_free (m_cols);
   if (!m_obj)
     return 1;
@@ -476,79 +469,649 @@ ho_dimentions_get_columns_with_x_start (const ho_bitmap * m,
   return return_val;
 }
 
-double
-ho_dimentions_get_lines_angle (const ho_bitmap * m)
+/* compare two objects by their top row */
+static int
+ho_dimentions_objects_compare_y (const void *a, const void *b)
 {
-  int i, number_of_lines;
-  int y_left, y_right;
-  int width;
-  double angle;
-  ho_bitmap *m_lines = NULL;
-  ho_bitmap *m_temp = NULL;
-  ho_objmap *m_obj = NULL;
+  const ho_obj *object_a = *(const ho_obj * const *) a;
+  const ho_obj *object_b = *(const ho_obj * const *) b;
 
-  /* link lines */
-  m_lines = ho_segment_lines (m);
-  if (!m_lines)
-    return 0;
+  return (object_a->y > object_b->y) - (object_a->y < object_b->y);
+}
 
-  /* remove short lines */
-  m_temp = ho_bitmap_filter_by_size (m_lines,
-    10, m_lines->height / 2, 2 * m_lines->width / 3, m_lines->width);
-  ho_bitmap_free (m_lines);
-  if (!m_temp)
-    return 0;
-  m_lines = m_temp;
+/* compare two objects by their left column */
+static int
+ho_dimentions_objects_compare_x (const void *a, const void *b)
+{
+  const ho_obj *object_a = *(const ho_obj * const *) a;
+  const ho_obj *object_b = *(const ho_obj * const *) b;
 
-  /* create an object map from b/w image */
-  m_obj = ho_objmap_new_from_bitmap (m_lines);
-  ho_bitmap_free (m_lines);
-  if (!m_obj)
-    return 0;
+  return (object_a->x > object_b->x) - (object_a->x < object_b->x);
+}
 
-  /* get number ot lines */
-  number_of_lines = ho_objmap_get_size (m_obj);
+/* 
+ * the most common white gap between a font and the next font below it,
+ * like ho_dimentions_line_spacing but measured on the objects boxes 
+ */
+static int
+ho_dimentions_objects_line_spacing (const ho_objlist * object_list,
+  const int font_height, const int font_width, const unsigned char nikud)
+{
+  ho_obj **fonts = NULL;
+  ho_obj *font;
+  int *gaps = NULL;
+  int n_fonts, min_height, min_width;
+  int i, j, first, last, bottom, gap;
+  int height = 0;
 
-  /* if no long lines angle is 0 */
-  if (number_of_lines < 1)
-    return 0;
+  /* if nikud we need to be more careful */
+  min_height = (nikud) ? font_height / 2 : font_height / 4;
+  min_width = (nikud) ? font_width / 3 : font_width / 4;
 
-  /* get the first line */
-  m_temp = ho_objmap_to_bitmap_by_index_window (m_obj, 0, number_of_lines / 2);
-  ho_objmap_free (m_obj);
-  if (!m_temp)
-    return 0;
+  fonts = (ho_obj **) malloc ((object_list->size + 1) * sizeof (ho_obj *));
+  gaps = (int *) calloc (4 * font_height + 1, sizeof (int));
+  if (!fonts || !gaps)
+  {
+    free (fonts);
+    free (gaps);
+    return font_height * 1.5;
+  }
+
+  n_fonts = 0;
+  for (i = 0; i < object_list->size; i++)
+  {
+    font = &(object_list->objects[i]);
+    if (font->height >= min_height && font->height <= font_height * 4 &&
+      font->width >= min_width && font->width <= font_width * 5)
+      fonts[n_fonts++] = font;
+  }
+  qsort (fonts, n_fonts, sizeof (ho_obj *), ho_dimentions_objects_compare_y);
 
-  /* get angle */
-  y_left = 0;
-  for (i = 0; i < m_temp->height; i++)
+  for (i = 0; i < n_fonts; i++)
   {
-    if (ho_bitmap_get (m_temp, 1 * m_temp->width / 4, i))
+    bottom = fonts[i]->y + fonts[i]->height;
+
+    /* first font starting below this one */
+    first = i;
+    last = n_fonts;
+    while (first < last)
     {
-      y_left = i;
-      i = m_temp->height;
+      j = (first + last) / 2;
+      if (fonts[j]->y < bottom)
+        first = j + 1;
+      else
+        last = j;
     }
+
+    /* the nearest font below, fonts of one line are linked by font width */
+    for (j = first; j < n_fonts && fonts[j]->y - bottom <= 4 * font_height;
+      j++)
+    {
+      if (fonts[j]->x > fonts[i]->x + fonts[i]->width + font_width ||
+        fonts[j]->x + fonts[j]->width < fonts[i]->x - font_width)
+        continue;
+
+      gap = fonts[j]->y - bottom;
+      if (gap >= font_height / 2)
+        gaps[gap]++;
+      break;
+    }
+  }
+
+  for (gap = font_height / 2; gap <= 4 * font_height; gap++)
+    if (gaps[gap] > gaps[height])
+      height = gap;
+
+  free (fonts);
+  free (gaps);
+
+  /* sanity chack */
+  if (height < font_height || height > font_height * 4)
+    height = font_height * 1.5;
+
+  return height;
+}
+
+/* find the root of a group of linked objects */
+static int
+ho_dimentions_objects_root (int *parents, int i)
+{
+  while (parents[i] != i)
+  {
+    parents[i] = parents[parents[i]];
+    i = parents[i];
+  }
+
+  return i;
+}
+
+/* 
+ * count columns of a width x height page, like ho_dimentions_get_columns
+ * but objects are linked by their boxes 
+ */
+static int
+ho_dimentions_objects_columns (const ho_objlist * object_list,
+  const int width, const int height)
+{
+  ho_obj **objects = NULL;
+  int *parents = NULL;
+  int *x_start = NULL;
+  int *x_end = NULL;
+  int n_objects, hlink_value, vlink_value;
+  int i, j, root;
+  int return_val = 0;
+
+  /* samll image, must be one col */
+  if (width <= 120 || height <= 120)
+    return 1;
+
+  /* tresholding artefacts on the page edges are not used */
+  objects = (ho_obj **) malloc ((object_list->size + 1) * sizeof (ho_obj *));
+  parents = (int *) malloc ((object_list->size + 1) * sizeof (int));
+  x_start = (int *) malloc ((object_list->size + 1) * sizeof (int));
+  x_end = (int *) malloc ((object_list->size + 1) * sizeof (int));
+  if (!objects || !parents || !x_start || !x_end)
+  {
+    free (objects);
+    free (parents);
+    free (x_start);
+    free (x_end);
+    return 1;
+  }
+
+  n_objects = 0;
+  for (i = 0; i < object_list->size; i++)
+    if (object_list->objects[i].x + object_list->objects[i].width > 30 &&
+      object_list->objects[i].x < width - 30 &&
+      object_list->objects[i].y + object_list->objects[i].height > 30 &&
+      object_list->objects[i].y < height - 30)
+      objects[n_objects++] = &(object_list->objects[i]);
+  qsort (objects, n_objects, sizeof (ho_obj *),
+    ho_dimentions_objects_compare_x);
+
+  /* link objects as the column linking of ho_dimentions_get_columns */
+  hlink_value = ((width / 100) < 30) ? 30 : width / 100;
+  vlink_value = height / 3;
+
+  for (i = 0; i < n_objects; i++)
+    parents[i] = i;
+
+  for (i = 0; i < n_objects; i++)
+    for (j = i + 1; j < n_objects &&
+      objects[j]->x <= objects[i]->x + objects[i]->width + hlink_value; j++)
+      if (objects[j]->y <= objects[i]->y + objects[i]->height + vlink_value &&
+        objects[i]->y <= objects[j]->y + objects[j]->height + vlink_value)
+        parents[ho_dimentions_objects_root (parents, j)] =
+          ho_dimentions_objects_root (parents, i);
+
+  /* get the width of each group, clipped to the page edges */
+  for (i = 0; i < n_objects; i++)
+  {
+    x_start[i] = width;
+    x_end[i] = 0;
+  }
+
+  for (i = 0; i < n_objects; i++)
+  {
+    root = ho_dimentions_objects_root (parents, i);
+    if (x_start[root] > objects[i]->x)
+      x_start[root] = objects[i]->x;
+    if (x_end[root] < objects[i]->x + objects[i]->width)
+      x_end[root] = objects[i]->x + objects[i]->width;
+  }
+
+  /* get number ot columns */
+  for (i = 0; i < n_objects; i++)
+  {
+    if (parents[i] != i)
+      continue;
+
+    if (x_start[i] < 30)
+      x_start[i] = 30;
+    if (x_end[i] > width - 30)
+      x_end[i] = width - 30;
+    if (x_end[i] - x_start[i] > width / 8)
+      return_val++;
   }
 
-  y_right = 0;
-  for (i = 0; i < m_temp->height; i++)
+  free (objects);
+  free (parents);
+  free (x_start);
+  free (x_end);
+
+  return return_val;
+}
+
+ho_page_analysis *
+ho_dimentions_page_analysis_new (const ho_bitmap * m)
+{
+  ho_page_analysis *page = NULL;
+
+  page = (ho_page_analysis *) malloc (sizeof (ho_page_analysis));
+  if (!page)
+    return NULL;
+
+  page->x = m->x;
+  page->y = m->y;
+  page->width = m->width;
+  page->height = m->height;
+
+  /* label the page once, the first pixel of each object is kept to tell
+   * what block it is in */
+  page->m_obj = ho_objmap_new_from_bitmap_shapes (m);
+  if (!page->m_obj)
   {
-    if (ho_bitmap_get (m_temp, 3 * m_temp->width / 4, i))
+    free (page);
+    return NULL;
+  }
+
+  ho_objlist_font_metrix (page->m_obj->obj_list, 12, 350, 12, 350,
+    &(page->font_height), &(page->font_width), &(page->nikud));
+  page->line_spacing = ho_dimentions_objects_line_spacing (page->m_obj->
+    obj_list, page->font_height, page->font_width, page->nikud);
+  page->n_columns = ho_dimentions_objects_columns (page->m_obj->obj_list,
+    page->width, page->height);
+
+  return page;
+}
+
+int
+ho_dimentions_page_analysis_free (ho_page_analysis * page)
+{
+  if (!page)
+    return TRUE;
+
+  ho_objmap_free (page->m_obj);
+  free (page);
+
+  return FALSE;
+}
+
+int
+ho_dimentions_from_page_analysis (const ho_page_analysis * page,
+  ho_bitmap * m)
+{
+  ho_objlist *object_list = NULL;
+  ho_obj *object;
+  int i, x, y;
+
+  x = m->x - page->x;
+  y = m->y - page->y;
+
+  /* the whole page was measured already */
+  if (x == 0 && y == 0 && m->width == page->width &&
+    m->height == page->height)
+  {
+    m->font_height = page->font_height;
+    m->font_width = page->font_width;
+    m->nikud = page->nikud;
+    m->line_spacing = page->line_spacing;
+
+    return FALSE;
+  }
+
+  /* page objects inside m, that are not masked out of it */
+  object_list = ho_objlist_new ();
+  if (!object_list)
+    return TRUE;
+
+  for (i = 0; i < ho_objmap_get_size (page->m_obj); i++)
+  {
+    object = &(ho_objmap_get_object (page->m_obj, i));
+
+    if (object->x < x || object->x + object->width > x + m->width ||
+      object->y < y || object->y + object->height > y + m->height ||
+      !ho_bitmap_get (m, object->shape.top_x - x, object->y - y))
+      continue;
+
+    if (ho_objlist_add (object_list, object->weight, object->x, object->y,
+        object->width, object->height))
     {
-      y_right = i;
-      i = m_temp->height;
+      ho_objlist_free (object_list);
+      return TRUE;
     }
   }
 
-  width = 2 * m_temp->width / 4;
-  ho_bitmap_free (m_temp);
+  ho_objlist_font_metrix (object_list, 12, 350, 12, 350,
+    &(m->font_height), &(m->font_width), &(m->nikud));
+  m->line_spacing = ho_dimentions_objects_line_spacing (object_list,
+    m->font_height, m->font_width, m->nikud);
+
+  ho_objlist_free (object_list);
+
+  return FALSE;
+}
+
+int
+ho_dimentions_page_metrics (ho_bitmap * m, const int factor,
+  const int n_threads, ho_page_metrics * metrics)
+{
+  int min_size;
+
+  metrics->font_height = 0;
+  metrics->font_width = 0;
+  metrics->nikud = FALSE;
+  metrics->angle = 0.0;
+  metrics->angle_confidence = 0.0;
+
+  /* fonts are looked for in the same page sizes whatever the factor */
+  min_size = 6 / factor;
+  if (min_size < 3)
+    min_size = 3;
+
+  if (ho_dimentions_font_width_height_nikud (m, min_size, 200 / factor,
+      min_size, 200 / factor))
+    return TRUE;
+
+  /* a decimated font also covers the pixels its edges were blurred into */
+  metrics->font_height = (m->font_height - 1) * factor + 1;
+  metrics->font_width = (m->font_width - 1) * factor + 1;
+  metrics->nikud = m->nikud;
 
-  /* sanity check */
-  if ((y_left - y_right) == 0 || width < 10)
-    return 0;
+  /* fonts are picked using the font dimentions just set in m */
+  metrics->angle = ho_dimentions_get_skew_angle (m, n_threads,
+    &(metrics->angle_confidence));
+
+  return FALSE;
+}
+
+/* skew is looked for between -max and max degrees */
+#define HO_DIMENTIONS_SKEW_MAX_ANGLE 15.0
+
+/* first pass step in degrees, each next pass is ten times finer */
+#define HO_DIMENTIONS_SKEW_COARSE_STEP 1.0
+
+/* finest step in degrees, whatever the page width */
+#define HO_DIMENTIONS_SKEW_FINE_STEP 0.01
+
+/* most candidate angles in one pass */
+#define HO_DIMENTIONS_SKEW_MAX_ANGLES 64
+
+/* too few fonts to find lines in */
+#define HO_DIMENTIONS_SKEW_MIN_POINTS 20
+
+/* smallest number of font centroids times angles worth a thread */
+#define HO_DIMENTIONS_SKEW_MIN_JOB 65536
+
+/** @struct ho_dimentions_skew_job
+  @brief candidate angles scored by one thread
+*/
+typedef struct
+{
+  const double *x;
+  const double *y;
+  int n_points;
+  double offset;
+  double bin_size;
+  int n_bins;
+  double *bins;
+  const double *angles;
+  double *scores;
+  int n_angles;
+} ho_dimentions_skew_job;
+
+/* 
+ * score each angle by the sum of squares of the projection profile of the
+ * points along it, lines of text make a spiky profile when leveled 
+ */
+static void *
+ho_dimentions_skew_score (void *data)
+{
+  ho_dimentions_skew_job *job = (ho_dimentions_skew_job *) data;
+  int i, j, bin;
+  double slope, position, part, score;
 
-  /* get degree */
-  angle = 180.0 * atan2 ((double) (y_left - y_right), (double) width) / M_PI;
+  for (i = 0; i < job->n_angles; i++)
+  {
+    memset (job->bins, 0, job->n_bins * sizeof (double));
+
+    /* a line rising to the right is leveled at a positive angle */
+    slope = tan (M_PI * job->angles[i] / 180.0);
+
+    /* each point is split between its two nearest bins */
+    for (j = 0; j < job->n_points; j++)
+    {
+      position = (job->y[j] + job->x[j] * slope + job->offset) /
+        job->bin_size;
+      bin = (int) position;
+      part = position - bin;
+      job->bins[bin] += 1.0 - part;
+      job->bins[bin + 1] += part;
+    }
+
+    score = 0.0;
+    for (bin = 0; bin < job->n_bins; bin++)
+      score += job->bins[bin] * job->bins[bin];
+
+    job->scores[i] = score;
+  }
+
+  return NULL;
+}
+
+/* score all jobs, the first one on this thread, jobs whose thread can not
+ * be created also run here */
+static void
+ho_dimentions_skew_jobs_run (ho_dimentions_skew_job * jobs, const int n_jobs)
+{
+#ifdef USE_PTHREADS
+  pthread_t threads[HO_DIMENTIONS_SKEW_MAX_ANGLES];
+  int started[HO_DIMENTIONS_SKEW_MAX_ANGLES];
+  int i;
+
+  for (i = 1; i < n_jobs; i++)
+    started[i] = !pthread_create (&threads[i], NULL,
+      ho_dimentions_skew_score, jobs + i);
+
+  ho_dimentions_skew_score (jobs);
+
+  for (i = 1; i < n_jobs; i++)
+  {
+    if (started[i])
+      pthread_join (threads[i], NULL);
+    else
+      ho_dimentions_skew_score (jobs + i);
+  }
+#else
+  int i;
+
+  for (i = 0; i < n_jobs; i++)
+    ho_dimentions_skew_score (jobs + i);
+#endif /* USE_PTHREADS */
+}
+
+/* 
+ * collect the centroids of font sized objects of m, returns the number of
+ * points or -1 on error 
+ */
+static int
+ho_dimentions_skew_points (const ho_bitmap * m, double **x, double **y)
+{
+  int i, n_points;
+  int min_height, max_height, max_width;
+  ho_objmap *m_obj = NULL;
+  ho_obj *object;
+
+  m_obj = ho_objmap_new_from_bitmap_shapes (m);
+  if (!m_obj)
+    return -1;
 
-  return angle;
+  /* without font dimentions take anything that may be a font */
+  if (m->font_height > 0)
+  {
+    min_height = m->font_height / 2;
+    max_height = 2 * m->font_height;
+  }
+  else
+  {
+    min_height = 3;
+    max_height = 200;
+  }
+  max_width = (m->font_width > 0) ? 4 * m->font_width : 200;
+
+  *x = malloc ((ho_objmap_get_size (m_obj) + 1) * sizeof (double));
+  *y = malloc ((ho_objmap_get_size (m_obj) + 1) * sizeof (double));
+  if (!*x || !*y)
+  {
+    free (*x);
+    free (*y);
+    ho_objmap_free (m_obj);
+    return -1;
+  }
+
+  n_points = 0;
+  for (i = 0; i < ho_objmap_get_size (m_obj); i++)
+  {
+    object = &(ho_objmap_get_object (m_obj, i));
+
+    if (object->height < min_height || object->height > max_height ||
+      object->width > max_width)
+      continue;
+
+    (*x)[n_points] = ho_obj_get_centroid_x (object);
+    (*y)[n_points] = ho_obj_get_centroid_y (object);
+    n_points++;
+  }
+
+  ho_objmap_free (m_obj);
+
+  return n_points;
+}
+
+double
+ho_dimentions_get_skew_angle (const ho_bitmap * m, const int n_threads,
+  double *confidence)
+{
+  ho_dimentions_skew_job jobs[HO_DIMENTIONS_SKEW_MAX_ANGLES];
+  double angles[HO_DIMENTIONS_SKEW_MAX_ANGLES];
+  double scores[HO_DIMENTIONS_SKEW_MAX_ANGLES];
+  double *x = NULL;
+  double *y = NULL;
+  double *bins = NULL;
+  double base_bin, bin_size, max_offset;
+  double center, span, step, fine_step, sum;
+  int i, n_points, n_angles, n_jobs, n_bins, best;
+  int first_pass;
+
+  if (confidence)
+    *confidence = 0.0;
+
+  n_points = ho_dimentions_skew_points (m, &x, &y);
+  if (n_points < HO_DIMENTIONS_SKEW_MIN_POINTS)
+  {
+    free (x);
+    free (y);
+    return 0.0;
+  }
+
+  /* fine passes use one pixel bins, wider bins score a line by where it
+   * falls inside its bin, and pull the angle to put lines mid bin */
+  base_bin = 1.0;
+
+  /* no finer than one pixel across the page */
+  fine_step = 180.0 * atan (1.0 / m->width) / M_PI;
+  if (fine_step < HO_DIMENTIONS_SKEW_FINE_STEP)
+    fine_step = HO_DIMENTIONS_SKEW_FINE_STEP;
+
+  /* projections of the page at any candidate angle fit in the bins, finer
+   * passes may look one coarse step past the max angle */
+  max_offset = m->width * tan (M_PI * (HO_DIMENTIONS_SKEW_MAX_ANGLE +
+      HO_DIMENTIONS_SKEW_COARSE_STEP) / 180.0) + 1.0;
+
+  center = 0.0;
+  span = HO_DIMENTIONS_SKEW_MAX_ANGLE;
+  step = HO_DIMENTIONS_SKEW_COARSE_STEP;
+  first_pass = TRUE;
+
+  while (TRUE)
+  {
+    n_angles = 2 * (int) (span / step + 0.5) + 1;
+    if (n_angles > HO_DIMENTIONS_SKEW_MAX_ANGLES - 1)
+      n_angles = HO_DIMENTIONS_SKEW_MAX_ANGLES - 1;
+    for (i = 0; i < n_angles; i++)
+      angles[i] = center + (i - n_angles / 2) * step;
+
+    /* a coarse pass uses bins as wide as a step drifts across half the
+     * page, so it does not fall between the peaks */
+    bin_size = m->width * tan (M_PI * step / 180.0) / 2.0;
+    if (bin_size < base_bin)
+      bin_size = base_bin;
+    n_bins = (int) ((m->height + 2.0 * max_offset) / bin_size) + 2;
+
+    /* split the candidate angles between threads */
+    n_jobs = (n_threads > 1) ? n_threads : 1;
+    if (n_jobs > n_points * n_angles / HO_DIMENTIONS_SKEW_MIN_JOB)
+      n_jobs = n_points * n_angles / HO_DIMENTIONS_SKEW_MIN_JOB;
+    if (n_jobs > n_angles)
+      n_jobs = n_angles;
+    if (n_jobs < 1)
+      n_jobs = 1;
+
+    bins = malloc (n_jobs * n_bins * sizeof (double));
+    if (!bins)
+    {
+      free (x);
+      free (y);
+      return 0.0;
+    }
+
+    for (i = 0; i < n_jobs; i++)
+    {
+      jobs[i].x = x;
+      jobs[i].y = y;
+      jobs[i].n_points = n_points;
+      jobs[i].offset = max_offset;
+      jobs[i].bin_size = bin_size;
+      jobs[i].n_bins = n_bins;
+      jobs[i].bins = bins + i * n_bins;
+      jobs[i].angles = angles + n_angles * i / n_jobs;
+      jobs[i].scores = scores + n_angles * i / n_jobs;
+      jobs[i].n_angles = n_angles * (i + 1) / n_jobs - n_angles * i / n_jobs;
+    }
+
+    ho_dimentions_skew_jobs_run (jobs, n_jobs);
+    free (bins);
+
+    /* on a tie keep the angle nearest to the center */
+    best = n_angles / 2;
+    for (i = 0; i < n_angles; i++)
+      if (scores[i] > scores[best] ||
+        (scores[i] == scores[best] && abs (i - n_angles / 2) <
+          abs (best - n_angles / 2)))
+        best = i;
+
+    /* how much the best angle stands out of all the page angles */
+    if (first_pass && confidence && scores[best] > 0.0)
+    {
+      sum = 0.0;
+      for (i = 0; i < n_angles; i++)
+        sum += scores[i];
+      *confidence = 1.0 - sum / n_angles / scores[best];
+    }
+    first_pass = FALSE;
+
+    center = angles[best];
+    if (step <= fine_step)
+      break;
+
+    span = step;
+    step /= 10.0;
+    if (step < fine_step)
+      step = fine_step;
+  }
+
+  free (x);
+  free (y);
+
+  /* a peak no more than the finest step from zero is no skew */
+  if (fabs (center) <= fine_step)
+    return 0.0;
+
+  return center;
+}
+
+double
+ho_dimentions_get_lines_angle (const ho_bitmap * m)
+{
+  return ho_dimentions_get_skew_angle (m, 1, NULL);
 }
@@ -34,6 +34,36 @@
 #include <ho_bitmap.h>
 #include <ho_objmap.h>
 
+/** @struct ho_page_metrics
+  @brief page measures found once and shared by image processing steps
+*/
+typedef struct
+{
+  int font_height;
+  int font_width;
+  unsigned char nikud;
+  double angle;
+  double angle_confidence;
+} ho_page_metrics;
+
+/** @struct ho_page_analysis
+  @brief objects of a page labeled once, and the page dimentions found from
+  them, blocks of the page reuse the objects inside them
+*/
+typedef struct
+{
+  int x;
+  int y;
+  int width;
+  int height;
+  ho_objmap *m_obj;
+  int font_height;
+  int font_width;
+  unsigned char nikud;
+  int line_spacing;
+  int n_columns;
+} ho_page_analysis;
+
 /**
  guess font dimentions, sets: font_height, font_width and nikud  [for a page or block]
  @param m pointer to an ho_bitmap
@@ -87,6 +117,59 @@ int
 ho_dimentions_get_columns_with_x_start (const ho_bitmap * m,
   int **column_start_list);
 
+/**
+ label a page once and guess its font dimentions, line spacing and number
+ of columns [for a page]
+ @param m pointer to an ho_bitmap
+ @return a newly allocated ho_page_analysis
+ */
+ho_page_analysis *ho_dimentions_page_analysis_new (const ho_bitmap * m);
+
+/**
+ free a ho_page_analysis
+ @param page pointer to an ho_page_analysis
+ @return FALSE
+ */
+int ho_dimentions_page_analysis_free (ho_page_analysis * page);
+
+/**
+ guess font dimentions and line spacing from the page objects inside m, sets
+ font_height, font_width, nikud and line_spacing [for a page or block]
+ @param page pointer to the ho_page_analysis of the page m was cut from
+ @param m pointer to an ho_bitmap, a window of the page, may be masked
+ @return FALSE
+ */
+int
+ho_dimentions_from_page_analysis (const ho_page_analysis * page,
+  ho_bitmap * m);
+
+/**
+ guess font dimentions and angle of page lines, sets font_height, 
+ font_width and nikud of m [for a page]
+ @param m pointer to an ho_bitmap, may be a decimated copy of the page
+ @param factor the page was decimated by this factor, font dimentions are
+  returned in page pixels
+ @param n_threads number of threads to guess the angle with
+ @param metrics pointer to the ho_page_metrics to fill
+ @return FALSE, TRUE if the page objects could not be measured
+ */
+int
+ho_dimentions_page_metrics (ho_bitmap * m, const int factor,
+  const int n_threads, ho_page_metrics * metrics);
+
+/**
+ guess angle of page lines from the projection profile of font centroids,
+ candidate angles are scored coarse to fine [for a page]
+ @param m pointer to an ho_bitmap, font_height and font_width are used if set
+ @param n_threads number of threads to score candidate angles with
+ @param confidence pointer to return how much the angle stands out 0..1,
+  or NULL
+ @return guessed angle in degrees, positive if lines rise to the right
+ */
+double
+ho_dimentions_get_skew_angle (const ho_bitmap * m, const int n_threads,
+  double *confidence);
+
 /**
  guess angle of page lines
  @param m pointer to an ho_bitmap
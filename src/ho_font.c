@@ -35,8 +35,41 @@
 
 #include "ho_font.h"
 
+/* 
+ * a zeroed array of n heights, the edge scans read one height past both
+ * ends of it, and those read as zero 
+ */
+static int *
+ho_font_heights_new (const int n)
+{
+  int *a_height;
+
+  a_height = (int *) calloc (n + 2, sizeof (int));
+  if (!a_height)
+    return NULL;
+
+  return a_height + 1;
+}
+
+static void
+ho_font_heights_free (int *a_height)
+{
+  free (a_height - 1);
+}
+
 ho_bitmap *
 ho_font_main_sign (const ho_bitmap * m_text, const ho_bitmap * m_mask)
+{
+  ho_bitmap_view v_text;
+
+  ho_bitmap_view_init (&v_text, m_text, 0, 0, m_text->width, m_text->height);
+
+  return ho_font_main_sign_view (&v_text, m_mask);
+}
+
+ho_bitmap *
+ho_font_main_sign_view (const ho_bitmap_view * v_text,
+  const ho_bitmap * m_mask)
 {
   ho_objmap *o_obj = NULL;
   ho_bitmap *m_sign_mask = NULL;
@@ -57,7 +90,7 @@ ho_font_main_sign (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   line_height = line_end - line_start;
 
   /* get all the objects of the font */
-  o_obj = ho_objmap_new_from_bitmap (m_text);
+  o_obj = ho_objmap_new_from_bitmap_view (v_text);
   if (!o_obj)
     return NULL;
 
@@ -65,7 +98,9 @@ ho_font_main_sign (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   if (ho_objmap_get_size (o_obj) == 1)
   {
     ho_objmap_free (o_obj);
-    m_sign_mask = ho_bitmap_clone (m_text);
+    m_sign_mask = ho_bitmap_new_from_view (v_text);
+    if (!m_sign_mask)
+      return NULL;
 
     /* clean top and bottom lines, just in case */
     ho_bitmap_delete_hline (m_sign_mask, 0, 0, m_sign_mask->width);
@@ -76,7 +111,7 @@ ho_font_main_sign (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   }
 
   /* more than one object */
-  m_sign_mask = ho_bitmap_new (m_text->width, m_text->height);
+  m_sign_mask = ho_bitmap_new (v_text->width, v_text->height);
   if (!m_sign_mask)
     return NULL;
 
@@ -131,36 +166,22 @@ ho_font_main_sign (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   return m_sign_mask;
 }
 
-ho_bitmap *
-ho_font_second_object (const ho_bitmap * m_text, const ho_bitmap * m_mask)
+/* 
+ * copy the first object found from lower left of the font, o_obj holds the
+ * objects of m_text 
+ */
+static ho_bitmap *
+ho_font_second_object_from_objects (const ho_bitmap * m_text,
+  const ho_objmap * o_obj, const int line_end, const int line_height)
 {
-  ho_objmap *o_obj = NULL;
   ho_bitmap *m_sign_mask = NULL;
   ho_bitmap *m_current_object = NULL;
   int x, y;
   int i, dy;
-  int line_start, line_end, line_height;
-
-  /* get line_height */
-  x = m_mask->width / 2;
-  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
-  line_start = y - 1;
-  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
-  line_end = y;
-  line_height = line_end - line_start;
-
-  /* get all the objects of the font */
-  o_obj = ho_objmap_new_from_bitmap (m_text);
-  if (!o_obj)
-    return NULL;
 
   /* if not two objects, return NULL */
   if (ho_objmap_get_size (o_obj) < 2)
-  {
-    ho_objmap_free (o_obj);
-
     return NULL;
-  }
 
   /* more than one object */
   m_sign_mask = ho_bitmap_new (m_text->width, m_text->height);
@@ -190,11 +211,100 @@ ho_font_second_object (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     ho_bitmap_free (m_current_object);
   }
 
+  return m_sign_mask;
+}
+
+ho_bitmap *
+ho_font_second_object (const ho_bitmap * m_text, const ho_bitmap * m_mask)
+{
+  ho_objmap *o_obj = NULL;
+  ho_bitmap *m_sign_mask = NULL;
+  int x, y;
+  int line_start, line_end, line_height;
+
+  /* get line_height */
+  x = m_mask->width / 2;
+  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
+  line_start = y - 1;
+  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
+  line_end = y;
+  line_height = line_end - line_start;
+
+  /* get all the objects of the font */
+  o_obj = ho_objmap_new_from_bitmap (m_text);
+  if (!o_obj)
+    return NULL;
+
+  m_sign_mask =
+    ho_font_second_object_from_objects (m_text, o_obj, line_end,
+    line_height);
+
   ho_objmap_free (o_obj);
 
   return m_sign_mask;
 }
 
+/* 
+ * TRUE if an object of the font has a hole, the holes are counted by the
+ * euler numbers of the labelling pass so fonts with no holes are not inverted
+ */
+static int
+ho_font_has_holes (const ho_bitmap * m_text)
+{
+  ho_objmap *o_obj = NULL;
+  int i;
+  int has_holes = FALSE;
+
+  o_obj = ho_objmap_new_from_bitmap_shapes (m_text);
+  if (!o_obj)
+    return TRUE;
+
+  for (i = 0; i < ho_objmap_get_size (o_obj) && !has_holes; i++)
+    if (ho_obj_get_holes (&(ho_objmap_get_object (o_obj, i))) > 0)
+      has_holes = TRUE;
+
+  ho_objmap_free (o_obj);
+
+  return has_holes;
+}
+
+/* 
+ * an empty holes bitmap for a font with no holes
+ */
+static ho_bitmap *
+ho_font_holes_none (const ho_bitmap * m_text)
+{
+  ho_bitmap *m_out = NULL;
+
+  m_out = ho_bitmap_new (m_text->width, m_text->height);
+  if (!m_out)
+    return NULL;
+
+  m_out->x = m_text->x;
+  m_out->y = m_text->y;
+
+  return m_out;
+}
+
+/* 
+ * holes are the background objects not linked to the font edges, the
+ * negative is drawn on 
+ */
+static ho_bitmap *
+ho_font_holes_from_negative (ho_bitmap * m_negative, const int line_height)
+{
+  /* link all background elemnts */
+  ho_bitmap_draw_vline (m_negative, 1, 0, m_negative->height - 1);
+  ho_bitmap_draw_vline (m_negative, m_negative->width - 1, 0,
+    m_negative->height - 1);
+  ho_bitmap_draw_hline (m_negative, 0, 0, m_negative->width - 1);
+  ho_bitmap_draw_hline (m_negative, 0, m_negative->height - 2,
+    m_negative->width - 1);
+
+  return ho_bitmap_filter_by_size (m_negative, line_height / 5,
+    m_negative->height - 2, line_height / 10, m_negative->width - 2);
+}
+
 ho_bitmap *
 ho_font_holes (const ho_bitmap * m_text, const ho_bitmap * m_mask)
 {
@@ -209,21 +319,14 @@ ho_font_holes (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
   line_height = y - line_height;
 
+  if (!ho_font_has_holes (m_text))
+    return ho_font_holes_none (m_text);
+
   m_negative = ho_bitmap_not (m_text);
   if (!m_negative)
     return NULL;
 
-  /* link all background elemnts */
-  ho_bitmap_draw_vline (m_negative, 1, 0, m_negative->height - 1);
-  ho_bitmap_draw_vline (m_negative, m_negative->width - 1, 0,
-    m_negative->height - 1);
-  ho_bitmap_draw_hline (m_negative, 0, 0, m_negative->width - 1);
-  ho_bitmap_draw_hline (m_negative, 0, m_negative->height - 2,
-    m_negative->width - 1);
-
-  m_out =
-    ho_bitmap_filter_by_size (m_negative, line_height / 5,
-    m_negative->height - 2, line_height / 10, m_negative->width - 2);
+  m_out = ho_font_holes_from_negative (m_negative, line_height);
 
   ho_bitmap_free (m_negative);
 
@@ -245,13 +348,11 @@ ho_font_hbars (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   /* get font height */
   sum = 0;
   for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   y_start = y - 1;
   sum = 0;
   for (y = m_mask->height - 1; y > y_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   line_height = y - y_start + 1;
 
   if (!line_height)
@@ -342,13 +443,11 @@ ho_font_vbars (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   /* get font height */
   sum = 0;
   for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   y_start = y - 1;
   sum = 0;
   for (y = m_mask->height - 1; y > y_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   line_height = y - y_start + 1;
 
   if (!line_height)
@@ -429,7 +528,6 @@ ho_font_diagonal (const ho_bitmap * m_text, const ho_bitmap * m_mask)
 {
   ho_bitmap *m_diagonal_mask = NULL;
   ho_bitmap *m_main_font = NULL;
-  ho_bitmap *m_temp = NULL;
   ho_bitmap *m_bars = NULL;
   int sum, x, y, line_height, y_start;
   int threshold = 90;
@@ -437,31 +535,20 @@ ho_font_diagonal (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   /* get font height */
   sum = 0;
   for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   y_start = y - 1;
   sum = 0;
   for (y = m_mask->height - 1; y > y_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   line_height = y - y_start + 1;
 
   if (!line_height || !m_mask->width)
     return NULL;
 
-  /* maybe this font is realy broken, dialate twice */
-  m_temp = ho_bitmap_clone (m_text);
-  if (!m_temp)
-    return NULL;
-  m_main_font = m_temp;
-
   /* create diagonal mask */
   m_diagonal_mask = ho_bitmap_clone (m_mask);
   if (!m_diagonal_mask)
-  {
-    ho_bitmap_free (m_temp);
     return NULL;
-  }
   for (x = 0; x < m_mask->width; x++)
   {
     ho_bitmap_delete_vline (m_diagonal_mask, x, y_start,
@@ -470,8 +557,9 @@ ho_font_diagonal (const ho_bitmap * m_text, const ho_bitmap * m_mask)
       y_start + x * line_height / m_mask->width + line_height / 6, line_height);
   }
 
-  ho_bitmap_and (m_main_font, m_diagonal_mask);
-  ho_bitmap_free (m_diagonal_mask);
+  /* the main font is cut out of the diagonal mask, no copy of the font */
+  ho_bitmap_and (m_diagonal_mask, m_text);
+  m_main_font = m_diagonal_mask;
 
   /* look for high objects */
   m_bars =
@@ -496,7 +584,6 @@ ho_font_diagonal_left (const ho_bitmap * m_text, const ho_bitmap * m_mask)
 {
   ho_bitmap *m_diagonal_mask = NULL;
   ho_bitmap *m_main_font = NULL;
-  ho_bitmap *m_temp = NULL;
   ho_bitmap *m_bars = NULL;
   int sum, x, y, line_height, y_start;
   int threshold = 90;
@@ -504,31 +591,20 @@ ho_font_diagonal_left (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   /* get font height */
   sum = 0;
   for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   y_start = y - 1;
   sum = 0;
   for (y = m_mask->height - 1; y > y_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   line_height = y - y_start + 1;
 
   if (!line_height || !m_mask->width)
     return NULL;
 
-  /* maybe this font is realy broken, dialate twice */
-  m_temp = ho_bitmap_clone (m_text);
-  if (!m_temp)
-    return NULL;
-  m_main_font = m_temp;
-
   /* create diagonal mask */
   m_diagonal_mask = ho_bitmap_clone (m_mask);
   if (!m_diagonal_mask)
-  {
-    ho_bitmap_free (m_temp);
     return NULL;
-  }
   for (x = 0; x < m_mask->width; x++)
   {
     ho_bitmap_delete_vline (m_diagonal_mask, m_mask->width - x - 1, y_start,
@@ -537,8 +613,9 @@ ho_font_diagonal_left (const ho_bitmap * m_text, const ho_bitmap * m_mask)
       y_start + x * line_height / m_mask->width + line_height / 6, line_height);
   }
 
-  ho_bitmap_and (m_main_font, m_diagonal_mask);
-  ho_bitmap_free (m_diagonal_mask);
+  /* the main font is cut out of the diagonal mask, no copy of the font */
+  ho_bitmap_and (m_diagonal_mask, m_text);
+  m_main_font = m_diagonal_mask;
 
   /* look for high objects */
   m_bars =
@@ -580,13 +657,11 @@ ho_font_thin_naive (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   /* get font height */
   sum = 0;
   for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   y_start = y - 1;
   sum = 0;
   for (y = m_mask->height - 1; y > y_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   line_height = y - y_start + 1;
 
   if (!line_height || !m_mask->width)
@@ -723,47 +798,61 @@ ho_font_thin_naive (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   return m_out;
 }
 
-ho_bitmap *
-ho_font_ends (const ho_bitmap * m_text, const ho_bitmap * m_mask)
+/* 
+ * points of a skeleton with min_neighbors to max_neighbors set neighbors 
+ */
+static ho_bitmap *
+ho_font_thin_points (const ho_bitmap * m_thin, const int min_neighbors,
+  const int max_neighbors)
 {
   ho_bitmap *m_out = NULL;
-  ho_bitmap *m_temp = NULL;
 
   int x, y;
   unsigned char neighbors;
 
-  m_out = ho_bitmap_new (m_text->width, m_text->height);
+  m_out = ho_bitmap_new (m_thin->width, m_thin->height);
   if (!m_out)
     return NULL;
 
-  m_temp = ho_font_thin (m_text, m_mask);
-  if (!m_temp)
-    return NULL;
-
   /* look at evry pixel */
-  for (x = 1; x < m_text->width - 1; x++)
-    for (y = 1; y < m_text->height - 1; y++)
+  for (x = 1; x < m_thin->width - 1; x++)
+    for (y = 1; y < m_thin->height - 1; y++)
     {
       /* is this pixel on */
-      if (ho_bitmap_get (m_temp, x, y))
+      if (ho_bitmap_get (m_thin, x, y))
       {
         /* look at the border pixels */
-        neighbors = ho_bitmap_get (m_temp, x + 1, y + 1) +
-          ho_bitmap_get (m_temp, x + 1, y) +
-          ho_bitmap_get (m_temp, x + 1, y - 1) +
-          ho_bitmap_get (m_temp, x - 1, y + 1) +
-          ho_bitmap_get (m_temp, x - 1, y) +
-          ho_bitmap_get (m_temp, x - 1, y - 1) +
-          ho_bitmap_get (m_temp, x, y - 1) + ho_bitmap_get (m_temp, x, y + 1);
-
-        /* one neigbor it's an end */
-        if (neighbors < 2)
+        neighbors = ho_bitmap_get (m_thin, x + 1, y + 1) +
+          ho_bitmap_get (m_thin, x + 1, y) +
+          ho_bitmap_get (m_thin, x + 1, y - 1) +
+          ho_bitmap_get (m_thin, x - 1, y + 1) +
+          ho_bitmap_get (m_thin, x - 1, y) +
+          ho_bitmap_get (m_thin, x - 1, y - 1) +
+          ho_bitmap_get (m_thin, x, y - 1) + ho_bitmap_get (m_thin, x, y + 1);
+
+        if (neighbors >= min_neighbors && neighbors <= max_neighbors)
         {
           ho_bitmap_set (m_out, x, y);
         }
       }
     }
 
+  return m_out;
+}
+
+ho_bitmap *
+ho_font_ends (const ho_bitmap * m_text, const ho_bitmap * m_mask)
+{
+  ho_bitmap *m_out = NULL;
+  ho_bitmap *m_temp = NULL;
+
+  m_temp = ho_font_thin (m_text, m_mask);
+  if (!m_temp)
+    return NULL;
+
+  /* one neigbor it's an end */
+  m_out = ho_font_thin_points (m_temp, 0, 1);
+
   ho_bitmap_free (m_temp);
 
   return m_out;
@@ -775,40 +864,12 @@ ho_font_cross (const ho_bitmap * m_text, const ho_bitmap * m_mask)
   ho_bitmap *m_out = NULL;
   ho_bitmap *m_temp = NULL;
 
-  int x, y;
-  unsigned char neighbors;
-
-  m_out = ho_bitmap_new (m_text->width, m_text->height);
-  if (!m_out)
-    return NULL;
-
   m_temp = ho_font_thin (m_text, m_mask);
   if (!m_temp)
     return NULL;
 
-  /* look at evry pixel */
-  for (x = 1; x < m_text->width - 1; x++)
-    for (y = 1; y < m_text->height - 1; y++)
-    {
-      /* is this pixel on */
-      if (ho_bitmap_get (m_temp, x, y))
-      {
-        /* look at the border pixels */
-        neighbors = ho_bitmap_get (m_temp, x + 1, y + 1) +
-          ho_bitmap_get (m_temp, x + 1, y) +
-          ho_bitmap_get (m_temp, x + 1, y - 1) +
-          ho_bitmap_get (m_temp, x - 1, y + 1) +
-          ho_bitmap_get (m_temp, x - 1, y) +
-          ho_bitmap_get (m_temp, x - 1, y - 1) +
-          ho_bitmap_get (m_temp, x, y - 1) + ho_bitmap_get (m_temp, x, y + 1);
-
-        /* more then two neigbors it's a cross */
-        if (neighbors > 2)
-        {
-          ho_bitmap_set (m_out, x, y);
-        }
-      }
-    }
+  /* more then two neigbors it's a cross */
+  m_out = ho_font_thin_points (m_temp, 3, 8);
 
   ho_bitmap_free (m_temp);
 
@@ -820,18 +881,16 @@ ho_font_thin (const ho_bitmap * m_text, const ho_bitmap * m_mask)
 {
   ho_bitmap *m_out = NULL;
   ho_bitmap *m_temp = NULL;
-  int sum, x, y, line_height, y_start;
+  int sum, y, line_height, y_start;
 
   /* get font height */
   sum = 0;
   for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   y_start = y - 1;
   sum = 0;
   for (y = m_mask->height - 1; y > y_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
   line_height = y - y_start + 1;
 
   if (!line_height || !m_mask->width)
@@ -902,7 +961,7 @@ ho_font_edges_top (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     return NULL;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (m_text->width, sizeof (int));
+  a_height = ho_font_heights_new (m_text->width);
   if (!a_height)
     return NULL;
 
@@ -975,7 +1034,7 @@ ho_font_edges_top (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -1012,7 +1071,7 @@ ho_font_edges_top_big (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     return NULL;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (m_text->width, sizeof (int));
+  a_height = ho_font_heights_new (m_text->width);
   if (!a_height)
     return NULL;
 
@@ -1085,7 +1144,7 @@ ho_font_edges_top_big (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -1123,7 +1182,7 @@ ho_font_edges_bottom (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     return NULL;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (m_text->width, sizeof (int));
+  a_height = ho_font_heights_new (m_text->width);
   if (!a_height)
     return NULL;
 
@@ -1204,7 +1263,7 @@ ho_font_edges_bottom (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -1242,7 +1301,7 @@ ho_font_edges_bottom_big (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     return NULL;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (m_text->width, sizeof (int));
+  a_height = ho_font_heights_new (m_text->width);
   if (!a_height)
     return NULL;
 
@@ -1323,7 +1382,7 @@ ho_font_edges_bottom_big (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -1372,7 +1431,7 @@ ho_font_edges_left (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     y2 = m_text->height;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (line_height + 1, sizeof (int));
+  a_height = ho_font_heights_new (line_height + 1);
   if (!a_height)
     return NULL;
 
@@ -1438,7 +1497,7 @@ ho_font_edges_left (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -1487,7 +1546,7 @@ ho_font_edges_left_big (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     y2 = m_text->height;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (line_height + 1, sizeof (int));
+  a_height = ho_font_heights_new (line_height + 1);
   if (!a_height)
     return NULL;
 
@@ -1555,7 +1614,7 @@ ho_font_edges_left_big (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -1604,7 +1663,7 @@ ho_font_edges_right (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     y2 = m_text->height;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (line_height + 1, sizeof (int));
+  a_height = ho_font_heights_new (line_height + 1);
   if (!a_height)
     return NULL;
 
@@ -1671,7 +1730,7 @@ ho_font_edges_right (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -1720,7 +1779,7 @@ ho_font_edges_right_big (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     y2 = m_text->height;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (line_height + 1, sizeof (int));
+  a_height = ho_font_heights_new (line_height + 1);
   if (!a_height)
     return NULL;
 
@@ -1787,7 +1846,7 @@ ho_font_edges_right_big (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -1825,7 +1884,7 @@ ho_font_notch_top (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     return NULL;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (m_text->width, sizeof (int));
+  a_height = ho_font_heights_new (m_text->width);
   if (!a_height)
     return NULL;
 
@@ -1896,7 +1955,7 @@ ho_font_notch_top (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -1934,7 +1993,7 @@ ho_font_notch_bottom (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     return NULL;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (m_text->width, sizeof (int));
+  a_height = ho_font_heights_new (m_text->width);
   if (!a_height)
     return NULL;
 
@@ -2011,7 +2070,7 @@ ho_font_notch_bottom (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -2060,7 +2119,7 @@ ho_font_notch_left (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     y2 = m_text->height;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (line_height + 1, sizeof (int));
+  a_height = ho_font_heights_new (line_height + 1);
   if (!a_height)
     return NULL;
 
@@ -2125,7 +2184,7 @@ ho_font_notch_left (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -2174,7 +2233,7 @@ ho_font_notch_right (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     y2 = m_text->height;
 
   /* get the fill of the font */
-  a_height = (int *) calloc (line_height + 1, sizeof (int));
+  a_height = ho_font_heights_new (line_height + 1);
   if (!a_height)
     return NULL;
 
@@ -2238,7 +2297,7 @@ ho_font_notch_right (const ho_bitmap * m_text, const ho_bitmap * m_mask)
     }
   }
 
-  free (a_height);
+  ho_font_heights_free (a_height);
   ho_bitmap_free (m_temp);
 
   /* fix the x and y of the output bitmap */
@@ -2442,3 +2501,185 @@ ho_font_holes_filter (const ho_bitmap * m_text,
 
   return m_out;
 }
+
+ho_glyph_ctx *
+ho_glyph_ctx_new (const ho_bitmap * m_text, const ho_bitmap * m_mask)
+{
+  ho_glyph_ctx *glyph = NULL;
+  int sum, x, y;
+
+  glyph = (ho_glyph_ctx *) calloc (1, sizeof (ho_glyph_ctx));
+  if (!glyph)
+    return NULL;
+
+  glyph->m_text = m_text;
+  glyph->m_mask = m_mask;
+
+  /* get line start and end */
+  x = m_mask->width / 2;
+  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
+  glyph->line_start = y - 1;
+  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
+  glyph->line_end = y;
+  glyph->line_height = glyph->line_end - glyph->line_start;
+
+  /* get font start and end */
+  sum = 0;
+  for (y = 0; y < m_mask->height && sum == 0; y++)
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
+  glyph->font_start = y - 1;
+  sum = 0;
+  for (y = m_mask->height - 4; y > glyph->font_start && sum == 0; y--)
+    sum = ho_bitmap_count_row (m_text, 0, y, m_text->width);
+  glyph->font_end = y + 1;
+  glyph->font_height = glyph->font_end - glyph->font_start;
+
+  glyph->n_holes = -1;
+
+  return glyph;
+}
+
+int
+ho_glyph_ctx_free (ho_glyph_ctx * glyph)
+{
+  if (!glyph)
+    return TRUE;
+
+  if (glyph->m_negative)
+    ho_bitmap_free (glyph->m_negative);
+  if (glyph->m_holes)
+    ho_bitmap_free (glyph->m_holes);
+  if (glyph->m_thin)
+    ho_bitmap_free (glyph->m_thin);
+  if (glyph->o_obj)
+    ho_objmap_free (glyph->o_obj);
+
+  free (glyph);
+
+  return FALSE;
+}
+
+const ho_bitmap *
+ho_glyph_ctx_get_negative (ho_glyph_ctx * glyph)
+{
+  if (!glyph->has_negative)
+  {
+    glyph->has_negative = TRUE;
+    glyph->m_negative = ho_bitmap_not (glyph->m_text);
+  }
+
+  return glyph->m_negative;
+}
+
+const ho_bitmap *
+ho_glyph_ctx_get_holes (ho_glyph_ctx * glyph)
+{
+  ho_bitmap *m_temp = NULL;
+
+  if (!glyph->has_holes)
+  {
+    glyph->has_holes = TRUE;
+
+    if (!ho_font_has_holes (glyph->m_text))
+    {
+      glyph->m_holes = ho_font_holes_none (glyph->m_text);
+      if (glyph->m_holes)
+        glyph->n_holes = 0;
+
+      return glyph->m_holes;
+    }
+
+    /* the background links are drawn on the negative, a negative some
+     * recognizer already asked for is copied, else it is made here and
+     * not kept */
+    if (glyph->has_negative)
+    {
+      if (glyph->m_negative)
+        m_temp = ho_bitmap_clone (glyph->m_negative);
+    }
+    else
+      m_temp = ho_bitmap_not (glyph->m_text);
+    if (m_temp)
+    {
+      glyph->m_holes =
+        ho_font_holes_from_negative (m_temp, glyph->line_height);
+      ho_bitmap_free (m_temp);
+    }
+
+    if (glyph->m_holes)
+      glyph->n_holes = ho_bitmap_filter_count_objects (glyph->m_holes);
+  }
+
+  return glyph->m_holes;
+}
+
+int
+ho_glyph_ctx_get_n_holes (ho_glyph_ctx * glyph)
+{
+  ho_glyph_ctx_get_holes (glyph);
+
+  return glyph->n_holes;
+}
+
+const ho_bitmap *
+ho_glyph_ctx_get_thin (ho_glyph_ctx * glyph)
+{
+  if (!glyph->has_thin)
+  {
+    glyph->has_thin = TRUE;
+    glyph->m_thin = ho_font_thin (glyph->m_text, glyph->m_mask);
+  }
+
+  return glyph->m_thin;
+}
+
+const ho_objmap *
+ho_glyph_ctx_get_objects (ho_glyph_ctx * glyph)
+{
+  if (!glyph->has_objects)
+  {
+    glyph->has_objects = TRUE;
+    glyph->o_obj = ho_objmap_new_from_bitmap (glyph->m_text);
+  }
+
+  return glyph->o_obj;
+}
+
+ho_bitmap *
+ho_font_glyph_second_object (ho_glyph_ctx * glyph)
+{
+  const ho_objmap *o_obj = NULL;
+
+  o_obj = ho_glyph_ctx_get_objects (glyph);
+  if (!o_obj)
+    return NULL;
+
+  return ho_font_second_object_from_objects (glyph->m_text, o_obj,
+    glyph->line_end, glyph->line_height);
+}
+
+ho_bitmap *
+ho_font_glyph_cross (ho_glyph_ctx * glyph)
+{
+  const ho_bitmap *m_thin = NULL;
+
+  m_thin = ho_glyph_ctx_get_thin (glyph);
+  if (!m_thin)
+    return NULL;
+
+  /* more then two neigbors it's a cross */
+  return ho_font_thin_points (m_thin, 3, 8);
+}
+
+ho_bitmap *
+ho_font_glyph_ends (ho_glyph_ctx * glyph)
+{
+  const ho_bitmap *m_thin = NULL;
+
+  m_thin = ho_glyph_ctx_get_thin (glyph);
+  if (!m_thin)
+    return NULL;
+
+  /* one neigbor it's an end */
+  return ho_font_thin_points (m_thin, 0, 1);
+}
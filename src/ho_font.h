@@ -34,6 +34,111 @@
 #include <ho_bitmap.h>
 #include <ho_objmap.h>
 
+/** @struct ho_glyph_ctx
+  @brief a font and the measures and images the features are read from,
+  the line and font rows are measured when the ctx is made, and each image
+  is made the first time it is asked for and kept until the ctx is freed
+*/
+typedef struct
+{
+  const ho_bitmap *m_text;
+  const ho_bitmap *m_mask;
+
+  /* line rows, read from the middle column of m_mask */
+  int line_start;
+  int line_end;
+  int line_height;
+
+  /* first and last rows of m_text with black pixels */
+  int font_start;
+  int font_end;
+  int font_height;
+
+  /* images made on demand */
+  unsigned char has_negative;
+  unsigned char has_holes;
+  unsigned char has_thin;
+  unsigned char has_objects;
+  ho_bitmap *m_negative;
+  ho_bitmap *m_holes;
+  int n_holes;
+  ho_bitmap *m_thin;
+  ho_objmap *o_obj;
+} ho_glyph_ctx;
+
+/**
+ new ho_glyph_ctx of a font, measures the line and font rows
+ @param m_text pointer to the text bitmap, must outlive the ctx
+ @param m_mask pointer to the line map, must outlive the ctx
+ @return a newly allocated ho_glyph_ctx
+ */
+ho_glyph_ctx *ho_glyph_ctx_new (const ho_bitmap * m_text,
+  const ho_bitmap * m_mask);
+
+/**
+ free a ho_glyph_ctx and the images it made
+ @param glyph pointer to an ho_glyph_ctx
+ @return FALSE
+ */
+int ho_glyph_ctx_free (ho_glyph_ctx * glyph);
+
+/**
+ get the inverted font
+ @param glyph pointer to an ho_glyph_ctx
+ @return a bitmap owned by the ctx, or NULL
+ */
+const ho_bitmap *ho_glyph_ctx_get_negative (ho_glyph_ctx * glyph);
+
+/**
+ get the holes of the font, same as ho_font_holes
+ @param glyph pointer to an ho_glyph_ctx
+ @return a bitmap owned by the ctx, or NULL
+ */
+const ho_bitmap *ho_glyph_ctx_get_holes (ho_glyph_ctx * glyph);
+
+/**
+ get the number of holes in the font
+ @param glyph pointer to an ho_glyph_ctx
+ @return number of objects in the holes bitmap, -1 if it is missing
+ */
+int ho_glyph_ctx_get_n_holes (ho_glyph_ctx * glyph);
+
+/**
+ get the skeleton of the font, same as ho_font_thin
+ @param glyph pointer to an ho_glyph_ctx
+ @return a bitmap owned by the ctx, or NULL
+ */
+const ho_bitmap *ho_glyph_ctx_get_thin (ho_glyph_ctx * glyph);
+
+/**
+ get the connected objects of the font
+ @param glyph pointer to an ho_glyph_ctx
+ @return an objmap owned by the ctx, or NULL
+ */
+const ho_objmap *ho_glyph_ctx_get_objects (ho_glyph_ctx * glyph);
+
+/**
+ return a bitmap of the second object sign in the font, same as
+ ho_font_second_object
+ @param glyph pointer to an ho_glyph_ctx
+ @return a newly allocated bitmap
+ */
+ho_bitmap *ho_font_glyph_second_object (ho_glyph_ctx * glyph);
+
+/**
+ return a bitmap of cross points in the font skeleton, same as ho_font_cross
+ @param glyph pointer to an ho_glyph_ctx
+ @return a newly allocated bitmap
+ */
+ho_bitmap *ho_font_glyph_cross (ho_glyph_ctx * glyph);
+
+/**
+ return a bitmap of end points in the font skeleton, same as ho_font_ends
+ @param glyph pointer to an ho_glyph_ctx
+ @return a newly allocated bitmap
+ */
+ho_bitmap *ho_font_glyph_ends (ho_glyph_ctx * glyph);
+
 /**
  return a bitmap of the main signs in the font
  @param m_text pointer to the text bitmap
@@ -43,6 +148,15 @@
 ho_bitmap *ho_font_main_sign (const ho_bitmap * m_text,
   const ho_bitmap * m_mask);
 
+/**
+ return a bitmap of the main signs in the font, read from a view
+ @param v_text pointer to a view of the text
+ @param m_mask pointer to the line map
+ @return a newly allocated bitmap
+ */
+ho_bitmap *ho_font_main_sign_view (const ho_bitmap_view * v_text,
+  const ho_bitmap * m_mask);
+
 /**
  return a bitmap of the second object sign in the font
  @param m_text pointer to the text bitmap
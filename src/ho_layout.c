@@ -27,6 +27,10 @@
 #include <stdlib.h>
 #include <math.h>
 
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+
 #include "hebocr_globals.h"
 #include "ho_segment.h"
 #include "ho_dimentions.h"
@@ -53,6 +57,15 @@ ho_layout_new (const ho_bitmap * m_page_text, const char font_spacing_code,
     return NULL;
   }
 
+  /* label the page text once, blocks reuse its objects */
+  l_new->page_analysis = ho_dimentions_page_analysis_new (l_new->m_page_text);
+  if (!l_new->page_analysis)
+  {
+    ho_bitmap_free (l_new->m_page_text);
+    free (l_new);
+    return NULL;
+  }
+
   l_new->font_spacing_code = font_spacing_code;
   l_new->type = type;
   l_new->dir = dir;
@@ -76,6 +89,8 @@ ho_layout_new (const ho_bitmap * m_page_text, const char font_spacing_code,
   l_new->m_words_font_mask = NULL;
 
   l_new->n_fonts = NULL;
+  l_new->fonts_x_start = NULL;
+  l_new->fonts_x_end = NULL;
 
   l_new->number_of_fonts = 0;
   
@@ -108,6 +123,12 @@ ho_layout_free (ho_layout * l_page)
         if (l_page->m_words_font_mask[block_index][line_index][word_index])
           ho_bitmap_free (l_page->
             m_words_font_mask[block_index][line_index][word_index]);
+
+        /* free fonts columns */
+        if (l_page->fonts_x_start[block_index][line_index][word_index])
+          free (l_page->fonts_x_start[block_index][line_index][word_index]);
+        if (l_page->fonts_x_end[block_index][line_index][word_index])
+          free (l_page->fonts_x_end[block_index][line_index][word_index]);
       }
 
       /* free lines bitmaps */
@@ -129,6 +150,10 @@ ho_layout_free (ho_layout * l_page)
       /* free fonts arrays */
       if (l_page->n_fonts[block_index][line_index])
         free (l_page->n_fonts[block_index][line_index]);
+      if (l_page->fonts_x_start[block_index][line_index])
+        free (l_page->fonts_x_start[block_index][line_index]);
+      if (l_page->fonts_x_end[block_index][line_index])
+        free (l_page->fonts_x_end[block_index][line_index]);
     }
 
     /* free blocks bitmaps */
@@ -158,6 +183,10 @@ ho_layout_free (ho_layout * l_page)
     /* free fonts arrays */
     if (l_page->n_fonts[block_index])
       free (l_page->n_fonts[block_index]);
+    if (l_page->fonts_x_start[block_index])
+      free (l_page->fonts_x_start[block_index]);
+    if (l_page->fonts_x_end[block_index])
+      free (l_page->fonts_x_end[block_index]);
   }
 
   /* free page bitmaps */
@@ -165,6 +194,8 @@ ho_layout_free (ho_layout * l_page)
     ho_bitmap_free (l_page->m_page_text);
   if (l_page->m_page_blocks_mask)
     ho_bitmap_free (l_page->m_page_blocks_mask);
+  if (l_page->page_analysis)
+    ho_dimentions_page_analysis_free (l_page->page_analysis);
 
   /* free block arrays */
   if (l_page->m_blocks_text)
@@ -195,6 +226,10 @@ ho_layout_free (ho_layout * l_page)
   /* free fonts arrays */
   if (l_page->n_fonts)
     free (l_page->n_fonts);
+  if (l_page->fonts_x_start)
+    free (l_page->fonts_x_start);
+  if (l_page->fonts_x_end)
+    free (l_page->fonts_x_end);
 
   /* free this page */
   if (l_page)
@@ -209,16 +244,15 @@ ho_layout_create_block_mask (ho_layout * l_page)
   ho_objmap *o_map_blocks = NULL;
   int i;
 
-  /* set the font dimentions info in the main text matrix */
-  ho_dimentions_font_width_height_nikud (l_page->m_page_text, 12, 350, 12, 350);
-  /* set line_spacing in the main text matrix */
-  ho_dimentions_line_spacing (l_page->m_page_text);
+  /* set the font dimentions info and line_spacing in the main text matrix */
+  ho_dimentions_from_page_analysis (l_page->page_analysis,
+    l_page->m_page_text);
   /* create the blocks mask */
   l_page->m_page_blocks_mask =
     ho_segment_paragraphs (l_page->m_page_text, l_page->type);
 
   /* count blocks */
-  o_map_blocks = ho_objmap_new_from_bitmap (l_page->m_page_blocks_mask);
+  o_map_blocks = ho_objmap_new_from_bitmap_runs (l_page->m_page_blocks_mask);
 
   /* set number of blocks */
   l_page->n_blocks = ho_objmap_get_size (o_map_blocks);
@@ -273,6 +307,13 @@ ho_layout_create_block_mask (ho_layout * l_page)
   l_page->n_fonts = (int ***) malloc (l_page->n_blocks * sizeof (int **));
   if (!l_page->n_fonts)
     return TRUE;
+  l_page->fonts_x_start =
+    (int ****) malloc (l_page->n_blocks * sizeof (int ***));
+  if (!l_page->fonts_x_start)
+    return TRUE;
+  l_page->fonts_x_end = (int ****) malloc (l_page->n_blocks * sizeof (int ***));
+  if (!l_page->fonts_x_end)
+    return TRUE;
 
   /* link all free pointers to NULL */
   for (i = 0; i < l_page->n_blocks; i++)
@@ -291,6 +332,8 @@ ho_layout_create_block_mask (ho_layout * l_page)
     l_page->m_words_font_mask[i] = NULL;
 
     l_page->n_fonts[i] = NULL;
+    l_page->fonts_x_start[i] = NULL;
+    l_page->fonts_x_end[i] = NULL;
   }
 
   return FALSE;
@@ -307,10 +350,9 @@ ho_layout_create_line_mask (ho_layout * l_page, const int block_index)
 
   m_block_text = ho_layout_get_block_text (l_page, block_index);
 
-  /* set the font dimentions info in the main text block */
-  ho_dimentions_font_width_height_nikud (m_block_text, 12, 350, 12, 350);
-  /* set line_spacing in the main text block */
-  ho_dimentions_line_spacing (m_block_text);
+  /* set the font dimentions info and line_spacing in the main text block,
+   * from the page objects inside it */
+  ho_dimentions_from_page_analysis (l_page->page_analysis, m_block_text);
   /* create the lines mask */
   l_page->m_blocks_lines_mask[block_index] = ho_segment_lines (m_block_text);
 
@@ -318,7 +360,7 @@ ho_layout_create_line_mask (ho_layout * l_page, const int block_index)
 
   /* count lines */
   o_map_blocks =
-    ho_objmap_new_from_bitmap (l_page->m_blocks_lines_mask[block_index]);
+    ho_objmap_new_from_bitmap_runs (l_page->m_blocks_lines_mask[block_index]);
 
   /* set number of lines */
   l_page->n_lines[block_index] = ho_objmap_get_size (o_map_blocks);
@@ -365,6 +407,14 @@ ho_layout_create_line_mask (ho_layout * l_page, const int block_index)
     (int **) malloc (l_page->n_lines[block_index] * sizeof (int *));
   if (!l_page->n_fonts)
     return TRUE;
+  l_page->fonts_x_start[block_index] =
+    (int ***) malloc (l_page->n_lines[block_index] * sizeof (int **));
+  if (!l_page->fonts_x_start[block_index])
+    return TRUE;
+  l_page->fonts_x_end[block_index] =
+    (int ***) malloc (l_page->n_lines[block_index] * sizeof (int **));
+  if (!l_page->fonts_x_end[block_index])
+    return TRUE;
 
   /* link all free pointers to NULL */
   for (i = 0; i < l_page->n_lines[block_index]; i++)
@@ -379,6 +429,8 @@ ho_layout_create_line_mask (ho_layout * l_page, const int block_index)
     l_page->m_words_font_mask[block_index][i] = NULL;
 
     l_page->n_fonts[block_index][i] = NULL;
+    l_page->fonts_x_start[block_index][i] = NULL;
+    l_page->fonts_x_end[block_index][i] = NULL;
   }
 
   return FALSE;
@@ -419,7 +471,7 @@ ho_layout_create_word_mask (ho_layout * l_page, const int block_index,
 
   /* count words */
   o_map_blocks =
-    ho_objmap_new_from_bitmap (l_page->
+    ho_objmap_new_from_bitmap_runs (l_page->
     m_lines_words_mask[block_index][line_index]);
 
   /* set number of words */
@@ -449,6 +501,16 @@ ho_layout_create_word_mask (ho_layout * l_page, const int block_index,
     (int *) malloc (l_page->n_words[block_index][line_index] * sizeof (int));
   if (!l_page->n_fonts)
     return TRUE;
+  l_page->fonts_x_start[block_index][line_index] =
+    (int **) malloc (l_page->n_words[block_index][line_index] *
+    sizeof (int *));
+  if (!l_page->fonts_x_start[block_index][line_index])
+    return TRUE;
+  l_page->fonts_x_end[block_index][line_index] =
+    (int **) malloc (l_page->n_words[block_index][line_index] *
+    sizeof (int *));
+  if (!l_page->fonts_x_end[block_index][line_index])
+    return TRUE;
 
   /* link all free pointers to NULL */
   for (i = 0; i < l_page->n_words[block_index][line_index]; i++)
@@ -458,23 +520,83 @@ ho_layout_create_word_mask (ho_layout * l_page, const int block_index,
     l_page->m_words_font_mask[block_index][line_index][i] = NULL;
 
     l_page->n_fonts[block_index][line_index][i] = 0;
+    l_page->fonts_x_start[block_index][line_index][i] = NULL;
+    l_page->fonts_x_end[block_index][line_index][i] = NULL;
   }
 
   return FALSE;
 }
 
-int
-ho_layout_create_font_mask (ho_layout * l_page, const int block_index,
+/* 
+ * count fonts of a word font mask, fonts are the gaps between the cuts on
+ * row 2, and get the cut columns on both sides of each font counting from
+ * the right, cuts missing at the word edges are the columns just outside it 
+ */
+static int
+ho_layout_font_columns (const ho_bitmap * m_word_font_mask, int *n_fonts,
+  int **x_start_list, int **x_end_list)
+{
+  int x, i;
+  int x_start, x_end;
+
+  /* count fonts */
+  i = 0;
+  x = 0;
+  while (x < m_word_font_mask->width)
+  {
+    /* get start&end of font */
+    for (;
+      x < m_word_font_mask->width
+      && ho_bitmap_get (m_word_font_mask, x, 2); x++) ;
+    i++;
+    for (;
+      x < m_word_font_mask->width
+      && !ho_bitmap_get (m_word_font_mask, x, 2); x++) ;
+  }
+  *n_fonts = i;
+
+  *x_start_list = (int *) malloc ((*n_fonts + 1) * sizeof (int));
+  *x_end_list = (int *) malloc ((*n_fonts + 1) * sizeof (int));
+  if (!*x_start_list || !*x_end_list)
+    return TRUE;
+
+  /* get font start and end points, once the word is scanned all the next
+   * fonts get the last ones */
+  x = m_word_font_mask->width - 1;
+  x_start = x;
+  x_end = x + 1;
+  for (i = 0; i < *n_fonts; i++)
+  {
+    if (x >= 0)
+    {
+      for (; x >= 0 && ho_bitmap_get (m_word_font_mask, x, 2); x--) ;
+      x_end = x + 1;
+      for (; x >= 0 && !ho_bitmap_get (m_word_font_mask, x, 2); x--) ;
+      x_start = x;
+    }
+
+    (*x_start_list)[i] = x_start;
+    (*x_end_list)[i] = x_end;
+  }
+
+  return FALSE;
+}
+
+/* 
+ * create a word font mask without touching the page total of fonts, words
+ * of other lines may be worked on at the same time 
+ */
+static int
+ho_layout_create_word_fonts (ho_layout * l_page, const int block_index,
   const int line_index, const int word_index,
   const unsigned char slicing_threshold, const unsigned char slicing_width,
-                            const unsigned char line_leeway)
+  const unsigned char line_leeway)
 {
   /* ho_objmap *o_map_blocks = NULL; */
   ho_bitmap *m_word_text = NULL;
   ho_bitmap *m_word_line_mask = NULL;
   ho_bitmap *m_word_font_mask = NULL;
-  int x; /*, y, height, width;*/
-  int i;
+  int n_fonts;
 
   m_word_text = ho_layout_get_word_text (l_page, block_index,
     line_index, word_index);
@@ -499,31 +621,303 @@ ho_layout_create_font_mask (ho_layout * l_page, const int block_index,
   l_page->m_words_font_mask[block_index][line_index][word_index] =
     m_word_font_mask;
 
-  /* count fonts */
-  i = 0;
-  x = 0;
-  while (x < m_word_font_mask->width)
-  {
-    /* get start&end of font */
-    for (;
-      x < m_word_font_mask->width
-      && ho_bitmap_get (m_word_font_mask, x, 2); x++) ;
-    i++;
-    for (;
-      x < m_word_font_mask->width
-      && !ho_bitmap_get (m_word_font_mask, x, 2); x++) ;
-  }
+  /* count fonts and get their start&end */
+  if (ho_layout_font_columns (m_word_font_mask, &n_fonts,
+      &(l_page->fonts_x_start[block_index][line_index][word_index]),
+      &(l_page->fonts_x_end[block_index][line_index][word_index])))
+    return TRUE;
 
   /* set number of fonts */
-  l_page->n_fonts[block_index][line_index][word_index] = i;
+  l_page->n_fonts[block_index][line_index][word_index] = n_fonts;
+
+  return FALSE;
+}
+
+int
+ho_layout_create_font_mask (ho_layout * l_page, const int block_index,
+  const int line_index, const int word_index,
+  const unsigned char slicing_threshold, const unsigned char slicing_width,
+  const unsigned char line_leeway)
+{
+  if (ho_layout_create_word_fonts (l_page, block_index, line_index,
+      word_index, slicing_threshold, slicing_width, line_leeway))
+    return TRUE;
 
   /* update total number of fonts */
   /* FIXME: this only works if create is used only once */
-  l_page->number_of_fonts += i;
-  
+  l_page->number_of_fonts +=
+    l_page->n_fonts[block_index][line_index][word_index];
+
+  return FALSE;
+}
+
+/* 
+ * create the words and fonts masks of a line, and count its fonts 
+ */
+static int
+ho_layout_create_line_fonts (ho_layout * l_page, const int block_index,
+  const int line_index, const unsigned char slicing_threshold,
+  const unsigned char slicing_width, const unsigned char line_leeway,
+  int *n_fonts)
+{
+  int word_index;
+  int failed;
+
+  *n_fonts = 0;
+
+  /* a word that failed has no fonts, the words after it are still made */
+  failed = ho_layout_create_word_mask (l_page, block_index, line_index);
+
+  /* look for fonts inside words */
+  for (word_index = 0;
+    word_index < l_page->n_words[block_index][line_index]; word_index++)
+  {
+    if (ho_layout_create_word_fonts (l_page, block_index, line_index,
+        word_index, slicing_threshold, slicing_width, line_leeway))
+      failed = TRUE;
+
+    *n_fonts += l_page->n_fonts[block_index][line_index][word_index];
+  }
+
+  return failed;
+}
+
+static int
+ho_layout_create_masks (ho_layout * l_page,
+  const unsigned char slicing_threshold, const unsigned char slicing_width,
+  const unsigned char line_leeway, int *progress)
+{
+  int block_index;
+  int line_index;
+  int n_fonts;
+  int failed = FALSE;
+
+  /* look for lines inside blocks */
+  for (block_index = 0; block_index < l_page->n_blocks; block_index++)
+  {
+    /* the lines arrays of a failed block may be missing */
+    if (ho_layout_create_line_mask (l_page, block_index))
+    {
+      failed = TRUE;
+      continue;
+    }
+
+    /* look for words inside line */
+    for (line_index = 0; line_index < l_page->n_lines[block_index];
+      line_index++)
+    {
+      if (ho_layout_create_line_fonts (l_page, block_index, line_index,
+          slicing_threshold, slicing_width, line_leeway, &n_fonts))
+        failed = TRUE;
+
+      l_page->number_of_fonts += n_fonts;
+
+      /* update progress */
+      *progress = 100 *
+        ((double) block_index /
+        (double) l_page->n_blocks +
+        (double) line_index /
+        (double) (l_page->n_lines[block_index] * l_page->n_blocks));
+    }
+  }
+
+  return failed;
+}
+
+#ifdef USE_PTHREADS
+
+/* most threads working on one page */
+#define HO_LAYOUT_MAX_THREADS 64
+
+/* a block, or a line of a block if line_index is not negative */
+typedef struct
+{
+  int block_index;
+  int line_index;
+} ho_layout_task;
+
+/* 
+ * tasks shared by the layout threads, a block queues its lines once its
+ * lines mask is made, and an idle thread takes the oldest task waiting 
+ */
+typedef struct
+{
+  ho_layout *l_page;
+  unsigned char slicing_threshold;
+  unsigned char slicing_width;
+  unsigned char line_leeway;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  ho_layout_task *tasks;
+  int n_tasks;
+  int allocated_tasks;
+  int next_task;
+  int n_busy;
+  int failed;
+  double done;
+  int *progress;
+} ho_layout_queue;
+
+/* queue the lines of a block, the queue lock is held */
+static int
+ho_layout_queue_lines (ho_layout_queue * q, const int block_index)
+{
+  ho_layout_task *tasks;
+  int n_lines = q->l_page->n_lines[block_index];
+  int i;
+
+  if (q->n_tasks + n_lines > q->allocated_tasks)
+  {
+    tasks = (ho_layout_task *) realloc (q->tasks,
+      (q->n_tasks + n_lines + q->allocated_tasks) * sizeof (ho_layout_task));
+    if (!tasks)
+      return TRUE;
+
+    q->tasks = tasks;
+    q->allocated_tasks += q->n_tasks + n_lines;
+  }
+
+  for (i = 0; i < n_lines; i++)
+  {
+    q->tasks[q->n_tasks].block_index = block_index;
+    q->tasks[q->n_tasks].line_index = i;
+    q->n_tasks++;
+  }
+
   return FALSE;
 }
 
+static void *
+ho_layout_worker (void *arg)
+{
+  ho_layout_queue *q = (ho_layout_queue *) arg;
+  ho_layout *l_page = q->l_page;
+  ho_layout_task task;
+  int n_fonts;
+  int failed;
+
+  pthread_mutex_lock (&q->lock);
+
+  /* work until no task is waiting and no running task can queue more */
+  while (q->next_task < q->n_tasks || q->n_busy)
+  {
+    if (q->next_task == q->n_tasks)
+    {
+      pthread_cond_wait (&q->changed, &q->lock);
+      continue;
+    }
+
+    task = q->tasks[q->next_task];
+    q->next_task++;
+    q->n_busy++;
+    pthread_mutex_unlock (&q->lock);
+
+    n_fonts = 0;
+    if (task.line_index < 0)
+      failed = ho_layout_create_line_mask (l_page, task.block_index);
+    else
+      failed = ho_layout_create_line_fonts (l_page, task.block_index,
+        task.line_index, q->slicing_threshold, q->slicing_width,
+        q->line_leeway, &n_fonts);
+
+    pthread_mutex_lock (&q->lock);
+
+    if (failed)
+      q->failed = TRUE;
+
+    /* the lines arrays of a failed block may be missing */
+    if (task.line_index >= 0)
+    {
+      l_page->number_of_fonts += n_fonts;
+      q->done += 1.0 / (double) (l_page->n_lines[task.block_index] *
+        l_page->n_blocks);
+    }
+    else if (failed || !l_page->n_lines[task.block_index])
+      q->done += 1.0 / (double) l_page->n_blocks;
+    else if (ho_layout_queue_lines (q, task.block_index))
+      q->failed = TRUE;
+
+    /* update progress */
+    *(q->progress) = 100 * q->done;
+
+    q->n_busy--;
+    pthread_cond_broadcast (&q->changed);
+  }
+
+  pthread_mutex_unlock (&q->lock);
+
+  return NULL;
+}
+
+#endif /* USE_PTHREADS */
+
+int
+ho_layout_create_masks_threads (ho_layout * l_page,
+  const unsigned char slicing_threshold, const unsigned char slicing_width,
+  const unsigned char line_leeway, const int n_threads, int *progress)
+{
+#ifdef USE_PTHREADS
+  ho_layout_queue q;
+  pthread_t threads[HO_LAYOUT_MAX_THREADS];
+  int started[HO_LAYOUT_MAX_THREADS];
+  int n_workers;
+  int i;
+
+  /* one thread is the serial layout */
+  n_workers = n_threads;
+  if (n_workers > HO_LAYOUT_MAX_THREADS)
+    n_workers = HO_LAYOUT_MAX_THREADS;
+  if (n_workers < 2 || l_page->n_blocks < 1)
+    return ho_layout_create_masks (l_page, slicing_threshold, slicing_width,
+      line_leeway, progress);
+
+  /* queue all blocks, their lines are queued later */
+  q.allocated_tasks = 2 * l_page->n_blocks;
+  q.tasks =
+    (ho_layout_task *) malloc (q.allocated_tasks * sizeof (ho_layout_task));
+  if (!q.tasks)
+    return TRUE;
+
+  for (i = 0; i < l_page->n_blocks; i++)
+  {
+    q.tasks[i].block_index = i;
+    q.tasks[i].line_index = -1;
+  }
+
+  q.l_page = l_page;
+  q.slicing_threshold = slicing_threshold;
+  q.slicing_width = slicing_width;
+  q.line_leeway = line_leeway;
+  q.n_tasks = l_page->n_blocks;
+  q.next_task = 0;
+  q.n_busy = 0;
+  q.failed = FALSE;
+  q.done = 0.0;
+  q.progress = progress;
+  pthread_mutex_init (&q.lock, NULL);
+  pthread_cond_init (&q.changed, NULL);
+
+  /* threads that failed to start leave their share to the others */
+  for (i = 1; i < n_workers; i++)
+    started[i] = !pthread_create (&threads[i], NULL, ho_layout_worker, &q);
+
+  ho_layout_worker (&q);
+
+  for (i = 1; i < n_workers; i++)
+    if (started[i])
+      pthread_join (threads[i], NULL);
+
+  pthread_cond_destroy (&q.changed);
+  pthread_mutex_destroy (&q.lock);
+  free (q.tasks);
+
+  return q.failed;
+#else
+  return ho_layout_create_masks (l_page, slicing_threshold, slicing_width,
+    line_leeway, progress);
+#endif /* USE_PTHREADS */
+}
+
 ho_bitmap *
 ho_layout_get_block_text (const ho_layout * l_page, int block_index)
 {
@@ -683,20 +1077,20 @@ ho_layout_get_line_line_mask (const ho_layout * l_page, int block_index,
   return m_line_mask;
 }
 
-ho_bitmap *
-ho_layout_get_word_text (const ho_layout * l_page, int block_index, int line_index,
-  int word_index)
+int
+ho_layout_get_word_view (const ho_layout * l_page, int block_index,
+  int line_index, int word_index, ho_bitmap_view * v_word)
 {
-  ho_bitmap *m_word_text = NULL;
-  ho_bitmap *m_line_text = NULL;
   ho_objmap *o_map_words = NULL;
   int x, y, width, height;
   int x_start, y_start;
 
   /* get paragraph objmap */
   o_map_words =
-    ho_objmap_new_from_bitmap (l_page->
+    ho_objmap_new_from_bitmap_runs (l_page->
     m_lines_words_mask[block_index][line_index]);
+  if (!o_map_words)
+    return TRUE;
   x_start = l_page->m_lines_words_mask[block_index][line_index]->x;
   y_start = l_page->m_lines_words_mask[block_index][line_index]->y;
 
@@ -709,9 +1103,26 @@ ho_layout_get_word_text (const ho_layout * l_page, int block_index, int line_ind
   height = ho_objmap_get_object (o_map_words, word_index).height;
   ho_objmap_free (o_map_words);
 
+  return ho_bitmap_view_init (v_word, l_page->m_page_text, x, y, width,
+    height);
+}
+
+ho_bitmap *
+ho_layout_get_word_text (const ho_layout * l_page, int block_index, int line_index,
+  int word_index)
+{
+  ho_bitmap *m_word_text = NULL;
+  ho_bitmap *m_line_text = NULL;
+  ho_bitmap_view v_word;
+
+  if (ho_layout_get_word_view (l_page, block_index, line_index, word_index,
+      &v_word))
+    return NULL;
+
   m_line_text = l_page->m_lines_text[block_index][line_index];
-  m_word_text =
-    ho_bitmap_clone_window (l_page->m_page_text, x, y, width, height);
+  m_word_text = ho_bitmap_new_from_view (&v_word);
+  if (!m_word_text)
+    return NULL;
 
   /* get the right fill args from line and not from page */
   m_word_text->avg_line_fill = m_line_text->avg_line_fill;
@@ -736,7 +1147,7 @@ ho_layout_get_word_line_mask (const ho_layout * l_page, int block_index,
 
   /* get paragraph objmap */
   o_map_words =
-    ho_objmap_new_from_bitmap (l_page->
+    ho_objmap_new_from_bitmap_runs (l_page->
     m_lines_words_mask[block_index][line_index]);
   x_start = l_page->m_lines_words_mask[block_index][line_index]->x;
   y_start = l_page->m_lines_words_mask[block_index][line_index]->y;
@@ -756,16 +1167,13 @@ ho_layout_get_word_line_mask (const ho_layout * l_page, int block_index,
   return m_word_line_mask;
 }
 
-ho_bitmap *
-ho_layout_get_font_text (const ho_layout * l_page, int block_index, int line_index,
-  int word_index, int font_index)
+int
+ho_layout_get_font_view (const ho_layout * l_page, int block_index,
+  int line_index, int word_index, int font_index, ho_bitmap_view * v_font)
 {
-  ho_bitmap *m_font_text = NULL;
   ho_bitmap *m_word_text = NULL;
-  ho_bitmap *m_word_font_mask = NULL;
   int x, y, width, height;
   int x_start, x_end;
-  int i;
   int index;
 
   /* if left to right font order is reversed */
@@ -778,24 +1186,10 @@ ho_layout_get_font_text (const ho_layout * l_page, int block_index, int line_ind
     index = font_index;
 
   m_word_text = l_page->m_words_text[block_index][line_index][word_index];
-  m_word_font_mask =
-    l_page->m_words_font_mask[block_index][line_index][word_index];
 
   /* get font start and end points */
-  /* count fonts */
-  i = -1;
-  x = m_word_font_mask->width - 1;
-  x_start = x;
-  x_end = x+1;
-  while (x >= 0 && i < index)
-  {
-    /* get start&end of font */
-    for (; x >= 0 && ho_bitmap_get (m_word_font_mask, x, 2); x--) ;
-    x_end = x + 1;
-    i++;
-    for (; x >= 0 && !ho_bitmap_get (m_word_font_mask, x, 2); x--) ;
-    x_start = x;
-  }
+  x_start = l_page->fonts_x_start[block_index][line_index][word_index][index];
+  x_end = l_page->fonts_x_end[block_index][line_index][word_index][index];
 
   /* get font place on m_text */
   y = m_word_text->y;
@@ -803,8 +1197,26 @@ ho_layout_get_font_text (const ho_layout * l_page, int block_index, int line_ind
   height = m_word_text->height;
   width = x_end - x_start + 1;
 
-  m_font_text =
-    ho_bitmap_clone_window (l_page->m_page_text, x, y, width, height);
+  return ho_bitmap_view_init (v_font, l_page->m_page_text, x, y, width,
+    height);
+}
+
+ho_bitmap *
+ho_layout_get_font_text (const ho_layout * l_page, int block_index, int line_index,
+  int word_index, int font_index)
+{
+  ho_bitmap *m_font_text = NULL;
+  ho_bitmap *m_word_text = NULL;
+  ho_bitmap_view v_font;
+
+  if (ho_layout_get_font_view (l_page, block_index, line_index, word_index,
+      font_index, &v_font))
+    return NULL;
+
+  m_word_text = l_page->m_words_text[block_index][line_index][word_index];
+  m_font_text = ho_bitmap_new_from_view (&v_font);
+  if (!m_font_text)
+    return NULL;
 
   /* get the right fill args from line and not from page */
   m_font_text->avg_line_fill = m_word_text->avg_line_fill;
@@ -823,10 +1235,8 @@ ho_layout_get_font_line_mask (const ho_layout * l_page, int block_index,
 {
   ho_bitmap *m_font_line_mask = NULL;
   ho_bitmap *m_word_line_mask = NULL;
-  ho_bitmap *m_word_font_mask = NULL;
-  int x, width, height;
+  int width, height;
   int x_start, x_end;
-  int i;
   int index;
 
   /* if left to right font order is reversed */
@@ -840,24 +1250,10 @@ ho_layout_get_font_line_mask (const ho_layout * l_page, int block_index,
 
   m_word_line_mask =
     l_page->m_words_line_mask[block_index][line_index][word_index];
-  m_word_font_mask =
-    l_page->m_words_font_mask[block_index][line_index][word_index];
 
   /* get font start and end points */
-  /* count fonts */
-  i = -1;
-  x = m_word_font_mask->width - 1;
-  x_start = x;
-  x_end = x + 1;
-  while (x >= 0 && i < index)
-  {
-    /* get start&end of font */
-    for (; x >= 0 && ho_bitmap_get (m_word_font_mask, x, 2); x--) ;
-    x_end = x + 1;
-    i++;
-    for (; x >= 0 && !ho_bitmap_get (m_word_font_mask, x, 2); x--) ;
-    x_start = x;
-  }
+  x_start = l_page->fonts_x_start[block_index][line_index][word_index][index];
+  x_end = l_page->fonts_x_end[block_index][line_index][word_index][index];
 
   /* get font place on m_text */
   height = m_word_line_mask->height;
@@ -868,3 +1264,281 @@ ho_layout_get_font_line_mask (const ho_layout * l_page, int block_index,
 
   return m_font_line_mask;
 }
+
+/* records in the flat layout arena start on 8 bytes */
+#define HO_LAYOUT_FLAT_ALIGN(n) (((n) + 7) & ~((size_t) 7))
+
+/* first and last rows of m with black pixels, -1 if m is white */
+static void
+ho_layout_flat_mask_rows (const ho_bitmap * m, int *top, int *bottom)
+{
+  int i, y;
+
+  *top = *bottom = -1;
+  for (y = 0; y < m->height; y++)
+    for (i = 0; i < m->rowstride; i++)
+      if (m->data[y * m->rowstride + i])
+      {
+        if (*top < 0)
+          *top = y;
+        *bottom = y;
+        break;
+      }
+}
+
+ho_layout_flat *
+ho_layout_flat_new (const ho_layout * l_page)
+{
+  ho_layout_flat *l_flat = NULL;
+  ho_layout_block *block;
+  ho_layout_line *line;
+  ho_layout_word *word;
+  ho_layout_font *font;
+  const ho_bitmap *m_line_text;
+  const ho_bitmap *m_line_mask;
+  const ho_bitmap *m_word_text;
+  const ho_bitmap *m_word_line_mask;
+  unsigned char *arena;
+  size_t size, data_size;
+  int block_index, line_index, word_index, font_index;
+  int n_lines, n_words, n_fonts;
+  int index, top, bottom;
+
+  /* count records and bitmap data */
+  n_lines = n_words = n_fonts = 0;
+  data_size =
+    HO_LAYOUT_FLAT_ALIGN ((size_t) l_page->m_page_text->rowstride *
+    l_page->m_page_text->height);
+  for (block_index = 0; block_index < l_page->n_blocks; block_index++)
+    for (line_index = 0; line_index < l_page->n_lines[block_index];
+      line_index++)
+    {
+      n_lines++;
+      m_line_mask = l_page->m_lines_line_mask[block_index][line_index];
+      if (m_line_mask)
+        data_size +=
+          HO_LAYOUT_FLAT_ALIGN ((size_t) m_line_mask->rowstride *
+          m_line_mask->height);
+
+      for (word_index = 0;
+        word_index < l_page->n_words[block_index][line_index]; word_index++)
+      {
+        n_words++;
+        n_fonts += l_page->n_fonts[block_index][line_index][word_index];
+      }
+    }
+
+  /* one allocation for all */
+  size = HO_LAYOUT_FLAT_ALIGN (sizeof (ho_layout_flat)) +
+    HO_LAYOUT_FLAT_ALIGN (l_page->n_blocks * sizeof (ho_layout_block)) +
+    HO_LAYOUT_FLAT_ALIGN (n_lines * sizeof (ho_layout_line)) +
+    HO_LAYOUT_FLAT_ALIGN (n_words * sizeof (ho_layout_word)) +
+    HO_LAYOUT_FLAT_ALIGN (n_fonts * sizeof (ho_layout_font)) + data_size;
+  arena = (unsigned char *) malloc (size);
+  if (!arena)
+    return NULL;
+
+  l_flat = (ho_layout_flat *) arena;
+  arena += HO_LAYOUT_FLAT_ALIGN (sizeof (ho_layout_flat));
+  l_flat->blocks = (ho_layout_block *) arena;
+  arena += HO_LAYOUT_FLAT_ALIGN (l_page->n_blocks * sizeof (ho_layout_block));
+  l_flat->lines = (ho_layout_line *) arena;
+  arena += HO_LAYOUT_FLAT_ALIGN (n_lines * sizeof (ho_layout_line));
+  l_flat->words = (ho_layout_word *) arena;
+  arena += HO_LAYOUT_FLAT_ALIGN (n_words * sizeof (ho_layout_word));
+  l_flat->fonts = (ho_layout_font *) arena;
+  arena += HO_LAYOUT_FLAT_ALIGN (n_fonts * sizeof (ho_layout_font));
+
+  l_flat->dir = l_page->dir;
+  l_flat->n_blocks = l_page->n_blocks;
+  l_flat->n_lines = n_lines;
+  l_flat->n_words = n_words;
+  l_flat->n_fonts = n_fonts;
+
+  /* copy page text */
+  l_flat->m_page_text = *(l_page->m_page_text);
+  l_flat->m_page_text.data = arena;
+  memcpy (arena, l_page->m_page_text->data,
+    (size_t) l_page->m_page_text->rowstride * l_page->m_page_text->height);
+  arena +=
+    HO_LAYOUT_FLAT_ALIGN ((size_t) l_page->m_page_text->rowstride *
+    l_page->m_page_text->height);
+
+  /* fill records */
+  n_lines = n_words = n_fonts = 0;
+  for (block_index = 0; block_index < l_page->n_blocks; block_index++)
+  {
+    block = l_flat->blocks + block_index;
+    memset (block, 0, sizeof (ho_layout_block));
+    if (l_page->m_blocks_text && l_page->m_blocks_text[block_index])
+    {
+      block->x = l_page->m_blocks_text[block_index]->x;
+      block->y = l_page->m_blocks_text[block_index]->y;
+      block->width = l_page->m_blocks_text[block_index]->width;
+      block->height = l_page->m_blocks_text[block_index]->height;
+    }
+    block->first_line = n_lines;
+    block->n_lines = l_page->n_lines[block_index];
+
+    for (line_index = 0; line_index < l_page->n_lines[block_index];
+      line_index++)
+    {
+      line = l_flat->lines + n_lines;
+      memset (line, 0, sizeof (ho_layout_line));
+      line->block = block_index;
+      line->first_word = n_words;
+      line->n_words = l_page->n_words[block_index][line_index];
+
+      m_line_text = l_page->m_lines_text[block_index][line_index];
+      if (m_line_text)
+      {
+        line->x = m_line_text->x;
+        line->y = m_line_text->y;
+        line->width = m_line_text->width;
+        line->height = m_line_text->height;
+        line->font_height = m_line_text->font_height;
+        line->font_width = m_line_text->font_width;
+      }
+
+      /* copy line mask */
+      m_line_mask = l_page->m_lines_line_mask[block_index][line_index];
+      if (m_line_mask)
+      {
+        line->m_line_mask = *m_line_mask;
+        line->m_line_mask.data = arena;
+        memcpy (arena, m_line_mask->data,
+          (size_t) m_line_mask->rowstride * m_line_mask->height);
+        arena +=
+          HO_LAYOUT_FLAT_ALIGN ((size_t) m_line_mask->rowstride *
+          m_line_mask->height);
+
+        ho_layout_flat_mask_rows (m_line_mask, &top, &bottom);
+        if (top >= 0)
+        {
+          line->baseline = m_line_mask->y + bottom;
+          line->line_height = bottom - top + 1;
+        }
+      }
+
+      for (word_index = 0; word_index < line->n_words; word_index++)
+      {
+        word = l_flat->words + n_words;
+        memset (word, 0, sizeof (ho_layout_word));
+        word->line = n_lines;
+        word->first_font = n_fonts;
+        word->n_fonts = l_page->n_fonts[block_index][line_index][word_index];
+
+        m_word_text = l_page->m_words_text[block_index][line_index][word_index];
+        m_word_line_mask =
+          l_page->m_words_line_mask[block_index][line_index][word_index];
+        if (!m_word_text || !m_word_line_mask || !m_line_mask)
+        {
+          word->n_fonts = 0;
+          n_words++;
+          continue;
+        }
+
+        word->x = m_word_text->x;
+        word->y = m_word_text->y;
+        word->width = m_word_text->width;
+        word->height = m_word_text->height;
+        word->mask_x = m_word_line_mask->x - m_line_mask->x;
+        word->mask_y = m_word_line_mask->y - m_line_mask->y;
+        word->mask_width = m_word_line_mask->width;
+        word->mask_height = m_word_line_mask->height;
+
+        /* fonts in reading order */
+        for (font_index = 0; font_index < word->n_fonts; font_index++)
+        {
+          index = (l_page->dir) ? word->n_fonts - font_index - 1 : font_index;
+
+          font = l_flat->fonts + n_fonts;
+          font->word = n_words;
+          font->x = m_word_text->x +
+            l_page->fonts_x_start[block_index][line_index][word_index][index];
+          font->y = m_word_text->y;
+          font->width =
+            l_page->fonts_x_end[block_index][line_index][word_index][index] -
+            l_page->fonts_x_start[block_index][line_index][word_index][index]
+            + 1;
+          font->height = m_word_text->height;
+          n_fonts++;
+        }
+
+        n_words++;
+      }
+
+      n_lines++;
+    }
+  }
+
+  /* fonts of words left out are not counted */
+  l_flat->n_fonts = n_fonts;
+
+  return l_flat;
+}
+
+int
+ho_layout_flat_free (ho_layout_flat * l_flat)
+{
+  if (!l_flat)
+    return TRUE;
+
+  /* records and bitmap data are in the same allocation */
+  free (l_flat);
+
+  return FALSE;
+}
+
+int
+ho_layout_flat_get_word_view (const ho_layout_flat * l_flat, int word_index,
+  ho_bitmap_view * v_word)
+{
+  const ho_layout_word *word = l_flat->words + word_index;
+
+  return ho_bitmap_view_init (v_word, &(l_flat->m_page_text), word->x,
+    word->y, word->width, word->height);
+}
+
+int
+ho_layout_flat_get_font_view (const ho_layout_flat * l_flat, int font_index,
+  ho_bitmap_view * v_font)
+{
+  const ho_layout_font *font = l_flat->fonts + font_index;
+
+  return ho_bitmap_view_init (v_font, &(l_flat->m_page_text), font->x,
+    font->y, font->width, font->height);
+}
+
+ho_bitmap *
+ho_layout_flat_get_font_line_mask (const ho_layout_flat * l_flat,
+  int font_index)
+{
+  const ho_layout_font *font = l_flat->fonts + font_index;
+  const ho_layout_word *word = l_flat->words + font->word;
+  const ho_layout_line *line = l_flat->lines + word->line;
+  ho_bitmap *m_font_line_mask = NULL;
+  int x_start, x, y;
+
+  x_start = font->x - word->x;
+
+  m_font_line_mask = ho_bitmap_clone_window (&(line->m_line_mask),
+    word->mask_x + x_start, word->mask_y, font->width, word->mask_height);
+  if (!m_font_line_mask)
+    return NULL;
+
+  /* 
+   * the tree layout cuts the font out of a copy of the word line mask, so
+   * columns out of the word and the first row and column of the word copy
+   * stay white 
+   */
+  for (x = 0; x < font->width; x++)
+    if (x_start + x < 0 || x_start + x >= word->mask_width ||
+      (x_start + x == 0 && (x_start <= 0 || word->mask_x == 0)))
+      for (y = 0; y < m_font_line_mask->height; y++)
+        ho_bitmap_unset (m_font_line_mask, x, y);
+  for (x = 0; x < font->width; x++)
+    ho_bitmap_unset (m_font_line_mask, x, 0);
+
+  return m_font_line_mask;
+}
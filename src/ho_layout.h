@@ -33,6 +33,7 @@
 
 #include <ho_bitmap.h>
 #include <ho_objmap.h>
+#include <ho_dimentions.h>
 
 /** @struct ho_layout
   @brief libhocr layout struct
@@ -47,6 +48,7 @@ typedef struct
   
   /* black and white text image */
   ho_bitmap *m_page_text;
+  ho_page_analysis *page_analysis;
   ho_bitmap *m_page_blocks_mask;
 
   /* line text and masks arrays [number of text blocks] */
@@ -67,10 +69,103 @@ typedef struct
   ho_bitmap ****m_words_line_mask;
   ho_bitmap ****m_words_font_mask;
 
+  /* number of fonts in a word, and their start and end columns in the word
+   * counted from the right [number of text blocks][number of lines in
+   * block][number of words in line][number of fonts in word] */
   int ***n_fonts;
+  int ****fonts_x_start;
+  int ****fonts_x_end;
 
 } ho_layout;
 
+/** @struct ho_layout_block
+  @brief a text block of a flat layout, cordinates are page cordinates
+*/
+typedef struct
+{
+  int x;
+  int y;
+  int width;
+  int height;
+  int first_line;
+  int n_lines;
+} ho_layout_block;
+
+/** @struct ho_layout_line
+  @brief a text line of a flat layout, x, y, width and height are the line
+  text window, baseline is the page row of the bottom of the line mask.
+  the line mask data is kept in the flat layout arena
+*/
+typedef struct
+{
+  int block;
+  int x;
+  int y;
+  int width;
+  int height;
+  int baseline;
+  int line_height;
+  int font_height;
+  int font_width;
+  int first_word;
+  int n_words;
+  ho_bitmap m_line_mask;
+} ho_layout_line;
+
+/** @struct ho_layout_word
+  @brief a word of a flat layout, x, y, width and height are the word text
+  window, mask_x .. mask_height are the word window in its line mask
+*/
+typedef struct
+{
+  int line;
+  int x;
+  int y;
+  int width;
+  int height;
+  int mask_x;
+  int mask_y;
+  int mask_width;
+  int mask_height;
+  int first_font;
+  int n_fonts;
+} ho_layout_word;
+
+/** @struct ho_layout_font
+  @brief a font of a flat layout, the word text window between the cuts on
+  both sides of the font
+*/
+typedef struct
+{
+  int word;
+  int x;
+  int y;
+  int width;
+  int height;
+} ho_layout_font;
+
+/** @struct ho_layout_flat
+  @brief libhocr flat layout struct
+  
+  blocks, lines, words and fonts are kept in reading order in contiguous
+  arrays, children of a record are first_* .. first_* + n_* - 1 of the next
+  array. the struct, the arrays and all bitmap data are one allocation
+*/
+typedef struct
+{
+  unsigned char dir;
+  ho_bitmap m_page_text;
+
+  int n_blocks;
+  ho_layout_block *blocks;
+  int n_lines;
+  ho_layout_line *lines;
+  int n_words;
+  ho_layout_word *words;
+  int n_fonts;
+  ho_layout_font *fonts;
+} ho_layout_flat;
+
 /**
  new ho_layout 
  @param m_page_text a pointer to a text bitmap
@@ -115,7 +210,8 @@ int ho_layout_create_word_mask (ho_layout * l_page, const int block_index,
   const int line_index);
 
 /**
- create a text font mask and count fonts in n_fontss[block_index][line_index][word_index]
+ create a text font mask, count fonts in n_fonts[block_index][line_index][word_index]
+ and set their columns in fonts_x_start and fonts_x_end
  @param l_page a pointer to a ho_layout
  @param block_index the block_index to work on
  @param line_index the line_index to work on
@@ -130,6 +226,23 @@ int ho_layout_create_font_mask (ho_layout * l_page, const int block_index,
   const unsigned char slicing_threshold, const unsigned char slicing_width,
   const unsigned char line_leeway);
 
+/**
+ create the lines, words and fonts masks of all blocks, blocks and their
+ lines are taken by idle threads one at a time, the layout is the same for
+ any number of threads
+ @param l_page a pointer to a ho_layout with blocks mask
+ @param slicing_threshold the slicing threshold
+ @param slicing_width the slicing width
+ @param line_leeway the line leeway below and above line
+ @param n_threads number of threads to use (0,1-one thread)
+ @param progress a pointer to an int progress indicator 0..100
+ @return FALSE if all masks were made
+ */
+int
+ho_layout_create_masks_threads (ho_layout * l_page,
+  const unsigned char slicing_threshold, const unsigned char slicing_width,
+  const unsigned char line_leeway, const int n_threads, int *progress);
+
 /**
  new ho_bitamp of the text in a layout block
  
@@ -150,6 +263,33 @@ ho_bitmap *ho_layout_get_block_text (const ho_layout * l_page, int block_index);
 ho_bitmap *ho_layout_get_line_text (const ho_layout * l_page, int block_index,
   int line_index);
 
+/**
+ set a view to the text of a layout word, no data is copied
+ 
+ @param l_page the ho_layout to use
+ @param block_index block index
+ @param line_index line index
+ @param word_index word index
+ @param v_word the view to set, valid as long as l_page is
+ @return FALSE
+ */
+int ho_layout_get_word_view (const ho_layout * l_page, int block_index,
+  int line_index, int word_index, ho_bitmap_view * v_word);
+
+/**
+ set a view to the text of a layout font, no data is copied
+ 
+ @param l_page the ho_layout to use
+ @param block_index block index
+ @param line_index line index
+ @param word_index word index
+ @param font_index font index
+ @param v_font the view to set, valid as long as l_page is
+ @return FALSE
+ */
+int ho_layout_get_font_view (const ho_layout * l_page, int block_index,
+  int line_index, int word_index, int font_index, ho_bitmap_view * v_font);
+
 /**
  new ho_bitamp of the text in a layout word
  
@@ -211,4 +351,52 @@ ho_bitmap *ho_layout_get_word_line_mask (const ho_layout * l_page, int block_ind
 ho_bitmap *ho_layout_get_font_line_mask (const ho_layout * l_page, int block_index,
   int line_index, int word_index, int font_index);
 
+/**
+ new flat ho_layout, a copy of a layout that no longer needs it
+ 
+ @param l_page the ho_layout to copy, with its font masks created
+ @return a newly allocated flat layout, free it with ho_layout_flat_free
+ */
+ho_layout_flat *ho_layout_flat_new (const ho_layout * l_page);
+
+/**
+ free a flat ho_layout
+ @param l_flat a pointer to a ho_layout_flat
+ @return FALSE
+ */
+int ho_layout_flat_free (ho_layout_flat * l_flat);
+
+/**
+ set a view to the text of a flat layout word, no data is copied
+ 
+ @param l_flat the ho_layout_flat to use
+ @param word_index index of the word in the words array
+ @param v_word the view to set, valid as long as l_flat is
+ @return FALSE
+ */
+int ho_layout_flat_get_word_view (const ho_layout_flat * l_flat,
+  int word_index, ho_bitmap_view * v_word);
+
+/**
+ set a view to the text of a flat layout font, no data is copied
+ 
+ @param l_flat the ho_layout_flat to use
+ @param font_index index of the font in the fonts array
+ @param v_font the view to set, valid as long as l_flat is
+ @return FALSE
+ */
+int ho_layout_flat_get_font_view (const ho_layout_flat * l_flat,
+  int font_index, ho_bitmap_view * v_font);
+
+/**
+ new ho_bitamp of the line in a flat layout font, same as 
+ ho_layout_get_font_line_mask
+ 
+ @param l_flat the ho_layout_flat to use
+ @param font_index index of the font in the fonts array
+ @return newly allocated ho_bitmap
+ */
+ho_bitmap *ho_layout_flat_get_font_line_mask (const ho_layout_flat * l_flat,
+  int font_index);
+
 #endif /* HO_LAYOUT_H */
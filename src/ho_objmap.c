@@ -27,6 +27,10 @@
 #include <stdlib.h>
 #include <math.h>
 
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+
 #include "hebocr_globals.h"
 #include "ho_dimentions.h"
 #include "ho_objmap.h"
@@ -86,18 +90,19 @@ ho_objlist_add (ho_objlist * object_list, double weight,
   if ((object_list->size + 1) > 2000000000)
     return TRUE;
 
-  /* check for allocated space and try to get more memory */
+  /* check for allocated space and try to get more memory, grow the list
+   * geometrically */
   if ((object_list->size + 1) >= object_list->allocated_size)
   {
     new_object_list_objects = (ho_obj *)
       realloc (object_list->objects, sizeof (ho_obj) *
-      (object_list->allocated_size + 1000));
+      (object_list->allocated_size * 2));
 
     /* got new memory */
     if (new_object_list_objects)
     {
       object_list->objects = new_object_list_objects;
-      object_list->allocated_size += 1000;
+      object_list->allocated_size *= 2;
     }
     /* did not get new memory */
     else
@@ -114,16 +119,36 @@ ho_objlist_add (ho_objlist * object_list, double weight,
   (object_list->objects)[object_list->size].y = y;
   (object_list->objects)[object_list->size].height = height;
   (object_list->objects)[object_list->size].width = width;
+  memset (&((object_list->objects)[object_list->size].shape), 0,
+    sizeof (ho_obj_shape));
   (object_list->size)++;
 
   return FALSE;
 }
 
+/* add a copy of object, with its shape statistics */
+static int
+ho_objlist_add_object (ho_objlist * object_list, const ho_obj * object)
+{
+  if (ho_objlist_add (object_list, object->weight, object->x, object->y,
+      object->width, object->height))
+    return TRUE;
+
+  (object_list->objects)[object_list->size - 1].shape = object->shape;
+
+  return FALSE;
+}
+
 int
 ho_objlist_get_index (ho_objlist * object_list, int index)
 {
+  /* walk up to the root, halving the path on the way */
   while ((object_list->objects)[index].index != index)
+  {
+    (object_list->objects)[index].index =
+      (object_list->objects)[(object_list->objects)[index].index].index;
     index = (object_list->objects)[index].index;
+  }
 
   return index;
 }
@@ -246,11 +271,8 @@ ho_objlist_clean (ho_objlist * object_list, int **map)
     (*map)[i] = 0;
     if ((object_list->objects)[i].index == i)
     {
-      ho_objlist_add (temp_object_list,
-        ((object_list->objects)[i]).weight,
-        ((object_list->objects)[i]).x,
-        ((object_list->objects)[i]).y,
-        ((object_list->objects)[i]).width, ((object_list->objects)[i]).height);
+      ho_objlist_add_object (temp_object_list,
+        &((object_list->objects)[i]));
       /* this index point to a new index */
       (*map)[i] = new_index;
       /* increas index */
@@ -262,12 +284,8 @@ ho_objlist_clean (ho_objlist * object_list, int **map)
   object_list->size = 0;
   for (i = 0; i < (temp_object_list->size); i++)
   {
-    ho_objlist_add (object_list,
-      ((temp_object_list->objects)[i]).weight,
-      ((temp_object_list->objects)[i]).x,
-      ((temp_object_list->objects)[i]).y,
-      ((temp_object_list->objects)[i]).width,
-      ((temp_object_list->objects)[i]).height);
+    ho_objlist_add_object (object_list,
+      &((temp_object_list->objects)[i]));
   }
 
   /* unref the temporary list */
@@ -280,7 +298,9 @@ int
 ho_objlist_clean_by_reading_index (ho_objlist * object_list, int **map)
 {
   ho_objlist *temp_object_list;
-  int new_index, i, j;
+  int *start;
+  int *order;
+  int n, i, j;
 
   /* allocate temporary list */
   temp_object_list = ho_objlist_new ();
@@ -288,41 +308,59 @@ ho_objlist_clean_by_reading_index (ho_objlist * object_list, int **map)
     return TRUE;
 
   *map = (int *) calloc (object_list->size, sizeof (int));
-  if (!(*map))
+  start = (int *) calloc (object_list->size + 1, sizeof (int));
+  order = (int *) malloc ((object_list->size + 1) * sizeof (int));
+  if (!(*map) || !start || !order)
   {
+    if (*map)
+      free (*map);
+    if (start)
+      free (start);
+    if (order)
+      free (order);
     ho_objlist_free (temp_object_list);
     return TRUE;
   }
 
-  /* map by reading index */
-  new_index = 0;
+  /* count objects by reading index */
+  for (j = 0; j < (object_list->size); j++)
+  {
+    i = (object_list->objects)[j].reading_index;
+    if (i >= 0 && i < object_list->size)
+      start[i + 1]++;
+  }
   for (i = 0; i < (object_list->size); i++)
+    start[i + 1] += start[i];
+
+  /* map by reading index, objects with equal reading index keep order */
+  n = 0;
+  for (j = 0; j < (object_list->size); j++)
   {
-    for (j = 0; j < (object_list->size); j++)
-      if ((object_list->objects)[j].reading_index == i)
-      {
-        /* this index is this reading order */
-        (*map)[j] = i;
-
-        ho_objlist_add (temp_object_list,
-          ((object_list->objects)[j]).weight,
-          ((object_list->objects)[j]).x,
-          ((object_list->objects)[j]).y,
-          ((object_list->objects)[j]).width,
-          ((object_list->objects)[j]).height);
-      }
+    i = (object_list->objects)[j].reading_index;
+    if (i >= 0 && i < object_list->size)
+    {
+      /* this index is this reading order */
+      (*map)[j] = i;
+      order[start[i]++] = j;
+      n++;
+    }
+  }
+
+  for (i = 0; i < n; i++)
+  {
+    j = order[i];
+    ho_objlist_add_object (temp_object_list, &((object_list->objects)[j]));
   }
 
+  free (start);
+  free (order);
+
   /* copy back objects from temporary list */
   object_list->size = 0;
   for (i = 0; i < (temp_object_list->size); i++)
   {
-    ho_objlist_add (object_list,
-      ((temp_object_list->objects)[i]).weight,
-      ((temp_object_list->objects)[i]).x,
-      ((temp_object_list->objects)[i]).y,
-      ((temp_object_list->objects)[i]).width,
-      ((temp_object_list->objects)[i]).height);
+    ho_objlist_add_object (object_list,
+      &((temp_object_list->objects)[i]));
   }
 
   /* unref the temporary list */
@@ -536,6 +574,8 @@ ho_objmap_new (const int width, const int height)
   m_new->y = 0;
   m_new->width = width;
   m_new->height = height;
+  m_new->runs = NULL;
+  m_new->row_runs = NULL;
 
   /* allocate memory for data (and set to zero) */
   m_new->map = (int *) calloc (m_new->height * m_new->width, sizeof (int));
@@ -566,6 +606,10 @@ ho_objmap_free (ho_objmap * m)
   ho_objlist_free (m->obj_list);
   if (m->map)
     free (m->map);
+  if (m->runs)
+    free (m->runs);
+  if (m->row_runs)
+    free (m->row_runs);
   free (m);
 
   return FALSE;
@@ -574,37 +618,39 @@ ho_objmap_free (ho_objmap * m)
 int
 ho_objmap_clean (ho_objmap * m)
 {
-  int x, y, k;
-  int index;
+  int i, k;
   int *map = NULL;
 
   /* relax the object matrix */
-  for (x = 0; x < m->width; x++)
-    for (y = 0; y < m->height; y++)
-    {
-
-      k = ho_objmap_get (m, x, y);
-      if (k)
-      {
-        index = ho_objlist_get_index ((m->obj_list), k - 1);
-        ho_objmap_set (m, x, y, index + 1);
-      }
-    }
+  for (i = 0; m->map && i < m->width * m->height; i++)
+  {
+    k = (m->map)[i];
+    if (k)
+      (m->map)[i] = ho_objlist_get_index ((m->obj_list), k - 1) + 1;
+  }
+  for (i = 0; m->runs && i < m->row_runs[m->height]; i++)
+  {
+    k = (m->runs)[i].label;
+    if (k)
+      (m->runs)[i].label = ho_objlist_get_index ((m->obj_list), k - 1) + 1;
+  }
 
   /* clean the object list */
   ho_objlist_clean ((m->obj_list), &map);
 
   /* re relax the object matrix */
-  for (x = 0; x < m->width; x++)
-    for (y = 0; y < m->height; y++)
-    {
-      k = ho_objmap_get (m, x, y);
-      if (k)
-      {
-        index = map[k - 1];
-        ho_objmap_set (m, x, y, index + 1);
-      }
-    }
+  for (i = 0; m->map && i < m->width * m->height; i++)
+  {
+    k = (m->map)[i];
+    if (k)
+      (m->map)[i] = map[k - 1] + 1;
+  }
+  for (i = 0; m->runs && i < m->row_runs[m->height]; i++)
+  {
+    k = (m->runs)[i].label;
+    if (k)
+      (m->runs)[i].label = map[k - 1] + 1;
+  }
 
   /* free all temporary memory */
   if (map)
@@ -617,8 +663,7 @@ int
 ho_objmap_sort_by_reading_index (ho_objmap * m, const unsigned char col,
   const unsigned char dir_ltr)
 {
-  int x, y, k;
-  int index;
+  int i, k;
   int *map = NULL;
 
   /* make sure reading order is set */
@@ -628,16 +673,18 @@ ho_objmap_sort_by_reading_index (ho_objmap * m, const unsigned char col,
   ho_objlist_clean_by_reading_index ((m->obj_list), &map);
 
   /* re relax the object matrix */
-  for (x = 0; x < m->width; x++)
-    for (y = 0; y < m->height; y++)
-    {
-      k = ho_objmap_get (m, x, y);
-      if (k)
-      {
-        index = map[k - 1];
-        ho_objmap_set (m, x, y, index + 1);
-      }
-    }
+  for (i = 0; m->map && i < m->width * m->height; i++)
+  {
+    k = (m->map)[i];
+    if (k)
+      (m->map)[i] = map[k - 1] + 1;
+  }
+  for (i = 0; m->runs && i < m->row_runs[m->height]; i++)
+  {
+    k = (m->runs)[i].label;
+    if (k)
+      (m->runs)[i].label = map[k - 1] + 1;
+  }
 
   /* free all temporary memory */
   if (map)
@@ -648,14 +695,397 @@ ho_objmap_sort_by_reading_index (ho_objmap * m, const unsigned char col,
 
 ho_objmap *
 ho_objmap_new_from_bitmap (const ho_bitmap * bit_in)
+{
+  ho_bitmap_view v_in;
+
+  if (!bit_in)
+    return NULL;
+
+  ho_bitmap_view_init (&v_in, bit_in, 0, 0, bit_in->width, bit_in->height);
+
+  return ho_objmap_new_from_bitmap_view (&v_in);
+}
+
+/* 
+ * union-find labeller 
+ */
+
+/** @struct ho_objmap_label
+  @brief provisional label of the labeller, x2 and y2 are inclusive
+*/
+typedef struct
+{
+  int parent;
+  int rank;
+  int first;
+  int weight;
+  int x1;
+  int y1;
+  int x2;
+  int y2;
+  ho_obj_shape shape;
+} ho_objmap_label;
+
+/** @struct ho_objmap_labels
+  @brief growing array of provisional labels
+*/
+typedef struct
+{
+  int size;
+  int allocated_size;
+  ho_objmap_label *labels;
+} ho_objmap_labels;
+
+static int
+ho_objmap_labels_add (ho_objmap_labels * l, const int x, const int y,
+  const int first)
+{
+  ho_objmap_label *new_labels;
+  ho_objmap_label *label;
+
+  /* grow geometrically */
+  if (l->size >= l->allocated_size)
+  {
+    new_labels = (ho_objmap_label *) realloc (l->labels,
+      sizeof (ho_objmap_label) * 2 * l->allocated_size);
+    if (!new_labels)
+      return -1;
+    l->labels = new_labels;
+    l->allocated_size *= 2;
+  }
+
+  label = l->labels + l->size;
+  label->parent = l->size;
+  label->rank = 0;
+  label->first = first;
+  label->weight = 0;
+  label->x1 = label->x2 = x;
+  label->y1 = label->y2 = y;
+  memset (&(label->shape), 0, sizeof (ho_obj_shape));
+  label->shape.top_x = label->shape.bottom_x = x;
+  label->shape.left_y = label->shape.right_y = y;
+
+  return (l->size)++;
+}
+
+static int
+ho_objmap_labels_init (ho_objmap_labels * l)
+{
+  l->size = 0;
+  l->allocated_size = 1024;
+  l->labels = (ho_objmap_label *) malloc (sizeof (ho_objmap_label) *
+    l->allocated_size);
+
+  return (l->labels) ? FALSE : TRUE;
+}
+
+/* find the root of a label, with path halving */
+static int
+ho_objmap_labels_find (ho_objmap_label * labels, int index)
+{
+  while (labels[index].parent != index)
+  {
+    labels[index].parent = labels[labels[index].parent].parent;
+    index = labels[index].parent;
+  }
+
+  return index;
+}
+
+/* join the sets of two labels, union by rank */
+static void
+ho_objmap_labels_union (ho_objmap_label * labels, int index1, int index2)
+{
+  index1 = ho_objmap_labels_find (labels, index1);
+  index2 = ho_objmap_labels_find (labels, index2);
+
+  if (index1 == index2)
+    return;
+
+  if (labels[index1].rank < labels[index2].rank)
+    labels[index1].parent = index2;
+  else if (labels[index1].rank > labels[index2].rank)
+    labels[index2].parent = index1;
+  else
+  {
+    labels[index2].parent = index1;
+    labels[index1].rank++;
+  }
+}
+
+/* number of leading zero bits in a non zero word */
+static int
+ho_objmap_clz64 (uint64_t word)
+{
+#ifdef __GNUC__
+  return __builtin_clzll (word);
+#else
+  int n = 0;
+
+  while (!(word & ((uint64_t) 1 << 63)))
+  {
+    word <<= 1;
+    n++;
+  }
+
+  return n;
+#endif
+}
+
+/* compare two roots by their first pixel */
+static int
+ho_objmap_labels_compare (const void *a, const void *b)
+{
+  const ho_objmap_label *label_a = *(const ho_objmap_label * const *) a;
+  const ho_objmap_label *label_b = *(const ho_objmap_label * const *) b;
+
+  return (label_a->first > label_b->first) - (label_a->first < label_b->first);
+}
+
+/* 
+ * first pass, label black pixels of rows y_start .. y_end - 1 and join 
+ * touching labels, the row above y_start is taken as white
+ */
+static int
+ho_objmap_labels_scan (ho_objmap * m, const ho_bitmap_view * bit_in,
+  ho_objmap_labels * l, const int y_start, const int y_end)
+{
+  ho_objmap_label *label;
+  uint64_t *row;
+  uint64_t word;
+  int *map_row;
+  int *map_up;
+  int *white_row;
+  int n_words;
+  int x, y, i, index, neighbor;
+
+  n_words = ho_bitmap_view_get_n_words (bit_in);
+  row = (uint64_t *) malloc ((n_words + 1) * sizeof (uint64_t));
+  white_row = (int *) calloc (m->width + 1, sizeof (int));
+  if (!row || !white_row)
+  {
+    if (row)
+      free (row);
+    if (white_row)
+      free (white_row);
+    return TRUE;
+  }
+
+  for (y = y_start; y < y_end; y++)
+  {
+    ho_bitmap_view_get_row_words (bit_in, y, row);
+    map_row = m->map + y * m->width;
+    map_up = (y == y_start) ? white_row : map_row - m->width;
+
+    for (i = 0; i < n_words; i++)
+    {
+      word = row[i];
+
+      /* skip the first column */
+      if (i == 0)
+        word &= ~((uint64_t) 1 << 63);
+
+      while (word)
+      {
+        x = i * 64 + ho_objmap_clz64 (word);
+        word &= ~((uint64_t) 1 << (63 - x % 64));
+
+        /* 
+         * if the pixel above is black, all the other neighbors touch it
+         * and are already joined
+         */
+        index = map_up[x] - 1;
+        if (index < 0)
+        {
+          neighbor = (x + 1 < m->width) ? map_up[x + 1] - 1 : -1;
+
+          if (map_row[x - 1])
+            index = map_row[x - 1] - 1;
+          else if (map_up[x - 1])
+            index = map_up[x - 1] - 1;
+          else
+          {
+            index = neighbor;
+            neighbor = -1;
+          }
+
+          if (index < 0)
+          {
+            /* new label, first is the pixel place in column major order */
+            index = ho_objmap_labels_add (l, x, y, x * m->height + y);
+            if (index < 0)
+            {
+              free (row);
+              free (white_row);
+              return TRUE;
+            }
+          }
+          else if (neighbor >= 0)
+            ho_objmap_labels_union (l->labels, index, neighbor);
+        }
+
+        /* update label statistics */
+        label = l->labels + index;
+        label->weight++;
+        if (label->x1 > x)
+          label->x1 = x;
+        if (label->x2 < x)
+          label->x2 = x;
+        if (label->y2 < y)
+          label->y2 = y;
+        if (label->first > x * m->height + y)
+          label->first = x * m->height + y;
+
+        map_row[x] = index + 1;
+      }
+    }
+  }
+
+  free (row);
+  free (white_row);
+
+  return FALSE;
+}
+
+/* 
+ * join the shape statistics of label into root, before their boxes are 
+ * joined 
+ */
+static void
+ho_objmap_label_merge_shape (ho_objmap_label * root,
+  const ho_objmap_label * label)
+{
+  root->shape.sum_x += label->shape.sum_x;
+  root->shape.sum_y += label->shape.sum_y;
+  root->shape.sum_xx += label->shape.sum_xx;
+  root->shape.sum_yy += label->shape.sum_yy;
+  root->shape.sum_xy += label->shape.sum_xy;
+  root->shape.perimeter += label->shape.perimeter;
+  root->shape.euler += label->shape.euler;
+
+  /* extreme points, ties go to the top or left most pixel */
+  if (label->y1 < root->y1 || (label->y1 == root->y1
+      && label->shape.top_x < root->shape.top_x))
+    root->shape.top_x = label->shape.top_x;
+  if (label->y2 > root->y2 || (label->y2 == root->y2
+      && label->shape.bottom_x < root->shape.bottom_x))
+    root->shape.bottom_x = label->shape.bottom_x;
+  if (label->x1 < root->x1 || (label->x1 == root->x1
+      && label->shape.left_y < root->shape.left_y))
+    root->shape.left_y = label->shape.left_y;
+  if (label->x2 > root->x2 || (label->x2 == root->x2
+      && label->shape.right_y < root->shape.right_y))
+    root->shape.right_y = label->shape.right_y;
+}
+
+/* 
+ * second pass, fill the object list, return a newly allocated table of
+ * object index by label
+ */
+static int *
+ho_objmap_labels_resolve (ho_objmap * m, ho_objmap_labels * l,
+  const int shapes)
+{
+  ho_objmap_label **roots;
+  ho_objmap_label *label;
+  ho_objmap_label *root;
+  int *final;
+  int n_roots;
+  int i, index;
+
+  roots = (ho_objmap_label **) malloc ((l->size + 1) *
+    sizeof (ho_objmap_label *));
+  final = (int *) malloc ((l->size + 1) * sizeof (int));
+  if (!roots || !final)
+  {
+    if (roots)
+      free (roots);
+    if (final)
+      free (final);
+    return NULL;
+  }
+
+  /* collect statistics of each set into its root */
+  n_roots = 0;
+  for (i = 0; i < l->size; i++)
+  {
+    index = ho_objmap_labels_find (l->labels, i);
+    label = l->labels + i;
+    if (index == i)
+    {
+      roots[n_roots++] = label;
+      continue;
+    }
+
+    root = l->labels + index;
+    if (shapes)
+      ho_objmap_label_merge_shape (root, label);
+    root->weight += label->weight;
+    if (root->x1 > label->x1)
+      root->x1 = label->x1;
+    if (root->y1 > label->y1)
+      root->y1 = label->y1;
+    if (root->x2 < label->x2)
+      root->x2 = label->x2;
+    if (root->y2 < label->y2)
+      root->y2 = label->y2;
+    if (root->first > label->first)
+      root->first = label->first;
+  }
+
+  /* 
+   * objects are indexed by their first pixel in column major order, 
+   * same as the old column by column labeller 
+   */
+  qsort (roots, n_roots, sizeof (ho_objmap_label *), ho_objmap_labels_compare);
+
+  for (i = 0; i < n_roots; i++)
+  {
+    root = roots[i];
+    final[root - l->labels] = i;
+    if (ho_objlist_add ((m->obj_list), root->weight, root->x1, root->y1,
+        root->x2 - root->x1 + 1, root->y2 - root->y1 + 1))
+    {
+      free (roots);
+      free (final);
+      return NULL;
+    }
+    if (shapes)
+      (m->obj_list)->objects[i].shape = root->shape;
+  }
+  for (i = 0; i < l->size; i++)
+    final[i] = final[ho_objmap_labels_find (l->labels, i)];
+
+  free (roots);
+
+  return final;
+}
+
+/* 
+ * relabel map rows y_start .. y_end - 1 from label + offset to object 
+ * index 
+ */
+static void
+ho_objmap_labels_relabel (ho_objmap * m, const int *final, const int offset,
+  const int y_start, const int y_end)
+{
+  int *map = m->map + y_start * m->width;
+  int *map_end = m->map + y_end * m->width;
+
+  for (; map < map_end; map++)
+    if (*map)
+      *map = final[offset + *map - 1] + 1;
+}
+
+ho_objmap *
+ho_objmap_new_from_bitmap_view (const ho_bitmap_view * bit_in)
 {
   ho_objmap *m_new = NULL;
+  ho_objmap_labels l;
+  int *final;
 
-  int x, y, k;
-  double sum;
-  double neigbors[4];
-  int min;
-  int indexes[4];
+  if (!bit_in)
+    return NULL;
 
   /* allocate memory */
   m_new = ho_objmap_new (bit_in->width, bit_in->height);
@@ -664,77 +1094,540 @@ ho_objmap_new_from_bitmap (const ho_bitmap * bit_in)
   m_new->x = bit_in->x;
   m_new->y = bit_in->y;
 
-  /* link all concted black pixels */
-  for (x = 1; x < bit_in->width; x++)
-    for (y = 1; y < (bit_in->height - 1); y++)
+  if (ho_objmap_labels_init (&l))
+  {
+    ho_objmap_free (m_new);
+    return NULL;
+  }
+
+  /* label and link all conected black pixels, the first and last rows 
+   * and the first column are not labeled */
+  final = NULL;
+  if (ho_objmap_labels_scan (m_new, bit_in, &l, 1, bit_in->height - 1)
+    || !(final = ho_objmap_labels_resolve (m_new, &l, FALSE)))
+  {
+    free (l.labels);
+    ho_objmap_free (m_new);
+    return NULL;
+  }
+
+  ho_objmap_labels_relabel (m_new, final, 0, 0, m_new->height);
+
+  free (final);
+  free (l.labels);
+
+  return m_new;
+}
+
+#ifdef USE_PTHREADS
+
+/* smallest stripe worth a thread */
+#define HO_OBJMAP_STRIPE_MIN_HEIGHT 64
+
+/* most stripes in one objmap */
+#define HO_OBJMAP_MAX_STRIPES 64
+
+/** @struct ho_objmap_stripe
+  @brief rows y_start .. y_end - 1 of an objmap labeled by one thread
+*/
+typedef struct
+{
+  ho_objmap *m;
+  const ho_bitmap_view *bit_in;
+  ho_objmap_labels l;
+  int y_start;
+  int y_end;
+  int offset;
+  const int *final;
+  int failed;
+} ho_objmap_stripe;
+
+static void *
+ho_objmap_stripe_scan (void *data)
+{
+  ho_objmap_stripe *stripe = (ho_objmap_stripe *) data;
+
+  stripe->failed = ho_objmap_labels_init (&(stripe->l));
+  if (!stripe->failed)
+    stripe->failed = ho_objmap_labels_scan (stripe->m, stripe->bit_in,
+      &(stripe->l), stripe->y_start, stripe->y_end);
+
+  return NULL;
+}
+
+static void *
+ho_objmap_stripe_relabel (void *data)
+{
+  ho_objmap_stripe *stripe = (ho_objmap_stripe *) data;
+
+  ho_objmap_labels_relabel (stripe->m, stripe->final, stripe->offset,
+    stripe->y_start, stripe->y_end);
+
+  return NULL;
+}
+
+/* run func on all stripes, the first one on this thread, stripes whose
+ * thread can not be created also run here */
+static void
+ho_objmap_stripes_run (ho_objmap_stripe * stripes, const int n_stripes,
+  void *(*func) (void *))
+{
+  pthread_t threads[HO_OBJMAP_MAX_STRIPES];
+  int started[HO_OBJMAP_MAX_STRIPES];
+  int i;
+
+  for (i = 1; i < n_stripes; i++)
+    started[i] = !pthread_create (&threads[i], NULL, func, stripes + i);
+
+  func (stripes);
+
+  for (i = 1; i < n_stripes; i++)
+  {
+    if (started[i])
+      pthread_join (threads[i], NULL);
+    else
+      func (stripes + i);
+  }
+}
+
+#endif /* USE_PTHREADS */
+
+ho_objmap *
+ho_objmap_new_from_bitmap_threads (const ho_bitmap * bit_in,
+  const int n_threads)
+{
+#ifdef USE_PTHREADS
+  ho_objmap *m_new = NULL;
+  ho_objmap_labels l;
+  ho_objmap_stripe stripes[HO_OBJMAP_MAX_STRIPES];
+  ho_bitmap_view v_in;
+  int *final;
+  int *map_row;
+  int *map_up;
+  int n_stripes, n_rows;
+  int failed;
+  int i, j, x, dx, index;
+
+  if (!bit_in)
+    return NULL;
+
+  /* one stripe is the serial labeller */
+  n_rows = bit_in->height - 2;
+  n_stripes = n_threads;
+  if (n_stripes > HO_OBJMAP_MAX_STRIPES)
+    n_stripes = HO_OBJMAP_MAX_STRIPES;
+  if (n_stripes > n_rows / HO_OBJMAP_STRIPE_MIN_HEIGHT)
+    n_stripes = n_rows / HO_OBJMAP_STRIPE_MIN_HEIGHT;
+  if (n_stripes < 2)
+    return ho_objmap_new_from_bitmap (bit_in);
+
+  /* allocate memory */
+  m_new = ho_objmap_new (bit_in->width, bit_in->height);
+  if (!m_new)
+    return NULL;
+  m_new->x = bit_in->x;
+  m_new->y = bit_in->y;
+
+  ho_bitmap_view_init (&v_in, bit_in, 0, 0, bit_in->width, bit_in->height);
+
+  /* label the stripes, the first and last rows are not labeled */
+  for (i = 0; i < n_stripes; i++)
+  {
+    stripes[i].m = m_new;
+    stripes[i].bit_in = &v_in;
+    stripes[i].y_start = 1 + n_rows * i / n_stripes;
+    stripes[i].y_end = 1 + n_rows * (i + 1) / n_stripes;
+  }
+
+  ho_objmap_stripes_run (stripes, n_stripes, ho_objmap_stripe_scan);
+
+  /* put all the labels in one list, stripe labels start at offset */
+  failed = FALSE;
+  l.size = 0;
+  for (i = 0; i < n_stripes; i++)
+  {
+    stripes[i].offset = l.size;
+    if (stripes[i].failed)
+      failed = TRUE;
+    else
+      l.size += stripes[i].l.size;
+  }
+
+  l.allocated_size = l.size + 1;
+  l.labels = NULL;
+  if (!failed)
+    l.labels = (ho_objmap_label *) malloc (sizeof (ho_objmap_label) *
+      l.allocated_size);
+
+  for (i = 0; i < n_stripes; i++)
+  {
+    if (stripes[i].failed)
+    {
+      if (stripes[i].l.labels)
+        free (stripes[i].l.labels);
+      continue;
+    }
+
+    for (j = 0; l.labels && j < stripes[i].l.size; j++)
+    {
+      l.labels[stripes[i].offset + j] = stripes[i].l.labels[j];
+      l.labels[stripes[i].offset + j].parent += stripes[i].offset;
+    }
+    free (stripes[i].l.labels);
+  }
+
+  if (!l.labels)
+  {
+    ho_objmap_free (m_new);
+    return NULL;
+  }
+
+  /* join labels that touch across stripe borders */
+  for (i = 1; i < n_stripes; i++)
+  {
+    map_row = m_new->map + stripes[i].y_start * m_new->width;
+    map_up = map_row - m_new->width;
+
+    for (x = 1; x < m_new->width; x++)
     {
-      /* is pixel black ? */
-      if (ho_bitmap_get (bit_in, x, y))
+      if (!map_row[x])
+        continue;
+
+      index = stripes[i].offset + map_row[x] - 1;
+      for (dx = -1; dx <= 1; dx++)
+        if (x + dx < m_new->width && map_up[x + dx])
+          ho_objmap_labels_union (l.labels, index,
+            stripes[i - 1].offset + map_up[x + dx] - 1);
+    }
+  }
+
+  final = ho_objmap_labels_resolve (m_new, &l, FALSE);
+  free (l.labels);
+  if (!final)
+  {
+    ho_objmap_free (m_new);
+    return NULL;
+  }
+
+  /* relabel the stripes */
+  for (i = 0; i < n_stripes; i++)
+    stripes[i].final = final;
+
+  ho_objmap_stripes_run (stripes, n_stripes, ho_objmap_stripe_relabel);
+
+  free (final);
+
+  return m_new;
+#else
+  HEBOCR_UNUSED (n_threads);
+
+  return ho_objmap_new_from_bitmap (bit_in);
+#endif
+}
+
+/* 
+ * cut a row into runs of black pixels, the first column is skipped 
+ */
+static int
+ho_objmap_runs_from_row (uint64_t * row, const int n_words,
+  ho_objmap_run * runs)
+{
+  uint64_t word;
+  int n_runs = 0;
+  int open = FALSE;
+  int i, pos, n;
+
+  row[0] &= ~((uint64_t) 1 << 63);
+
+  for (i = 0; i < n_words; i++)
+  {
+    word = row[i];
+    pos = 0;
+
+    /* white word, most of a text page */
+    if (!open && !word)
+      continue;
+
+    while (pos < 64)
+    {
+      if (!open)
+      {
+        if (!word)
+          break;
+
+        /* skip to the next black pixel */
+        n = ho_objmap_clz64 (word);
+        pos += n;
+        word <<= n;
+        runs[n_runs].start = i * 64 + pos;
+        open = TRUE;
+      }
+      else
       {
-        /* get neigbors */
-        neigbors[0] = ho_objmap_get (m_new, x - 1, y - 1);
-        neigbors[1] = ho_objmap_get (m_new, x - 1, y - 0);
-        neigbors[2] = ho_objmap_get (m_new, x - 1, y + 1);
-        neigbors[3] = ho_objmap_get (m_new, x - 0, y - 1);
+        /* black to the end of the word, the run goes on */
+        if (!~word)
+          break;
+
+        /* skip to the next white pixel */
+        n = ho_objmap_clz64 (~word);
+        if (pos + n >= 64)
+          break;
+        pos += n;
+        word <<= n;
+        runs[n_runs].end = i * 64 + pos;
+        n_runs++;
+        open = FALSE;
+      }
+    }
+  }
 
-        sum = neigbors[0] + neigbors[1] + neigbors[2] + neigbors[3];
+  /* run that ends on the last word */
+  if (open)
+  {
+    runs[n_runs].end = n_words * 64;
+    n_runs++;
+  }
 
-        /* if no neigbor is black */
-        if (sum == 0)
-        {
-          if (ho_objlist_add ((m_new->obj_list), 1, x, y, 1, 1))
-          {
-            /* can't add to objects :-( */
-            ho_objmap_free (m_new);
-            return NULL;
-          }
+  return n_runs;
+}
 
-          /* in the matrix we insert index+1 */
-          ho_objmap_set (m_new, x, y, (m_new->obj_list)->size);
-        }
-        /* at least one neigbor is black */
-        else
-        {
-          /* find the index of the minimal frind */
-          min = 0;
-          for (k = 0; k < 4; k++)
-          {
-            if (neigbors[k])
-            {
-              indexes[k] =
-                ho_objlist_get_index ((m_new->obj_list), neigbors[k] - 1);
-              if (!min || (indexes[k] < (min - 1)))
-                /* indexes goes 0.. and min goes 1.. */
-                min = (indexes[k] + 1);
-            }
-            else
-              indexes[k] = 0;
-          }
-          /* min 1.. -> 0.. */
-          min--;
+/* sum of k * k for k = 0 .. n */
+static double
+ho_objmap_sum_squares (const double n)
+{
+  return n * (n + 1) * (2 * n + 1) / 6;
+}
 
-          /* set the current pixel in the objects matrix to that index */
-          ho_objmap_set (m_new, x, y, min + 1);
-          ho_objlist_add_pixel ((m_new->obj_list), min, x, y);
+/* 
+ * add a run on row y to the shape statistics of label, above are the runs
+ * of the row above starting with the first that may touch run, call before
+ * the box of label is updated 
+ */
+static void
+ho_objmap_label_add_run_shape (ho_objmap_label * label,
+  const ho_objmap_run * run, const ho_objmap_run * above,
+  const int n_above, const int y)
+{
+  double length = run->end - run->start;
+  double sum_x;
+  int x2 = run->end - 1;
+  int k, overlap;
+
+  /* extreme points */
+  if (y < label->y1 || (y == label->y1 && run->start < label->shape.top_x))
+    label->shape.top_x = run->start;
+  if (y > label->y2 || (y == label->y2 && run->start < label->shape.bottom_x))
+    label->shape.bottom_x = run->start;
+  if (run->start < label->x1 || (run->start == label->x1
+      && y < label->shape.left_y))
+    label->shape.left_y = y;
+  if (x2 > label->x2 || (x2 == label->x2 && y < label->shape.right_y))
+    label->shape.right_y = y;
+
+  /* moments */
+  sum_x = (double) (run->start + x2) * length / 2;
+  label->shape.sum_x += sum_x;
+  label->shape.sum_y += (double) y * length;
+  label->shape.sum_xx += ho_objmap_sum_squares (x2) -
+    ho_objmap_sum_squares (run->start - 1);
+  label->shape.sum_yy += (double) y * y * length;
+  label->shape.sum_xy += (double) y * sum_x;
 
-          /* link all object to that index */
-          for (k = 0; k < 4; k++)
-          {
-            if (indexes[k])
-              ho_objlist_link ((m_new->obj_list), min, indexes[k]);
-          }
+  /* 
+   * each run adds its edges and one to the euler number, each run above 
+   * that touches it (also diagonally) closes one loop, pixels that touch 
+   * the row above hide two edges 
+   */
+  label->shape.perimeter += 2 * (run->end - run->start) + 2;
+  label->shape.euler++;
+  for (k = 0; k < n_above && above[k].start <= run->end; k++)
+  {
+    label->shape.euler--;
+
+    overlap = ((run->end < above[k].end) ? run->end : above[k].end) -
+      ((run->start > above[k].start) ? run->start : above[k].start);
+    if (overlap > 0)
+      label->shape.perimeter -= 2 * overlap;
+  }
+}
+
+/* 
+ * label runs, gather shape statistics if shapes is TRUE 
+ */
+static ho_objmap *
+ho_objmap_new_from_bitmap_runs_labels (const ho_bitmap * bit_in,
+  const int shapes)
+{
+  ho_objmap *m_new = NULL;
+  ho_objmap_labels l;
+  ho_objmap_label *label;
+  ho_objmap_run *runs;
+  ho_objmap_run *runs_temp;
+  ho_bitmap_view v_in;
+  uint64_t *row;
+  int n_words, n_runs, allocated_runs;
+  int above_end, here;
+  int *final;
+  int first;
+  int failed = FALSE;
+  int y, i, j, k;
+
+  if (!bit_in)
+    return NULL;
+
+  /* allocate memory, no map */
+  m_new = (ho_objmap *) malloc (sizeof (ho_objmap));
+  if (!m_new)
+    return NULL;
+  m_new->x = bit_in->x;
+  m_new->y = bit_in->y;
+  m_new->width = bit_in->width;
+  m_new->height = bit_in->height;
+  m_new->map = NULL;
+  m_new->runs = NULL;
+  m_new->row_runs = (int *) calloc (bit_in->height + 1, sizeof (int));
+  m_new->obj_list = ho_objlist_new ();
+  if (!(m_new->obj_list) || !(m_new->row_runs))
+  {
+    ho_objmap_free (m_new);
+    return NULL;
+  }
+
+  ho_bitmap_view_init (&v_in, bit_in, 0, 0, bit_in->width, bit_in->height);
+  n_words = ho_bitmap_view_get_n_words (&v_in);
+
+  ho_objmap_labels_init (&l);
+  row = (uint64_t *) malloc ((n_words + 1) * sizeof (uint64_t));
+  allocated_runs = n_words * 32 + 1024;
+  runs = (ho_objmap_run *) malloc (allocated_runs * sizeof (ho_objmap_run));
+  if (!l.labels || !row || !runs)
+  {
+    if (l.labels)
+      free (l.labels);
+    if (row)
+      free (row);
+    if (runs)
+      free (runs);
+    ho_objmap_free (m_new);
+    return NULL;
+  }
+
+  /* 
+   * label runs row by row, a run touching a run in the row above (also 
+   * diagonally) joins its label, the first and last rows are not labeled 
+   */
+  n_runs = 0;
+  for (y = 1; y < bit_in->height - 1 && n_words && !failed; y++)
+  {
+    /* make room for a full row of runs */
+    if (n_runs + n_words * 32 + 1 > allocated_runs)
+    {
+      allocated_runs = 2 * allocated_runs + n_words * 32;
+      runs_temp = (ho_objmap_run *) realloc (runs,
+        allocated_runs * sizeof (ho_objmap_run));
+      if (!runs_temp)
+      {
+        failed = TRUE;
+        break;
+      }
+      runs = runs_temp;
+    }
+
+    ho_bitmap_view_get_row_words (&v_in, y, row);
+    here = n_runs;
+    n_runs += ho_objmap_runs_from_row (row, n_words, runs + here);
+    m_new->row_runs[y + 1] = n_runs;
+
+    j = m_new->row_runs[y - 1];
+    above_end = m_new->row_runs[y];
+    for (i = here; i < n_runs; i++)
+    {
+      /* skip runs above that end left of this run */
+      while (j < above_end && runs[j].end < runs[i].start)
+        j++;
+
+      runs[i].label = -1;
+      for (k = j; k < above_end && runs[k].start <= runs[i].end; k++)
+      {
+        if (runs[i].label < 0)
+          runs[i].label = runs[k].label;
+        else
+          ho_objmap_labels_union (l.labels, runs[i].label, runs[k].label);
+      }
+
+      /* new label, first is the pixel place in column major order */
+      first = runs[i].start * m_new->height + y;
+      if (runs[i].label < 0)
+      {
+        runs[i].label = ho_objmap_labels_add (&l, runs[i].start, y, first);
+        if (runs[i].label < 0)
+        {
+          failed = TRUE;
+          break;
         }
       }
+
+      /* update label statistics */
+      label = l.labels + runs[i].label;
+      if (shapes)
+        ho_objmap_label_add_run_shape (label, runs + i, runs + j,
+          above_end - j, y);
+      label->weight += runs[i].end - runs[i].start;
+      if (label->x1 > runs[i].start)
+        label->x1 = runs[i].start;
+      if (label->x2 < runs[i].end - 1)
+        label->x2 = runs[i].end - 1;
+      if (label->y2 < y)
+        label->y2 = y;
+      if (label->first > first)
+        label->first = first;
     }
+  }
+
+  /* rows that were not labeled have no runs */
+  for (; y < bit_in->height; y++)
+    m_new->row_runs[y + 1] = n_runs;
 
-  /* relax and clean the objmap */
-  ho_objmap_clean (m_new);
+  free (row);
+
+  final = NULL;
+  if (failed || !(final = ho_objmap_labels_resolve (m_new, &l, shapes)))
+  {
+    free (runs);
+    free (l.labels);
+    ho_objmap_free (m_new);
+    return NULL;
+  }
+
+  /* runs are labeled like the map, objects are 1.. */
+  for (i = 0; i < n_runs; i++)
+    runs[i].label = final[runs[i].label] + 1;
+
+  /* trim the runs to size */
+  runs_temp = (ho_objmap_run *) realloc (runs,
+    (n_runs + 1) * sizeof (ho_objmap_run));
+  m_new->runs = (runs_temp) ? runs_temp : runs;
+
+  free (final);
+  free (l.labels);
 
   return m_new;
 }
 
+ho_objmap *
+ho_objmap_new_from_bitmap_runs (const ho_bitmap * bit_in)
+{
+  return ho_objmap_new_from_bitmap_runs_labels (bit_in, FALSE);
+}
+
+ho_objmap *
+ho_objmap_new_from_bitmap_shapes (const ho_bitmap * bit_in)
+{
+  return ho_objmap_new_from_bitmap_runs_labels (bit_in, TRUE);
+}
+
 int
-ho_objmap_font_metrix (const ho_objmap * m, const int min_height,
+ho_objlist_font_metrix (ho_objlist * object_list, const int min_height,
   const int max_height,
   const int min_width,
   const int max_width, int *height, int *width, unsigned char *nikud)
@@ -756,7 +1649,7 @@ ho_objmap_font_metrix (const ho_objmap * m, const int min_height,
   *nikud = FALSE;
 
   /* get stats */
-  ho_objlist_statistics (m->obj_list,
+  ho_objlist_statistics (object_list,
     min_height, max_height,
     min_width, max_width,
     &counter,
@@ -777,7 +1670,7 @@ ho_objmap_font_metrix (const ho_objmap * m, const int min_height,
     *nikud = TRUE;
 
     /* re-get stats, now limit minial size */
-    ho_objlist_statistics (m->obj_list, 3 * height_avg / 2, 300,
+    ho_objlist_statistics (object_list, 3 * height_avg / 2, 300,
       3 * width_avg / 2, 300, &counter,
       &weight_avg, &weight_com, &weight_min,
       &weight_max, &height_avg, &height_com,
@@ -794,6 +1687,16 @@ ho_objmap_font_metrix (const ho_objmap * m, const int min_height,
   return FALSE;
 }
 
+int
+ho_objmap_font_metrix (const ho_objmap * m, const int min_height,
+  const int max_height,
+  const int min_width,
+  const int max_width, int *height, int *width, unsigned char *nikud)
+{
+  return ho_objlist_font_metrix (m->obj_list, min_height, max_height,
+    min_width, max_width, height, width, nikud);
+}
+
 ho_bitmap *
 ho_objmap_to_bitmap (const ho_objmap * obj_in)
 {
@@ -801,6 +1704,10 @@ ho_objmap_to_bitmap (const ho_objmap * obj_in)
   ho_bitmap *pix = NULL;
   int index = 0;
 
+  /* objmaps made by the run labeller have no map */
+  if (!obj_in->map)
+    return NULL;
+
   /* allocate memory */
   pix = ho_bitmap_new (obj_in->width, obj_in->height);
   if (!pix)
@@ -822,16 +1729,162 @@ ho_objmap_to_bitmap (const ho_objmap * obj_in)
   return pix;
 }
 
+/* 
+ * draw the runs of kept objects on m_out row by row, keep is indexed like
+ * the object list 
+ */
+static int
+ho_objmap_runs_to_bitmap (const ho_objmap * m, ho_bitmap * m_out,
+  const unsigned char *keep)
+{
+  ho_objmap_run *run;
+  uint64_t *row;
+  int n_words;
+  int y, i, x;
+
+  n_words = (m->width + 63) / 64;
+  row = (uint64_t *) malloc ((n_words + 1) * sizeof (uint64_t));
+  if (!row)
+    return TRUE;
+
+  for (y = 0; y < m->height; y++)
+  {
+    /* empty rows are already white */
+    if (m->row_runs[y] == m->row_runs[y + 1])
+      continue;
+
+    memset (row, 0, (n_words + 1) * sizeof (uint64_t));
+    for (i = m->row_runs[y]; i < m->row_runs[y + 1]; i++)
+    {
+      run = m->runs + i;
+
+      /* on runs objects are 1.. and on objlist 0.. */
+      if (!keep[run->label - 1])
+        continue;
+
+      for (x = run->start; x < run->end && x % 64; x++)
+        row[x / 64] |= (uint64_t) 1 << (63 - x % 64);
+      for (; x + 64 <= run->end; x += 64)
+        row[x / 64] = ~(uint64_t) 0;
+      for (; x < run->end; x++)
+        row[x / 64] |= (uint64_t) 1 << (63 - x % 64);
+    }
+
+    ho_bitmap_set_row_words (m_out, y, row);
+  }
+
+  free (row);
+
+  return FALSE;
+}
+
+/** @struct ho_objmap_size_limits
+  @brief object size limits for ho_objmap_keep_by_size
+*/
+typedef struct
+{
+  int min_height;
+  int max_height;
+  int min_width;
+  int max_width;
+} ho_objmap_size_limits;
+
+static int
+ho_objmap_keep_by_size (const ho_obj * object, void *user_data)
+{
+  ho_objmap_size_limits *limits = (ho_objmap_size_limits *) user_data;
+
+  return !(object->width < limits->min_width
+    || object->width > limits->max_width
+    || object->height < limits->min_height
+    || object->height > limits->max_height);
+}
+
+/* 
+ * draw the runs of objects that pass keep on a new bitmap 
+ */
+static ho_bitmap *
+ho_objmap_runs_to_bitmap_by_filter (const ho_objmap * m,
+  ho_objmap_filter_func keep, void *user_data)
+{
+  ho_bitmap *m_out;
+  unsigned char *kept;
+  int i;
+
+  /* allocate memory */
+  m_out = ho_bitmap_new (m->width, m->height);
+  kept = (unsigned char *) malloc ((m->obj_list)->size + 1);
+  if (!m_out || !kept)
+  {
+    if (m_out)
+      ho_bitmap_free (m_out);
+    if (kept)
+      free (kept);
+    return NULL;
+  }
+
+  m_out->x = m->x;
+  m_out->y = m->y;
+
+  for (i = 0; i < (m->obj_list)->size; i++)
+    kept[i] = keep (((m->obj_list)->objects) + i, user_data) ? 1 : 0;
+
+  if (ho_objmap_runs_to_bitmap (m, m_out, kept))
+  {
+    ho_bitmap_free (m_out);
+    m_out = NULL;
+  }
+
+  free (kept);
+
+  return m_out;
+}
+
+ho_bitmap *
+ho_objmap_filter_bitmap (const ho_bitmap * bit_in,
+  ho_objmap_filter_func keep, void *user_data)
+{
+  ho_objmap *m_obj;
+  ho_bitmap *m_out;
+
+  /* label once, as runs */
+  m_obj = ho_objmap_new_from_bitmap_runs (bit_in);
+  if (!m_obj)
+    return NULL;
+
+  m_out = ho_objmap_runs_to_bitmap_by_filter (m_obj, keep, user_data);
+
+  ho_objmap_free (m_obj);
+
+  return m_out;
+}
+
 ho_bitmap *
 ho_objmap_to_bitmap_by_size (const ho_objmap * m,
   int min_height, int max_height, int min_width, int max_width)
 {
+  ho_objmap_size_limits limits;
   int x, y;
   int index;
   int height;
   int width;
   ho_bitmap *m_out;
 
+  /* objmaps made by the run labeller have only runs */
+  if (!m->map && !m->runs)
+    return NULL;
+
+  if (!m->map)
+  {
+    limits.min_height = min_height;
+    limits.max_height = max_height;
+    limits.min_width = min_width;
+    limits.max_width = max_width;
+
+    return ho_objmap_runs_to_bitmap_by_filter (m, ho_objmap_keep_by_size,
+      &limits);
+  }
+
   /* allocate memory */
   m_out = ho_bitmap_new (m->width, m->height);
   if (!m_out)
@@ -873,6 +1926,10 @@ ho_objmap_to_bitmap_by_index (const ho_objmap * m, const int index)
   int height;
   int width;
 
+  /* objmaps made by the run labeller have no map */
+  if (!m->map)
+    return NULL;
+
   /* is this object realy an object ? */
   if (index >= (m->obj_list)->size)
     return NULL;
@@ -910,13 +1967,17 @@ ho_bitmap *
 ho_objmap_to_bitmap_by_index_window (const ho_objmap * m,
   const int index, const int frame)
 {
-  int x, y;
+  int x, y, i;
   int x1, y1;
   ho_bitmap *m_out;
   int current_index;
   int height;
   int width;
 
+  /* objmaps made by the run labeller have only runs */
+  if (!m->map && !m->runs)
+    return NULL;
+
   /* is this object realy an object ? */
   if (index >= (m->obj_list)->size)
     return NULL;
@@ -939,6 +2000,18 @@ ho_objmap_to_bitmap_by_index_window (const ho_objmap * m,
   m_out->x = m->x + x1 - frame;
   m_out->y = m->y + y1 - frame;
 
+  /* copy the object runs */
+  if (!m->map)
+  {
+    for (y = y1; y < y1 + height; y++)
+      for (i = m->row_runs[y]; i < m->row_runs[y + 1]; i++)
+        if ((m->runs)[i].label - 1 == index)
+          ho_bitmap_draw_hline (m_out, (m->runs)[i].start - x1 + frame,
+            y - y1 + frame, (m->runs)[i].end - (m->runs)[i].start);
+
+    return m_out;
+  }
+
   for (x = 0; x < width; x++)
     for (y = 0; y < height; y++)
     {
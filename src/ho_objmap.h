@@ -40,11 +40,40 @@
 #define ho_objmap_get_size(m) ((m)->obj_list->size)
 #define ho_objmap_get_object(m,i) ((m)->obj_list->objects[(i)])
 
+#define ho_obj_get_centroid_x(o) ((o)->shape.sum_x / (o)->weight)
+#define ho_obj_get_centroid_y(o) ((o)->shape.sum_y / (o)->weight)
+#define ho_obj_get_holes(o) (1 - (o)->shape.euler)
+
 #define ho_objmap_get_width(m) ((m)->width)
 #define ho_objmap_get_height(m) ((m)->height)
 
+/** @struct ho_obj_shape
+  @brief libhocr object shape statistics
+  
+  sums of pixel cordinates for moments, perimeter is the count of black to
+  white pixel edges, euler is 1 - number of holes. top_x is the left most
+  pixel on the top row, bottom_x on the bottom row, left_y is the top most
+  pixel on the left column and right_y on the right column. cordinates are
+  in the objmap, like x and y of ho_obj
+*/
+typedef struct
+{
+  double sum_x;
+  double sum_y;
+  double sum_xx;
+  double sum_yy;
+  double sum_xy;
+  int perimeter;
+  int euler;
+  int top_x;
+  int bottom_x;
+  int left_y;
+  int right_y;
+} ho_obj_shape;
+
 /** @struct ho_obj
-  @brief libhocr object struct
+  @brief libhocr object struct, shape is set only by 
+  ho_objmap_new_from_bitmap_shapes
 */
 typedef struct
 {
@@ -55,6 +84,7 @@ typedef struct
   int y;
   int width;
   int height;
+  ho_obj_shape shape;
 } ho_obj;
 
 /** @struct ho_objlist
@@ -67,8 +97,22 @@ typedef struct
   ho_obj *objects;
 } ho_objlist;
 
+/** @struct ho_objmap_run
+  @brief libhocr horizontal run of object pixels, end is exclusive
+*/
+typedef struct
+{
+  int start;
+  int end;
+  int label;
+} ho_objmap_run;
+
 /** @struct ho_objmap
   @brief libhocr object map struct
+  
+  objects are stored in map, one label per pixel, or as runs, the runs of
+  row y are runs[row_runs[y]] .. runs[row_runs[y + 1] - 1], unused storage
+  is NULL
 */
 typedef struct
 {
@@ -77,9 +121,19 @@ typedef struct
   int height;
   int width;
   int *map;
+  ho_objmap_run *runs;
+  int *row_runs;
   ho_objlist *obj_list;
 } ho_objmap;
 
+/**
+ test an object, used by ho_objmap_filter_bitmap
+ @param object pointer to the tested object
+ @param user_data data given to ho_objmap_filter_bitmap
+ @return TRUE to keep the object
+ */
+typedef int (*ho_objmap_filter_func) (const ho_obj * object, void *user_data);
+
 ho_objlist *ho_objlist_new ();
 
 int ho_objlist_free (ho_objlist * object_list);
@@ -152,6 +206,72 @@ int ho_objmap_sort_by_reading_index (ho_objmap * m, const unsigned char col,
  */
 ho_objmap *ho_objmap_new_from_bitmap (const ho_bitmap * bit_in);
 
+/**
+ new ho_objmap from a window of an ho_bitmap
+ @param bit_in pointer to an ho_bitmap_view window
+ @return newly allocated ho_objmap
+ */
+ho_objmap *ho_objmap_new_from_bitmap_view (const ho_bitmap_view * bit_in);
+
+/**
+ new ho_objmap from ho_bitmap, label horizontal stripes of the bitmap on
+ separate threads. the result is the same as ho_objmap_new_from_bitmap,
+ without pthreads support this is ho_objmap_new_from_bitmap
+ @param bit_in pointer to an ho_bitmap image
+ @param n_threads number of threads to use, 0 or 1 for one thread
+ @return newly allocated ho_objmap
+ */
+ho_objmap *ho_objmap_new_from_bitmap_threads (const ho_bitmap * bit_in,
+  const int n_threads);
+
+/**
+ new ho_objmap from ho_bitmap, labels runs of black pixels instead of
+ single pixels. the objects are the same as in ho_objmap_new_from_bitmap
+ but the map is not allocated (NULL), labels are stored as runs, use it
+ when only the object list or ho_objmap_to_bitmap_by_size and
+ ho_objmap_to_bitmap_by_index_window are needed
+ @param bit_in pointer to an ho_bitmap image
+ @return newly allocated ho_objmap
+ */
+ho_objmap *ho_objmap_new_from_bitmap_runs (const ho_bitmap * bit_in);
+
+/**
+ new ho_objmap from ho_bitmap, like ho_objmap_new_from_bitmap_runs and
+ also gather the shape statistics of the objects in the same pass
+ @param bit_in pointer to an ho_bitmap image
+ @return newly allocated ho_objmap
+ */
+ho_objmap *ho_objmap_new_from_bitmap_shapes (const ho_bitmap * bit_in);
+
+/**
+ new ho_bitmap of the objects of bit_in that pass keep. objects are labeled
+ once as runs and the kept runs are drawn to the new bitmap, no ho_objmap
+ is left
+ @param bit_in pointer to an ho_bitmap image
+ @param keep function that returns TRUE for objects to copy
+ @param user_data data passed to keep
+ @return newly allocated ho_bitmap
+ */
+ho_bitmap *ho_objmap_filter_bitmap (const ho_bitmap * bit_in,
+  ho_objmap_filter_func keep, void *user_data);
+
+/**
+ guess font metrics
+ @param object_list pointer to an ho_objlist
+ @param min_height only objects with this minimal height are used
+ @param max_height only objects with this maximal height are used
+ @param min_width only objects with this minimal width are used
+ @param max_width only objects with this maximal width are used
+ @param height pointer to return the guessed font average  height
+ @param width pointer to return the guessed font average  width
+ @param nikud pointer to return the guessed nikud in page
+ @return FALSE
+ */
+int ho_objlist_font_metrix (ho_objlist * object_list, const int min_height,
+  const int max_height,
+  const int min_width,
+  const int max_width, int *height, int *width, unsigned char *nikud);
+
 /**
  guess font metrics
  @param m pointer to an ho_objmap
@@ -25,11 +25,32 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include <stdint.h>
+
+/* sse2 row packing, selected at run time */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HO_PIXBUF_X86 1
+#include <emmintrin.h>
+#endif
+
+/* memory mapped pnm files */
+#if defined(__unix__) || defined(__APPLE__)
+#define HO_PIXBUF_MMAP 1
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #ifdef USE_TIFF
 #include <tiffio.h>
 #endif
 
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+
 #include "hebocr_globals.h"
 #include "ho_bitmap.h"
 #include "ho_pixbuf.h"
@@ -63,6 +84,8 @@ ho_pixbuf* ho_pixbuf_new( int n_channels, int width, int height, int rowstride )
    * read header 
    */
   pix->n_channels = n_channels;
+  pix->map = NULL;
+  pix->map_size = 0;
   pix->width = width;
   pix->height = height;
   if (rowstride)
@@ -204,6 +227,10 @@ ho_pixbuf_new_from_objmap (const ho_objmap * obj_in, const unsigned char min,
   ho_pixbuf *pix = NULL;
   int index = 0;
 
+  /* objmaps made by the run labeller have no map */
+  if (!obj_in->map)
+    return NULL;
+
   /* allocate memory */
   pix = ho_pixbuf_new (3, obj_in->width, obj_in->height, 0);
   if (!pix)
@@ -358,13 +385,86 @@ ho_pixbuf_to_rgb (const ho_pixbuf * pix_in)
   return pix;
 }
 
+/* 
+ * read a whole file to memory, mapped when possible 
+ */
+static unsigned char *
+ho_pixbuf_map_file (const char *filename, size_t * size)
+{
+  unsigned char *data = NULL;
+#ifdef HO_PIXBUF_MMAP
+  struct stat file_stat;
+  void *map;
+  int fd;
+
+  fd = open (filename, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  if (fstat (fd, &file_stat) || !S_ISREG (file_stat.st_mode)
+    || file_stat.st_size <= 0)
+  {
+    close (fd);
+    return NULL;
+  }
+
+  *size = (size_t) file_stat.st_size;
+  map = mmap (NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    return NULL;
+
+  /* we read the file from start to end */
+  madvise (map, *size, MADV_SEQUENTIAL);
+
+  data = (unsigned char *) map;
+#else
+  FILE *file;
+  long file_size;
+
+  file = fopen (filename, "rb");
+  if (!file)
+    return NULL;
+
+  if (fseek (file, 0, SEEK_END) || (file_size = ftell (file)) <= 0)
+  {
+    fclose (file);
+    return NULL;
+  }
+  rewind (file);
+
+  *size = (size_t) file_size;
+  data = (unsigned char *) malloc (*size);
+  if (data && fread (data, 1, *size, file) != *size)
+  {
+    free (data);
+    data = NULL;
+  }
+  fclose (file);
+#endif
+
+  return data;
+}
+
+static void
+ho_pixbuf_unmap_file (unsigned char *data, size_t size)
+{
+#ifdef HO_PIXBUF_MMAP
+  munmap (data, size);
+#else
+  free (data);
+#endif
+}
+
 int
 ho_pixbuf_free (ho_pixbuf * pix)
 {
   if (!pix)
     return TRUE;
 
-  if (pix->data)
+  if (pix->map)
+    ho_pixbuf_unmap_file (pix->map, pix->map_size);
+  else if (pix->data)
     free (pix->data);
 
   free (pix);
@@ -632,6 +732,330 @@ ho_pixbuf_scale (const ho_pixbuf * pix, const unsigned char scale)
   return NULL;
 }
 
+/* 
+ * separable resampling by any rational factor: each output pixel is a 
+ * tent weighted sum of its input neighbors, the tent is one input pixel 
+ * wide when scaling up and one output pixel wide when scaling down 
+ */
+
+/* fixed point fraction bits of resampling weights */
+#define HO_PIXBUF_RESAMPLE_BITS 14
+
+typedef struct
+{
+  int n_taps;
+  int *starts;
+  short *weights;
+} ho_pixbuf_resample_kernel;
+
+static void
+ho_pixbuf_resample_kernel_free (ho_pixbuf_resample_kernel * kernel)
+{
+  if (!kernel)
+    return;
+
+  if (kernel->starts)
+    free (kernel->starts);
+  if (kernel->weights)
+    free (kernel->weights);
+  free (kernel);
+}
+
+/* 
+ * weights for scaling in_size pixels to out_size pixels 
+ */
+static ho_pixbuf_resample_kernel *
+ho_pixbuf_resample_kernel_new (const int in_size, const int out_size)
+{
+  ho_pixbuf_resample_kernel *kernel;
+  double scale, radius, center, sum;
+  double *taps;
+  short *weights;
+  int i, j, k, lo, start, total, max_k;
+
+  kernel = (ho_pixbuf_resample_kernel *)
+    calloc (1, sizeof (ho_pixbuf_resample_kernel));
+  if (!kernel)
+    return NULL;
+
+  scale = (double) out_size / (double) in_size;
+  radius = (scale < 1.0) ? 1.0 / scale : 1.0;
+  kernel->n_taps = 2 * (int) ceil (radius) + 1;
+  if (kernel->n_taps > in_size)
+    kernel->n_taps = in_size;
+
+  kernel->starts = (int *) malloc (out_size * sizeof (int));
+  kernel->weights =
+    (short *) malloc (out_size * kernel->n_taps * sizeof (short));
+  taps = (double *) malloc (kernel->n_taps * sizeof (double));
+  if (!kernel->starts || !kernel->weights || !taps)
+  {
+    if (taps)
+      free (taps);
+    ho_pixbuf_resample_kernel_free (kernel);
+    return NULL;
+  }
+
+  for (i = 0; i < out_size; i++)
+  {
+    /* pixel centers of output and input are aligned */
+    center = (i + 0.5) / scale - 0.5;
+    lo = (int) floor (center - radius) + 1;
+
+    start = lo;
+    if (start > in_size - kernel->n_taps)
+      start = in_size - kernel->n_taps;
+    if (start < 0)
+      start = 0;
+    kernel->starts[i] = start;
+
+    /* taps outside the image fold onto the edge pixels */
+    for (k = 0; k < kernel->n_taps; k++)
+      taps[k] = 0.0;
+    sum = 0.0;
+    for (j = lo; j < lo + 2 * (int) ceil (radius) + 1; j++)
+    {
+      k = ((j < 0) ? 0 : ((j >= in_size) ? in_size - 1 : j)) - start;
+      if (k < 0 || k >= kernel->n_taps || fabs (j - center) >= radius)
+        continue;
+      taps[k] += 1.0 - fabs (j - center) / radius;
+      sum += 1.0 - fabs (j - center) / radius;
+    }
+
+    /* fixed point weights that sum to exactly one */
+    weights = kernel->weights + i * kernel->n_taps;
+    total = 0;
+    max_k = 0;
+    for (k = 0; k < kernel->n_taps; k++)
+    {
+      weights[k] =
+        (short) (taps[k] / sum * (1 << HO_PIXBUF_RESAMPLE_BITS) + 0.5);
+      total += weights[k];
+      if (weights[k] > weights[max_k])
+        max_k = k;
+    }
+    weights[max_k] += (1 << HO_PIXBUF_RESAMPLE_BITS) - total;
+  }
+
+  free (taps);
+
+  return kernel;
+}
+
+/* 
+ * resample one row along its length 
+ */
+static void
+ho_pixbuf_resample_row (unsigned char *out, const unsigned char *in,
+  const ho_pixbuf_resample_kernel * kernel, const int width)
+{
+  const short *weights;
+  const unsigned char *src;
+  int x, k, sum;
+
+  for (x = 0; x < width; x++)
+  {
+    weights = kernel->weights + x * kernel->n_taps;
+    src = in + kernel->starts[x];
+    sum = 1 << (HO_PIXBUF_RESAMPLE_BITS - 1);
+    for (k = 0; k < kernel->n_taps; k++)
+      sum += weights[k] * src[k];
+    out[x] = sum >> HO_PIXBUF_RESAMPLE_BITS;
+  }
+}
+
+/* 
+ * weighted sum of n_taps rows to one row, pixels x_start to width 
+ */
+
+typedef void (*ho_pixbuf_blend_func) (unsigned char *out,
+  const unsigned char **rows, const short *weights, const int n_taps,
+  const int x_start, const int width);
+
+static void
+ho_pixbuf_blend_rows_scalar (unsigned char *out, const unsigned char **rows,
+  const short *weights, const int n_taps, const int x_start, const int width)
+{
+  int x, k, sum;
+
+  for (x = x_start; x < width; x++)
+  {
+    sum = 1 << (HO_PIXBUF_RESAMPLE_BITS - 1);
+    for (k = 0; k < n_taps; k++)
+      sum += weights[k] * rows[k][x];
+    out[x] = sum >> HO_PIXBUF_RESAMPLE_BITS;
+  }
+}
+
+#ifdef HO_PIXBUF_X86
+
+__attribute__ ((target ("sse2")))
+static void
+ho_pixbuf_blend_rows_sse2 (unsigned char *out, const unsigned char **rows,
+  const short *weights, const int n_taps, const int x_start, const int width)
+{
+  __m128i zero = _mm_setzero_si128 ();
+  __m128i round = _mm_set1_epi32 (1 << (HO_PIXBUF_RESAMPLE_BITS - 1));
+  __m128i acc0, acc1, acc2, acc3;
+  __m128i a, b, lo_a, hi_a, lo_b, hi_b, w;
+  int x, k;
+
+  /* rows are taken in pairs, each 16 bit pixel pair times its weight 
+   * pair is one madd */
+  for (x = x_start; x + 16 <= width; x += 16)
+  {
+    acc0 = acc1 = acc2 = acc3 = round;
+    for (k = 0; k < n_taps; k += 2)
+    {
+      a = _mm_loadu_si128 ((const __m128i *) (rows[k] + x));
+      if (k + 1 < n_taps)
+      {
+        b = _mm_loadu_si128 ((const __m128i *) (rows[k + 1] + x));
+        w = _mm_set1_epi32 ((int) (((unsigned int) (unsigned short)
+                weights[k + 1] << 16) | (unsigned short) weights[k]));
+      }
+      else
+      {
+        b = zero;
+        w = _mm_set1_epi32 ((unsigned short) weights[k]);
+      }
+
+      lo_a = _mm_unpacklo_epi8 (a, zero);
+      hi_a = _mm_unpackhi_epi8 (a, zero);
+      lo_b = _mm_unpacklo_epi8 (b, zero);
+      hi_b = _mm_unpackhi_epi8 (b, zero);
+
+      acc0 = _mm_add_epi32 (acc0,
+        _mm_madd_epi16 (_mm_unpacklo_epi16 (lo_a, lo_b), w));
+      acc1 = _mm_add_epi32 (acc1,
+        _mm_madd_epi16 (_mm_unpackhi_epi16 (lo_a, lo_b), w));
+      acc2 = _mm_add_epi32 (acc2,
+        _mm_madd_epi16 (_mm_unpacklo_epi16 (hi_a, hi_b), w));
+      acc3 = _mm_add_epi32 (acc3,
+        _mm_madd_epi16 (_mm_unpackhi_epi16 (hi_a, hi_b), w));
+    }
+
+    acc0 = _mm_srai_epi32 (acc0, HO_PIXBUF_RESAMPLE_BITS);
+    acc1 = _mm_srai_epi32 (acc1, HO_PIXBUF_RESAMPLE_BITS);
+    acc2 = _mm_srai_epi32 (acc2, HO_PIXBUF_RESAMPLE_BITS);
+    acc3 = _mm_srai_epi32 (acc3, HO_PIXBUF_RESAMPLE_BITS);
+    _mm_storeu_si128 ((__m128i *) (out + x),
+      _mm_packus_epi16 (_mm_packs_epi32 (acc0, acc1),
+        _mm_packs_epi32 (acc2, acc3)));
+  }
+
+  /* the last pixels */
+  ho_pixbuf_blend_rows_scalar (out, rows, weights, n_taps, x, width);
+}
+
+#endif /* HO_PIXBUF_X86 */
+
+/* implementation used by ho_pixbuf_blend_rows, it is selected once when
+ * the library is loaded, so threads only read it */
+static ho_pixbuf_blend_func ho_pixbuf_blend_func_selected =
+  ho_pixbuf_blend_rows_scalar;
+
+#ifdef HO_PIXBUF_X86
+
+static void __attribute__ ((constructor))
+ho_pixbuf_blend_select (void)
+{
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("sse2"))
+    ho_pixbuf_blend_func_selected = ho_pixbuf_blend_rows_sse2;
+}
+
+#endif /* HO_PIXBUF_X86 */
+
+static void
+ho_pixbuf_blend_rows (unsigned char *out, const unsigned char **rows,
+  const short *weights, const int n_taps, const int width)
+{
+  ho_pixbuf_blend_func_selected (out, rows, weights, n_taps, 0, width);
+}
+
+ho_pixbuf *
+ho_pixbuf_resample (const ho_pixbuf * pix, const int num, const int den)
+{
+  ho_pixbuf *pix_out = NULL;
+  ho_pixbuf_resample_kernel *kernel_x = NULL;
+  ho_pixbuf_resample_kernel *kernel_y = NULL;
+  unsigned char *cache = NULL;
+  int *cache_rows = NULL;
+  const unsigned char **rows = NULL;
+  int width, height;
+  int y, k, row, slot;
+
+  /* is input sane ? */
+  if (pix->n_channels != 1 || num < 1 || den < 1)
+    return NULL;
+
+  width = (int) (((long long) pix->width * num + den / 2) / den);
+  height = (int) (((long long) pix->height * num + den / 2) / den);
+  if (width < 1)
+    width = 1;
+  if (height < 1)
+    height = 1;
+
+  /* allocate memory */
+  pix_out = ho_pixbuf_new (1, width, height, 0);
+  kernel_x = ho_pixbuf_resample_kernel_new (pix->width, width);
+  kernel_y = ho_pixbuf_resample_kernel_new (pix->height, height);
+  if (pix_out && kernel_x && kernel_y)
+  {
+    /* input rows resampled along x, one slot per vertical tap */
+    cache = (unsigned char *) malloc (kernel_y->n_taps * width);
+    cache_rows = (int *) malloc (kernel_y->n_taps * sizeof (int));
+    rows = (const unsigned char **) malloc (kernel_y->n_taps *
+      sizeof (unsigned char *));
+  }
+  if (!cache || !cache_rows || !rows)
+  {
+    if (pix_out)
+      ho_pixbuf_free (pix_out);
+    ho_pixbuf_resample_kernel_free (kernel_x);
+    ho_pixbuf_resample_kernel_free (kernel_y);
+    if (cache)
+      free (cache);
+    if (cache_rows)
+      free (cache_rows);
+    if (rows)
+      free (rows);
+    return NULL;
+  }
+
+  for (k = 0; k < kernel_y->n_taps; k++)
+    cache_rows[k] = -1;
+
+  for (y = 0; y < height; y++)
+  {
+    /* the window moves down, each input row is resampled once */
+    for (k = 0; k < kernel_y->n_taps; k++)
+    {
+      row = kernel_y->starts[y] + k;
+      slot = row % kernel_y->n_taps;
+      if (cache_rows[slot] != row)
+      {
+        ho_pixbuf_resample_row (cache + slot * width,
+          pix->data + row * pix->rowstride, kernel_x, width);
+        cache_rows[slot] = row;
+      }
+      rows[k] = cache + slot * width;
+    }
+
+    ho_pixbuf_blend_rows (pix_out->data + y * pix_out->rowstride, rows,
+      kernel_y->weights + y * kernel_y->n_taps, kernel_y->n_taps, width);
+  }
+
+  ho_pixbuf_resample_kernel_free (kernel_x);
+  ho_pixbuf_resample_kernel_free (kernel_y);
+  free (cache);
+  free (cache_rows);
+  free (rows);
+
+  return pix_out;
+}
+
 unsigned char
 ho_pixbuf_minmax (const ho_pixbuf * pix, unsigned char *min, unsigned char *max)
 {
@@ -644,8 +1068,8 @@ ho_pixbuf_minmax (const ho_pixbuf * pix, unsigned char *min, unsigned char *max)
   if (pix->n_channels != 1)
     return TRUE;
 
-  for (x = 0; x < pix->width; x++)
-    for (y = 0; y < pix->height; y++)
+  for (y = 0; y < pix->height; y++)
+    for (x = 0; x < pix->width; x++)
     {
       if (*min > (pix->data)[x + y * pix->rowstride])
         *min = (pix->data)[x + y * pix->rowstride];
@@ -967,131 +1391,968 @@ ho_pixbuf_to_bitmap_adaptive_fine (const ho_pixbuf * pix,
   return m_out;
 }
 
-/**
- convert a color of gray pixbuf to bitmap wrapper function
- @param pix_in the input ho_pixbuf
- @param image_options configuration options. Used items are: scale, adaptive, threshold, a_treshold
- @param size kernel size to use for adaptive thresholding
- @return newly allocated b/w ho_bitmap
+/* 
+ * gray rows of a pixbuf made on demand: rows are converted to gray and
+ * scaled one at a time, only the last n_slots rows of each stage are kept
  */
-ho_bitmap* ho_pixbuf_to_bitmap_wrapper( const ho_pixbuf* pix_in, HEBOCR_IMAGE_OPTIONS* image_options, size_t size )
-{
-  ho_pixbuf *pix = NULL;
-  ho_pixbuf *pix_temp = NULL;
-  ho_bitmap *m_bw = NULL;
 
-  /* if pix is color convert to gray scale */
-  if (pix_in->n_channels > 1)
-    pix = ho_pixbuf_color_to_gray(pix_in);
-  else
-    pix = ho_pixbuf_clone(pix_in);
+/** @struct ho_pixbuf_rows
+  @brief one stage of a row pipeline, the input pixbuf or a scale step
+*/
+typedef struct ho_pixbuf_rows_s
+{
+  const ho_pixbuf *pix;
+  struct ho_pixbuf_rows_s *source;
+  int factor;
+  int width;
+  int height;
+  int n_slots;
+  unsigned char *slots;
+  int *slot_rows;
+} ho_pixbuf_rows;
+
+static void
+ho_pixbuf_rows_free (ho_pixbuf_rows * rows)
+{
+  if (!rows)
+    return;
+
+  ho_pixbuf_rows_free (rows->source);
+  if (rows->slots)
+    free (rows->slots);
+  if (rows->slot_rows)
+    free (rows->slot_rows);
+  free (rows);
+}
 
-  if (!pix)
-    return NULL;
+/* 
+ * new stage, reading pix if source is NULL or scaling source by factor 
+ */
+static ho_pixbuf_rows *
+ho_pixbuf_rows_stage_new (const ho_pixbuf * pix, ho_pixbuf_rows * source,
+  const int factor, const int n_slots)
+{
+  ho_pixbuf_rows *rows;
+  int i;
 
-  /* streach picture grays */
-  pix_temp = ho_pixbuf_linear_filter(pix);
-  ho_pixbuf_free(pix);
-  if (!pix_temp)
+  rows = (ho_pixbuf_rows *) calloc (1, sizeof (ho_pixbuf_rows));
+  if (!rows)
     return NULL;
-  pix = pix_temp;
 
-  /* scale */
-  if (image_options->scale > 1)
+  rows->pix = pix;
+  rows->source = source;
+  rows->factor = factor;
+  if (source)
   {
-    pix_temp = ho_pixbuf_scale (pix, image_options->scale);
-    ho_pixbuf_free (pix);
-    if (!pix_temp)
-      return NULL;
-    pix = pix_temp;
+    rows->width = source->width * factor - factor;
+    rows->height = source->height * factor - factor;
   }
-
-  /* convert to b/w bitmap */
-  switch(image_options->adaptive)
+  else
   {
-  case 0:
-    m_bw = ho_pixbuf_to_bitmap_adaptive (pix, image_options->threshold, size, image_options->a_threshold);
-    break;
-  case 1:
-    m_bw = ho_pixbuf_to_bitmap (pix, image_options->threshold);
-    break;
-  case 2:
-    m_bw =
-      ho_pixbuf_to_bitmap_adaptive_fine (pix, image_options->threshold, size, image_options->a_threshold);
-    break;
-  default:
-    m_bw = ho_pixbuf_to_bitmap_adaptive (pix, image_options->threshold, size, image_options->a_threshold);
-    break;
+    rows->width = pix->width;
+    rows->height = pix->height;
   }
 
-  ho_pixbuf_free (pix);
+  /* gray input rows are read in place */
+  rows->n_slots = n_slots;
+  if (source || pix->n_channels != 1)
+  {
+    rows->slots = (unsigned char *) malloc (n_slots * rows->width + 1);
+    rows->slot_rows = (int *) malloc (n_slots * sizeof (int));
+    if (!rows->slots || !rows->slot_rows)
+    {
+      rows->source = NULL;
+      ho_pixbuf_rows_free (rows);
+      return NULL;
+    }
+    for (i = 0; i < n_slots; i++)
+      rows->slot_rows[i] = -1;
+  }
 
-  return m_bw;
+  return rows;
 }
 
-int
-ho_pixbuf_draw_bitmap (ho_pixbuf * m, const ho_bitmap * bit_in,
-  const unsigned char red, const unsigned char green,
-  const unsigned char blue, const unsigned char alpha)
+/* 
+ * new row pipeline of pix scaled like ho_pixbuf_scale, the last n_slots
+ * rows asked for stay valid 
+ */
+static ho_pixbuf_rows *
+ho_pixbuf_rows_new (const ho_pixbuf * pix, const unsigned char scale,
+  const int n_slots)
 {
-  int x, y;
-  unsigned char new_red;
-  unsigned char new_green;
-  unsigned char new_blue;
+  ho_pixbuf_rows *rows;
+  ho_pixbuf_rows *stage;
+  int factors[3];
+  int n_factors = 0;
+  int i;
 
-  /* check for bitmap origin, if this is a sub window draw at its origin */
-  if (bit_in->x != 0 || bit_in->y != 0 || m->width > bit_in->width
-    || m->height > bit_in->height)
-    ho_pixbuf_draw_bitmap_at (m, bit_in, bit_in->x, bit_in->y, red, green,
-      blue, alpha);
+  /* only gray or color input */
+  if (pix->n_channels != 1 && pix->n_channels < 3)
+    return NULL;
 
-  /* sanity check */
-  if (m->width != bit_in->width || m->height != bit_in->height)
-    return TRUE;
+  if (scale > 1)
+  {
+    /* is input sane ? */
+    if (pix->width < 3 || pix->height < 3)
+      return NULL;
 
-  /* is pixbuf color ? */
-  if (m->n_channels < 3)
-  {                             /* gray scale */
-    for (x = 0; x < bit_in->width; x++)
-      for (y = 0; y < bit_in->height; y++)
-        if (ho_bitmap_get (bit_in, x, y))
-        {
-          new_red =
-            alpha * red / 255 + (255 - alpha) * ho_pixbuf_get (m, x, y,
-            0) / 255;
-          ho_pixbuf_set (m, x, y, 0, new_red);
-        }
+    if (scale == 3)
+      factors[n_factors++] = 3;
+    else
+    {
+      factors[n_factors++] = 2;
+      if (scale > 3)
+        factors[n_factors++] = 2;
+      if (scale > 4)
+        factors[n_factors++] = 2;
+    }
   }
-  else
-  {                             /* color */
-    for (x = 0; x < bit_in->width; x++)
-      for (y = 0; y < bit_in->height; y++)
-        if (ho_bitmap_get (bit_in, x, y))
-        {
-          new_red =
-            alpha * red / 255 + (255 - alpha) * ho_pixbuf_get (m, x, y,
-            0) / 255;
-          new_green =
-            alpha * green / 255 + (255 - alpha) * ho_pixbuf_get (m, x, y,
-            1) / 255;
-          new_blue =
-            alpha * blue / 255 + (255 - alpha) * ho_pixbuf_get (m, x, y,
-            2) / 255;
 
-          ho_pixbuf_set (m, x, y, 0, new_red);
-          ho_pixbuf_set (m, x, y, 1, new_green);
-          ho_pixbuf_set (m, x, y, 2, new_blue);
-        }
+  rows = ho_pixbuf_rows_stage_new (pix, NULL, 1, (n_factors) ? 2 : n_slots);
+  for (i = 0; rows && i < n_factors; i++)
+  {
+    stage = ho_pixbuf_rows_stage_new (NULL, rows, factors[i],
+      (i == n_factors - 1) ? n_slots : 2);
+    if (!stage)
+      ho_pixbuf_rows_free (rows);
+    rows = stage;
   }
 
-  return FALSE;
+  return rows;
 }
 
-int
-ho_pixbuf_draw_bitmap_at (ho_pixbuf * m, const ho_bitmap * bit_in,
-  const int x1, const int y1,
-  const unsigned char red, const unsigned char green,
-  const unsigned char blue, const unsigned char alpha)
+/* 
+ * scale one row, same as ho_pixbuf_scale2 and ho_pixbuf_scale3 
+ */
+static void
+ho_pixbuf_rows_scale (unsigned char *out, const unsigned char *up,
+  const unsigned char *down, const int width, const int factor,
+  const int phase)
+{
+  int x;
+  int n0, n1, n2, n3;
+
+  for (x = 0; x < width - 1; x++)
+  {
+    n0 = up[x];
+    n1 = up[x + 1];
+    n2 = down[x];
+    n3 = down[x + 1];
+
+    if (factor == 2)
+    {
+      if (phase == 0)
+      {
+        out[x * 2] = n0;
+        out[x * 2 + 1] = (n0 + n1) / 2;
+      }
+      else
+      {
+        out[x * 2] = (n0 + n2) / 2;
+        out[x * 2 + 1] = (n0 + n1 + n2 + n3) / 4;
+      }
+    }
+    else if (phase == 0)
+    {
+      out[x * 3] = n0;
+      out[x * 3 + 1] = (n0 * 2 + n1) / 3;
+      out[x * 3 + 2] = (n0 + n1 * 2) / 3;
+    }
+    else if (phase == 1)
+    {
+      out[x * 3] = (n0 * 2 + n2) / 3;
+      out[x * 3 + 1] = (n0 * 3 + n1 + n2 + n3) / 6;
+      out[x * 3 + 2] = (n0 + n1 * 3 + n2 + n3) / 6;
+    }
+    else
+    {
+      out[x * 3] = (n0 + n2 * 2) / 3;
+      out[x * 3 + 1] = (n0 + n1 + n2 * 3 + n3) / 6;
+      out[x * 3 + 2] = (n0 + n1 + n2 + n3 * 3) / 6;
+    }
+  }
+}
+
+/* 
+ * get gray row y of a stage 
+ */
+static const unsigned char *
+ho_pixbuf_rows_get (ho_pixbuf_rows * rows, const int y)
+{
+  const ho_pixbuf *pix = rows->pix;
+  const unsigned char *in;
+  const unsigned char *up;
+  const unsigned char *down;
+  unsigned char *out;
+  unsigned char max, min;
+  int slot;
+  int x, c;
+
+  /* gray input */
+  if (!rows->slots)
+    return pix->data + y * pix->rowstride;
+
+  slot = y % rows->n_slots;
+  out = rows->slots + slot * rows->width;
+  if (rows->slot_rows[slot] == y)
+    return out;
+  rows->slot_rows[slot] = y;
+
+  if (!rows->source)
+  {
+    /* color to gray, same as ho_pixbuf_color_to_gray */
+    in = pix->data + y * pix->rowstride;
+    for (x = 0; x < rows->width; x++, in += pix->n_channels)
+    {
+      max = min = in[0];
+      for (c = 1; c < 3; c++)
+      {
+        if (max < in[c])
+          max = in[c];
+        if (min > in[c])
+          min = in[c];
+      }
+      out[x] = (max + min) / 2;
+    }
+
+    return out;
+  }
+
+  /* both source rows stay valid, the source keeps two rows */
+  up = ho_pixbuf_rows_get (rows->source, y / rows->factor);
+  down = ho_pixbuf_rows_get (rows->source, y / rows->factor + 1);
+  ho_pixbuf_rows_scale (out, up, down, rows->source->width, rows->factor,
+    y % rows->factor);
+
+  return out;
+}
+
+/* 
+ * pack a gray row to bitmap bits, a pixel is black if it is darker then
+ * its threshold 
+ */
+
+typedef void (*ho_pixbuf_pack_func) (unsigned char *out,
+  const unsigned char *gray, const unsigned char *thresholds, const int width);
+
+static void
+ho_pixbuf_pack_scalar (unsigned char *out, const unsigned char *gray,
+  const unsigned char *thresholds, const int width)
+{
+  int x;
+
+  for (x = 0; x < width; x++)
+    if (gray[x] < thresholds[x])
+      out[x / 8] |= 0x80 >> (x % 8);
+}
+
+#ifdef HO_PIXBUF_X86
+
+/* reverse the bits of a byte, movemask puts the left pixel in bit 0 */
+static unsigned char
+ho_pixbuf_reverse_byte (unsigned int b)
+{
+  b = ((b & 0xf0) >> 4) | ((b & 0x0f) << 4);
+  b = ((b & 0xcc) >> 2) | ((b & 0x33) << 2);
+  b = ((b & 0xaa) >> 1) | ((b & 0x55) << 1);
+
+  return (unsigned char) b;
+}
+
+__attribute__ ((target ("sse2")))
+static void
+ho_pixbuf_pack_sse2 (unsigned char *out, const unsigned char *gray,
+  const unsigned char *thresholds, const int width)
+{
+  __m128i sign = _mm_set1_epi8 ((char) 0x80);
+  __m128i vg, vt;
+  unsigned int mask;
+  int x;
+
+  /* unsigned compare is a signed compare with the sign bit flipped */
+  for (x = 0; x + 16 <= width; x += 16)
+  {
+    vg = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *) (gray + x)),
+      sign);
+    vt = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *) (thresholds + x)),
+      sign);
+    mask = _mm_movemask_epi8 (_mm_cmplt_epi8 (vg, vt));
+
+    out[x / 8] |= ho_pixbuf_reverse_byte (mask & 0xff);
+    out[x / 8 + 1] |= ho_pixbuf_reverse_byte (mask >> 8);
+  }
+
+  ho_pixbuf_pack_scalar (out + x / 8, gray + x, thresholds + x, width - x);
+}
+
+#endif /* HO_PIXBUF_X86 */
+
+/* implementation used by ho_pixbuf_pack, it is selected once when the
+ * library is loaded, so threads only read it */
+static ho_pixbuf_pack_func ho_pixbuf_pack_func_selected =
+  ho_pixbuf_pack_scalar;
+
+#ifdef HO_PIXBUF_X86
+
+static void __attribute__ ((constructor))
+ho_pixbuf_pack_select (void)
+{
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("sse2"))
+    ho_pixbuf_pack_func_selected = ho_pixbuf_pack_sse2;
+}
+
+#endif /* HO_PIXBUF_X86 */
+
+static void
+ho_pixbuf_pack (unsigned char *out, const unsigned char *gray,
+  const unsigned char *thresholds, const int width)
+{
+  ho_pixbuf_pack_func_selected (out, gray, thresholds, width);
+}
+
+/* 
+ * ho_pixbuf_to_bitmap on a row pipeline 
+ */
+static ho_bitmap *
+ho_pixbuf_rows_to_bitmap_gray (ho_pixbuf_rows * rows,
+  const unsigned char gray_threshold)
+{
+  ho_bitmap *m_out = NULL;
+  unsigned char *thresholds;
+  int y;
+
+  /* allocate memory */
+  m_out = ho_bitmap_new (rows->width, rows->height);
+  thresholds = (unsigned char *) malloc (rows->width + 1);
+  if (!m_out || !thresholds)
+  {
+    if (m_out)
+      ho_bitmap_free (m_out);
+    if (thresholds)
+      free (thresholds);
+    return NULL;
+  }
+
+  memset (thresholds, gray_threshold, rows->width);
+  for (y = 0; y < rows->height; y++)
+    ho_pixbuf_pack (m_out->data + y * m_out->rowstride,
+      ho_pixbuf_rows_get (rows, y), thresholds, rows->width);
+
+  free (thresholds);
+
+  return m_out;
+}
+
+/* 
+ * ho_pixbuf_to_bitmap on a row pipeline 
+ */
+static ho_bitmap *
+ho_pixbuf_rows_to_bitmap (ho_pixbuf_rows * rows, unsigned char threshold)
+{
+  /* convert threshold from 0..100 to 0..255 */
+  threshold = 255 * threshold / 100;
+
+  if (!threshold)
+    threshold = 153;
+
+  return ho_pixbuf_rows_to_bitmap_gray (rows, threshold);
+}
+
+/* 
+ * 256 bin histogram of the rows, four sub histograms let neighbor pixels
+ * of the same gray count without waiting on each other 
+ */
+static void
+ho_pixbuf_rows_histogram (ho_pixbuf_rows * rows, unsigned int *histogram)
+{
+  unsigned int sub[4][256];
+  const unsigned char *data;
+  int x, y, i;
+
+  memset (sub, 0, sizeof (sub));
+
+  for (y = 0; y < rows->height; y++)
+  {
+    data = ho_pixbuf_rows_get (rows, y);
+    for (x = 0; x + 4 <= rows->width; x += 4)
+    {
+      sub[0][data[x]]++;
+      sub[1][data[x + 1]]++;
+      sub[2][data[x + 2]]++;
+      sub[3][data[x + 3]]++;
+    }
+    for (; x < rows->width; x++)
+      sub[0][data[x]]++;
+  }
+
+  for (i = 0; i < 256; i++)
+    histogram[i] = sub[0][i] + sub[1][i] + sub[2][i] + sub[3][i];
+}
+
+/* 
+ * otsu threshold of a histogram, the gray that splits the histogram to 
+ * two classes with the largest variance between them. grays below the 
+ * returned value are the dark class 
+ */
+static int
+ho_pixbuf_histogram_otsu (const unsigned int *histogram)
+{
+  double total = 0, sum = 0;
+  double weight_dark = 0, sum_dark = 0;
+  double mean_dark, mean_light, variance;
+  double best_variance = -1;
+  int best = 0;
+  int i;
+
+  for (i = 0; i < 256; i++)
+  {
+    total += histogram[i];
+    sum += (double) i * histogram[i];
+  }
+
+  for (i = 0; i < 255; i++)
+  {
+    weight_dark += histogram[i];
+    sum_dark += (double) i * histogram[i];
+    if (weight_dark == 0 || weight_dark == total)
+      continue;
+
+    mean_dark = sum_dark / weight_dark;
+    mean_light = (sum - sum_dark) / (total - weight_dark);
+    variance = weight_dark * (total - weight_dark) *
+      (mean_dark - mean_light) * (mean_dark - mean_light);
+
+    if (variance > best_variance)
+    {
+      best_variance = variance;
+      best = i;
+    }
+  }
+
+  /* grays 0..best are dark */
+  return best + 1;
+}
+
+/* 
+ * otsu threshold of pix, 1..255 
+ */
+static int
+ho_pixbuf_rows_otsu_threshold (const ho_pixbuf * pix)
+{
+  ho_pixbuf_rows *rows;
+  unsigned int histogram[256];
+
+  rows = ho_pixbuf_rows_new (pix, 1, 1);
+  if (!rows)
+    return 0;
+
+  ho_pixbuf_rows_histogram (rows, histogram);
+  ho_pixbuf_rows_free (rows);
+
+  return ho_pixbuf_histogram_otsu (histogram);
+}
+
+/* 
+ * global threshold of pix scaled by scale, the threshold is in 0..100 and
+ * 0 uses the otsu threshold of pix 
+ */
+static ho_bitmap *
+ho_pixbuf_to_bitmap_global (const ho_pixbuf * pix, const unsigned char scale,
+  unsigned char threshold)
+{
+  ho_pixbuf_rows *rows;
+  ho_bitmap *m_out;
+  int gray_threshold;
+
+  /* convert threshold from 0..100 to 0..255 */
+  gray_threshold = 255 * threshold / 100;
+  if (!gray_threshold)
+    gray_threshold = ho_pixbuf_rows_otsu_threshold (pix);
+  if (!gray_threshold)
+    return NULL;
+
+  rows = ho_pixbuf_rows_new (pix, scale, 1);
+  if (!rows)
+    return NULL;
+
+  m_out = ho_pixbuf_rows_to_bitmap_gray (rows, gray_threshold);
+
+  ho_pixbuf_rows_free (rows);
+
+  return m_out;
+}
+
+/* 
+ * ho_pixbuf_to_bitmap_adaptive on a row pipeline. the block thresholds of
+ * a band of hlf_size rows need the band and the next one, rows needs
+ * size slots 
+ */
+static ho_bitmap *
+ho_pixbuf_rows_to_bitmap_adaptive (ho_pixbuf_rows * rows,
+  unsigned char threshold, unsigned char size, unsigned char adaptive_threshold)
+{
+  ho_bitmap *m_out = NULL;
+  unsigned char *thresholds;
+  unsigned char *band;
+  const unsigned char *data;
+  double *col_sum;
+  int width = rows->width;
+  int height = rows->height;
+  int x, y, y_band, i;
+  int x1, x2;
+  unsigned char locale_thereshold;
+  double sum;
+  int hlf_size = size / 2;
+  double size_aquare = size * size;
+  double factor = (double) adaptive_threshold / 100.0;
+
+  /* convert threshold from 0..100 to 0..255 */
+  threshold = 255 * threshold / 100;
+
+  /* set defaults */
+  if (!factor)
+    factor = 6.0 / 8.0;
+
+  if (!size)
+  {
+    size = 70;
+    hlf_size = size / 2;
+    size_aquare = size * size;
+  }
+
+  if (hlf_size < 1)
+    return NULL;
+
+  /* allocate memory */
+  m_out = ho_bitmap_new (width, height);
+  thresholds = (unsigned char *) malloc (width + 1);
+  band = (unsigned char *) malloc (width + 1);
+  col_sum = (double *) malloc ((width + 1) * sizeof (double));
+  if (!m_out || !thresholds || !band || !col_sum)
+  {
+    if (m_out)
+      ho_bitmap_free (m_out);
+    if (thresholds)
+      free (thresholds);
+    if (band)
+      free (band);
+    if (col_sum)
+      free (col_sum);
+    return NULL;
+  }
+
+  /* columns left of x1 and from x2 on are in the 0.5 threshold frame */
+  x1 = hlf_size;
+  x2 = width - size;
+
+  for (y_band = 0; y_band < height; y_band += hlf_size)
+  {
+    /* block thresholds of this band, from the window around the next grid
+     * point */
+    memset (band, 0, width);
+    y = y_band + hlf_size;
+    if (y < height - hlf_size)
+    {
+      memset (col_sum, 0, width * sizeof (double));
+      for (i = -hlf_size; i < hlf_size; i++)
+      {
+        data = ho_pixbuf_rows_get (rows, y + i);
+        for (x = 0; x < width; x++)
+          col_sum[x] += data[x];
+      }
+
+      for (x = hlf_size; x < width - hlf_size; x += hlf_size)
+      {
+        /* get avg */
+        sum = 0;
+        for (i = -hlf_size; i < hlf_size; i++)
+          sum += col_sum[x + i];
+
+        /* calculate locale threshold */
+        locale_thereshold = (unsigned char) (factor * sum / size_aquare);
+        if (locale_thereshold < threshold)
+          locale_thereshold = threshold;
+
+        memset (band + x - hlf_size, locale_thereshold, hlf_size);
+      }
+    }
+
+    for (y = y_band; y < y_band + hlf_size && y < height; y++)
+    {
+      /* init threshold frame to 0.5 */
+      memcpy (thresholds, band, width);
+      for (x = 0; x < width; x++)
+        if ((x < x1 || x >= x2 || y < hlf_size || y >= height - size)
+          && thresholds[x] < 127)
+          thresholds[x] = 127;
+
+      ho_pixbuf_pack (m_out->data + y * m_out->rowstride,
+        ho_pixbuf_rows_get (rows, y), thresholds, width);
+    }
+  }
+
+  free (thresholds);
+  free (band);
+  free (col_sum);
+
+  return m_out;
+}
+
+/* 
+ * threshold a gray pixbuf by the mean, and for sauvola the standard 
+ * deviation, of the size x size window around each pixel. the window sums
+ * are streamed one row at a time: col_sum holds the sum of each column over
+ * the window rows, and a prefix of col_sum gives the window sum, so the cost
+ * per pixel does not depend on the window size and only a few rows of
+ * sums are kept. windows are clipped at the borders, rows needs size + 2
+ * slots
+ */
+static ho_bitmap *
+ho_pixbuf_rows_to_bitmap_windows (ho_pixbuf_rows * rows,
+  unsigned char threshold, unsigned char size, const double factor,
+  const int sauvola)
+{
+  ho_bitmap *m_out = NULL;
+  uint64_t *col_sum;
+  uint64_t *col_sq;
+  uint64_t *row_sum;
+  uint64_t *row_sq;
+  uint64_t *row;
+  const unsigned char *data;
+  int n_words;
+  int x, y, x1, x2, y1, y2;
+  int hlf_size;
+  double count, sum, mean, deviation, locale_thereshold;
+
+  /* convert threshold from 0..100 to 0..255 */
+  threshold = 255 * threshold / 100;
+
+  hlf_size = size / 2;
+
+  /* allocate memory */
+  m_out = ho_bitmap_new (rows->width, rows->height);
+  if (!m_out)
+    return NULL;
+
+  n_words = (rows->width + 63) / 64;
+  col_sum = (uint64_t *) calloc (rows->width, sizeof (uint64_t));
+  col_sq = (uint64_t *) calloc (rows->width, sizeof (uint64_t));
+  row_sum = (uint64_t *) malloc ((rows->width + 1) * sizeof (uint64_t));
+  row_sq = (uint64_t *) malloc ((rows->width + 1) * sizeof (uint64_t));
+  row = (uint64_t *) malloc ((n_words + 1) * sizeof (uint64_t));
+  if (!col_sum || !col_sq || !row_sum || !row_sq || !row)
+  {
+    if (col_sum)
+      free (col_sum);
+    if (col_sq)
+      free (col_sq);
+    if (row_sum)
+      free (row_sum);
+    if (row_sq)
+      free (row_sq);
+    if (row)
+      free (row);
+    ho_bitmap_free (m_out);
+    return NULL;
+  }
+
+  /* rows above the first window center */
+  for (y = 0; y < hlf_size && y < rows->height; y++)
+  {
+    data = ho_pixbuf_rows_get (rows, y);
+    for (x = 0; x < rows->width; x++)
+    {
+      col_sum[x] += data[x];
+      col_sq[x] += data[x] * data[x];
+    }
+  }
+
+  for (y = 0; y < rows->height; y++)
+  {
+    /* move the window rows down */
+    if (y + hlf_size < rows->height)
+    {
+      data = ho_pixbuf_rows_get (rows, y + hlf_size);
+      for (x = 0; x < rows->width; x++)
+      {
+        col_sum[x] += data[x];
+        col_sq[x] += data[x] * data[x];
+      }
+    }
+    if (y - hlf_size - 1 >= 0)
+    {
+      data = ho_pixbuf_rows_get (rows, y - hlf_size - 1);
+      for (x = 0; x < rows->width; x++)
+      {
+        col_sum[x] -= data[x];
+        col_sq[x] -= data[x] * data[x];
+      }
+    }
+
+    /* prefix sums of the columns */
+    row_sum[0] = row_sq[0] = 0;
+    for (x = 0; x < rows->width; x++)
+    {
+      row_sum[x + 1] = row_sum[x] + col_sum[x];
+      row_sq[x + 1] = row_sq[x] + col_sq[x];
+    }
+
+    y1 = (y - hlf_size < 0) ? 0 : y - hlf_size;
+    y2 = (y + hlf_size >= rows->height) ? rows->height - 1 : y + hlf_size;
+
+    memset (row, 0, (n_words + 1) * sizeof (uint64_t));
+    data = ho_pixbuf_rows_get (rows, y);
+    for (x = 0; x < rows->width; x++)
+    {
+      x1 = (x - hlf_size < 0) ? 0 : x - hlf_size;
+      x2 = (x + hlf_size >= rows->width) ? rows->width - 1 : x + hlf_size;
+
+      count = (double) (x2 - x1 + 1) * (y2 - y1 + 1);
+      sum = (double) (row_sum[x2 + 1] - row_sum[x1]);
+      mean = sum / count;
+
+      /* calculate locale threshold */
+      if (sauvola)
+      {
+        deviation = (double) (row_sq[x2 + 1] - row_sq[x1]) / count -
+          mean * mean;
+        deviation = (deviation > 0) ? sqrt (deviation) : 0;
+        locale_thereshold = mean * (1.0 + factor * (deviation / 128.0 - 1.0));
+      }
+      else
+        locale_thereshold = mean * factor;
+
+      if (locale_thereshold < threshold)
+        locale_thereshold = threshold;
+
+      if (data[x] < locale_thereshold)
+        row[x / 64] |= (uint64_t) 1 << (63 - x % 64);
+    }
+
+    ho_bitmap_set_row_words (m_out, y, row);
+  }
+
+  free (col_sum);
+  free (col_sq);
+  free (row_sum);
+  free (row_sq);
+  free (row);
+
+  return m_out;
+}
+
+/* 
+ * window thresholding of pix scaled by scale 
+ */
+static ho_bitmap *
+ho_pixbuf_to_bitmap_windows (const ho_pixbuf * pix, const unsigned char scale,
+  unsigned char threshold, unsigned char size,
+  unsigned char adaptive_threshold, const int sauvola)
+{
+  ho_pixbuf_rows *rows;
+  ho_bitmap *m_out;
+  double factor = (double) adaptive_threshold / 100.0;
+
+  /* set defaults */
+  if (!factor)
+    factor = (sauvola) ? 34.0 / 100.0 : 85.0 / 100.0;
+
+  if (!size)
+    size = 70;
+
+  rows = ho_pixbuf_rows_new (pix, scale, size + 2);
+  if (!rows)
+    return NULL;
+
+  m_out = ho_pixbuf_rows_to_bitmap_windows (rows, threshold, size, factor,
+    sauvola);
+
+  ho_pixbuf_rows_free (rows);
+
+  return m_out;
+}
+
+ho_bitmap *
+ho_pixbuf_to_bitmap_bradley (const ho_pixbuf * pix,
+  unsigned char threshold, unsigned char size, unsigned char adaptive_threshold)
+{
+  /* is input gray ? */
+  if (pix->n_channels != 1)
+    return NULL;
+
+  return ho_pixbuf_to_bitmap_windows (pix, 1, threshold, size,
+    adaptive_threshold, FALSE);
+}
+
+ho_bitmap *
+ho_pixbuf_to_bitmap_sauvola (const ho_pixbuf * pix,
+  unsigned char threshold, unsigned char size, unsigned char adaptive_threshold)
+{
+  /* is input gray ? */
+  if (pix->n_channels != 1)
+    return NULL;
+
+  return ho_pixbuf_to_bitmap_windows (pix, 1, threshold, size,
+    adaptive_threshold, TRUE);
+}
+
+unsigned char
+ho_pixbuf_otsu_threshold (const ho_pixbuf * pix)
+{
+  return (unsigned char) ho_pixbuf_rows_otsu_threshold (pix);
+}
+
+ho_bitmap *
+ho_pixbuf_to_bitmap_otsu (const ho_pixbuf * pix, unsigned char threshold)
+{
+  return ho_pixbuf_to_bitmap_global (pix, 1, threshold);
+}
+
+/**
+ convert a color of gray pixbuf to bitmap wrapper function
+ @param pix_in the input ho_pixbuf
+ @param image_options configuration options. Used items are: scale, adaptive, threshold, a_treshold
+ @param size kernel size to use for adaptive thresholding
+ @return newly allocated b/w ho_bitmap
+ */
+ho_bitmap* ho_pixbuf_to_bitmap_wrapper( const ho_pixbuf* pix_in, HEBOCR_IMAGE_OPTIONS* image_options, size_t size )
+{
+  ho_pixbuf *pix = NULL;
+  ho_pixbuf *pix_temp = NULL;
+  ho_pixbuf_rows *rows = NULL;
+  ho_bitmap *m_bw = NULL;
+
+  /* 
+   * all but fine thresholding run row by row: each row is converted to 
+   * gray, scaled, thresholded and packed, with no full size gray pixbuf. 
+   * ho_pixbuf_linear_filter is left out, ho_pixbuf_minmax starts from 
+   * 0..255 so the filter keeps grays as they are 
+   */
+  switch(image_options->adaptive)
+  {
+  case 1:
+    rows = ho_pixbuf_rows_new (pix_in, image_options->scale, 1);
+    if (!rows)
+      return NULL;
+    m_bw = ho_pixbuf_rows_to_bitmap (rows, image_options->threshold);
+    ho_pixbuf_rows_free (rows);
+    return m_bw;
+  case 2:
+    break;
+  case 3:
+    return ho_pixbuf_to_bitmap_windows (pix_in, image_options->scale, image_options->threshold, size, image_options->a_threshold, FALSE);
+  case 4:
+    return ho_pixbuf_to_bitmap_windows (pix_in, image_options->scale, image_options->threshold, size, image_options->a_threshold, TRUE);
+  case 5:
+    return ho_pixbuf_to_bitmap_global (pix_in, image_options->scale, image_options->threshold);
+  default:
+    rows = ho_pixbuf_rows_new (pix_in, image_options->scale, (size) ? (unsigned char) size : 70);
+    if (!rows)
+      return NULL;
+    m_bw = ho_pixbuf_rows_to_bitmap_adaptive (rows, image_options->threshold, size, image_options->a_threshold);
+    ho_pixbuf_rows_free (rows);
+    return m_bw;
+  }
+
+  /* if pix is color convert to gray scale */
+  if (pix_in->n_channels > 1)
+    pix = ho_pixbuf_color_to_gray(pix_in);
+  else
+    pix = ho_pixbuf_clone(pix_in);
+
+  if (!pix)
+    return NULL;
+
+  /* streach picture grays */
+  pix_temp = ho_pixbuf_linear_filter(pix);
+  ho_pixbuf_free(pix);
+  if (!pix_temp)
+    return NULL;
+  pix = pix_temp;
+
+  /* scale */
+  if (image_options->scale > 1)
+  {
+    pix_temp = ho_pixbuf_scale (pix, image_options->scale);
+    ho_pixbuf_free (pix);
+    if (!pix_temp)
+      return NULL;
+    pix = pix_temp;
+  }
+
+  /* convert to b/w bitmap */
+  m_bw =
+    ho_pixbuf_to_bitmap_adaptive_fine (pix, image_options->threshold, size, image_options->a_threshold);
+
+  ho_pixbuf_free (pix);
+
+  return m_bw;
+}
+
+int
+ho_pixbuf_draw_bitmap (ho_pixbuf * m, const ho_bitmap * bit_in,
+  const unsigned char red, const unsigned char green,
+  const unsigned char blue, const unsigned char alpha)
+{
+  int x, y;
+  unsigned char new_red;
+  unsigned char new_green;
+  unsigned char new_blue;
+
+  /* check for bitmap origin, if this is a sub window draw at its origin */
+  if (bit_in->x != 0 || bit_in->y != 0 || m->width > bit_in->width
+    || m->height > bit_in->height)
+    ho_pixbuf_draw_bitmap_at (m, bit_in, bit_in->x, bit_in->y, red, green,
+      blue, alpha);
+
+  /* sanity check */
+  if (m->width != bit_in->width || m->height != bit_in->height)
+    return TRUE;
+
+  /* is pixbuf color ? */
+  if (m->n_channels < 3)
+  {                             /* gray scale */
+    for (x = 0; x < bit_in->width; x++)
+      for (y = 0; y < bit_in->height; y++)
+        if (ho_bitmap_get (bit_in, x, y))
+        {
+          new_red =
+            alpha * red / 255 + (255 - alpha) * ho_pixbuf_get (m, x, y,
+            0) / 255;
+          ho_pixbuf_set (m, x, y, 0, new_red);
+        }
+  }
+  else
+  {                             /* color */
+    for (x = 0; x < bit_in->width; x++)
+      for (y = 0; y < bit_in->height; y++)
+        if (ho_bitmap_get (bit_in, x, y))
+        {
+          new_red =
+            alpha * red / 255 + (255 - alpha) * ho_pixbuf_get (m, x, y,
+            0) / 255;
+          new_green =
+            alpha * green / 255 + (255 - alpha) * ho_pixbuf_get (m, x, y,
+            1) / 255;
+          new_blue =
+            alpha * blue / 255 + (255 - alpha) * ho_pixbuf_get (m, x, y,
+            2) / 255;
+
+          ho_pixbuf_set (m, x, y, 0, new_red);
+          ho_pixbuf_set (m, x, y, 1, new_green);
+          ho_pixbuf_set (m, x, y, 2, new_blue);
+        }
+  }
+
+  return FALSE;
+}
+
+int
+ho_pixbuf_draw_bitmap_at (ho_pixbuf * m, const ho_bitmap * bit_in,
+  const int x1, const int y1,
+  const unsigned char red, const unsigned char green,
+  const unsigned char blue, const unsigned char alpha)
 {
   int x, y;
   unsigned char new_red;
@@ -1583,7 +2844,7 @@ ho_pixbuf_pnm_load (const char *filename)
     /* create a new pixbuf */
     pix = ho_pixbuf_new (n_channels, width, height, 0);
 
-    rowstride = 8 * (width / 8 + 1);
+    rowstride = 8 * ((width + 7) / 8);
     if (pix)
       for (y = 0; y < height; y++)
       {
@@ -1627,6 +2888,189 @@ ho_pixbuf_pnm_load (const char *filename)
   return pix;
 }
 
+/* 
+ * read a pnm header from memory, return the offset of the pixels or 0 
+ */
+static size_t
+ho_pnm_header (const unsigned char *data, const size_t size, char *type,
+  int *width, int *height, int *maxval)
+{
+  int values[3];
+  int n_values;
+  int i;
+  size_t offset;
+
+  if (size < 3 || data[0] != 'P'
+    || (data[1] != '4' && data[1] != '5' && data[1] != '6'))
+    return 0;
+
+  *type = data[1];
+  n_values = (*type == '4') ? 2 : 3;
+  offset = 2;
+
+  for (i = 0; i < n_values; i++)
+  {
+    /* pass on white spaces and comments */
+    while (offset < size && (data[offset] == ' ' || data[offset] == '\n'
+        || data[offset] == '\r' || data[offset] == '\t'
+        || data[offset] == '#'))
+    {
+      if (data[offset] == '#')
+        while (offset < size && data[offset] != '\n')
+          offset++;
+      else
+        offset++;
+    }
+
+    /* read a number */
+    if (offset >= size || data[offset] < '0' || data[offset] > '9')
+      return 0;
+    values[i] = 0;
+    while (offset < size && data[offset] >= '0' && data[offset] <= '9'
+      && values[i] < 1000000)
+      values[i] = values[i] * 10 + (data[offset++] - '0');
+  }
+
+  /* one white space ends the header */
+  if (offset >= size)
+    return 0;
+  offset++;
+
+  *width = values[0];
+  *height = values[1];
+  *maxval = (*type == '4') ? 1 : values[2];
+
+  if (*width < 1 || *height < 1 || *maxval < 1)
+    return 0;
+
+  return offset;
+}
+
+ho_pixbuf *
+ho_pixbuf_pnm_map (const char *filename)
+{
+  ho_pixbuf *pix = NULL;
+  unsigned char *map;
+  const unsigned char *line;
+  size_t map_size, offset;
+  char type;
+  int width, height, maxval;
+  int x, y, rowstride;
+
+  /* stdin can not be mapped */
+  if (!filename || filename[0] == '\0'
+    || (filename[0] == '-' && filename[1] == '\0'))
+    return ho_pixbuf_pnm_load (filename);
+
+  map = ho_pixbuf_map_file (filename, &map_size);
+  if (!map)
+    return ho_pixbuf_pnm_load (filename);
+
+  offset = ho_pnm_header (map, map_size, &type, &width, &height, &maxval);
+  if (!offset || maxval > 255)
+  {
+    ho_pixbuf_unmap_file (map, map_size);
+    return NULL;
+  }
+
+  if (type == '4')
+  {
+    /* expand bits to a gray pixbuf, set bits are black */
+    rowstride = (width + 7) / 8;
+    if ((map_size - offset) / rowstride < (size_t) height)
+    {
+      ho_pixbuf_unmap_file (map, map_size);
+      return NULL;
+    }
+
+    pix = ho_pixbuf_new (1, width, height, 0);
+    if (pix)
+      for (y = 0; y < height; y++)
+      {
+        line = map + offset + (size_t) y * rowstride;
+        for (x = 0; x < width; x++)
+          if (line[x >> 3] & (0x80 >> (x & 7)))
+            pix->data[x + y * pix->rowstride] = 0;
+      }
+
+    ho_pixbuf_unmap_file (map, map_size);
+
+    return pix;
+  }
+
+  /* the pixels in the file are the pixbuf data */
+  rowstride = width * ((type == '6') ? 3 : 1);
+  if ((map_size - offset) / rowstride < (size_t) height)
+  {
+    ho_pixbuf_unmap_file (map, map_size);
+    return NULL;
+  }
+
+  pix = (ho_pixbuf *) malloc (sizeof (ho_pixbuf));
+  if (!pix)
+  {
+    ho_pixbuf_unmap_file (map, map_size);
+    return NULL;
+  }
+
+  pix->n_channels = (type == '6') ? 3 : 1;
+  pix->width = width;
+  pix->height = height;
+  pix->rowstride = rowstride;
+  pix->data = map + offset;
+  pix->map = map;
+  pix->map_size = map_size;
+
+  return pix;
+}
+
+ho_bitmap *
+ho_pixbuf_pnm_load_bitmap (const char *filename)
+{
+  ho_bitmap *m_out = NULL;
+  unsigned char *map;
+  unsigned char *line;
+  unsigned char mask;
+  size_t map_size, offset;
+  char type;
+  int width, height, maxval;
+  int y;
+
+  map = ho_pixbuf_map_file (filename, &map_size);
+  if (!map)
+    return NULL;
+
+  offset = ho_pnm_header (map, map_size, &type, &width, &height, &maxval);
+  if (!offset || type != '4')
+  {
+    ho_pixbuf_unmap_file (map, map_size);
+    return NULL;
+  }
+
+  /* pbm rows are padded to bytes like bitmap rows */
+  m_out = ho_bitmap_new (width, height);
+  if (!m_out || (map_size - offset) / m_out->rowstride < (size_t) height)
+  {
+    if (m_out)
+      ho_bitmap_free (m_out);
+    ho_pixbuf_unmap_file (map, map_size);
+    return NULL;
+  }
+
+  memcpy (m_out->data, map + offset, (size_t) height * m_out->rowstride);
+  ho_pixbuf_unmap_file (map, map_size);
+
+  /* clear the padding bits at the end of rows */
+  mask = (width % 8) ? (0xff << (8 - width % 8)) : 0xff;
+  for (y = 0; y < height; y++)
+  {
+    line = m_out->data + y * m_out->rowstride;
+    line[m_out->rowstride - 1] &= mask;
+  }
+
+  return m_out;
+}
+
 int
 ho_pixbuf_pnm_save (const ho_pixbuf * pix, const char *filename)
 {
@@ -1835,3 +3279,473 @@ ho_pixbuf_bw_tiff_save (const ho_pixbuf * pix, const char *filename)
   return FALSE;
 }
 #endif /* USE_TIFF */
+
+#ifdef USE_TIFF
+
+struct ho_pixbuf_tiff_reader
+{
+  TIFF *tiff;
+  int n_pages;
+  int end;                      /* no more directories to decode */
+  int failed;                   /* the last page asked for was broken */
+
+  /* a decoded page waiting for the user */
+  int ready;
+  int error;
+  ho_bitmap *m;
+  ho_pixbuf *pix;
+
+#ifdef USE_PTHREADS
+  int prefetch;
+  int stop;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+#endif
+};
+
+/* 
+ * page being decoded 
+ */
+typedef struct
+{
+  int width;
+  int height;
+  uint16 bps;
+  uint16 spp;
+  uint16 photo;
+  ho_bitmap *m;
+  ho_pixbuf *pix;
+} ho_pixbuf_tiff_page;
+
+/* 
+ * copy n_cols decoded pixels starting at column x to row y of the page 
+ */
+static void
+ho_pixbuf_tiff_copy_row (ho_pixbuf_tiff_page * page,
+  const unsigned char *src, int x, int y, int n_cols)
+{
+  unsigned char *dst;
+  int i, n_bytes;
+
+  if (page->m)
+  {
+    /* set bits are black in bitmaps and in min-is-white tiffs */
+    n_bytes = (n_cols + 7) / 8;
+    dst = page->m->data + y * page->m->rowstride + x / 8;
+    if (page->photo == PHOTOMETRIC_MINISWHITE)
+      memcpy (dst, src, n_bytes);
+    else
+      for (i = 0; i < n_bytes; i++)
+        dst[i] = ~src[i];
+    return;
+  }
+
+  dst = page->pix->data + y * page->pix->rowstride + x * page->pix->n_channels;
+  if (page->spp == 1)
+  {
+    if (page->photo == PHOTOMETRIC_MINISWHITE)
+      for (i = 0; i < n_cols; i++)
+        dst[i] = 255 - src[i];
+    else
+      memcpy (dst, src, n_cols);
+    return;
+  }
+
+  /* color, drop extra samples */
+  for (i = 0; i < n_cols; i++)
+  {
+    dst[3 * i] = src[page->spp * i];
+    dst[3 * i + 1] = src[page->spp * i + 1];
+    dst[3 * i + 2] = src[page->spp * i + 2];
+  }
+}
+
+/* 
+ * decode the page strip by strip 
+ */
+static int
+ho_pixbuf_tiff_read_strips (TIFF * tiff, ho_pixbuf_tiff_page * page)
+{
+  unsigned char *buffer;
+  uint32 rows_per_strip;
+  tsize_t scanline;
+  tstrip_t strip;
+  int y, i, n_rows;
+
+  TIFFGetFieldDefaulted (tiff, TIFFTAG_ROWSPERSTRIP, &rows_per_strip);
+  if (rows_per_strip > (uint32) page->height)
+    rows_per_strip = page->height;
+  scanline = TIFFScanlineSize (tiff);
+
+  /* one strip in memory at a time */
+  buffer = (unsigned char *) malloc (TIFFStripSize (tiff));
+  if (!buffer)
+    return TRUE;
+
+  for (y = 0; y < page->height; y += rows_per_strip)
+  {
+    strip = TIFFComputeStrip (tiff, y, 0);
+    if (TIFFReadEncodedStrip (tiff, strip, buffer, -1) == -1)
+    {
+      free (buffer);
+      return TRUE;
+    }
+
+    n_rows = page->height - y;
+    if (n_rows > (int) rows_per_strip)
+      n_rows = rows_per_strip;
+    for (i = 0; i < n_rows; i++)
+      ho_pixbuf_tiff_copy_row (page, buffer + i * scanline, 0, y + i,
+        page->width);
+  }
+
+  free (buffer);
+
+  return FALSE;
+}
+
+/* 
+ * decode the page tile by tile 
+ */
+static int
+ho_pixbuf_tiff_read_tiles (TIFF * tiff, ho_pixbuf_tiff_page * page)
+{
+  unsigned char *buffer;
+  uint32 tile_width, tile_height;
+  tsize_t tile_rowsize;
+  int x, y, i, n_rows, n_cols;
+
+  TIFFGetField (tiff, TIFFTAG_TILEWIDTH, &tile_width);
+  TIFFGetField (tiff, TIFFTAG_TILELENGTH, &tile_height);
+  tile_rowsize = TIFFTileRowSize (tiff);
+
+  /* one tile in memory at a time */
+  buffer = (unsigned char *) malloc (TIFFTileSize (tiff));
+  if (!buffer)
+    return TRUE;
+
+  for (y = 0; y < page->height; y += tile_height)
+    for (x = 0; x < page->width; x += tile_width)
+    {
+      if (TIFFReadTile (tiff, buffer, x, y, 0, 0) == -1)
+      {
+        free (buffer);
+        return TRUE;
+      }
+
+      n_rows = page->height - y;
+      if (n_rows > (int) tile_height)
+        n_rows = tile_height;
+      n_cols = page->width - x;
+      if (n_cols > (int) tile_width)
+        n_cols = tile_width;
+      for (i = 0; i < n_rows; i++)
+        ho_pixbuf_tiff_copy_row (page, buffer + i * tile_rowsize, x, y + i,
+          n_cols);
+    }
+
+  free (buffer);
+
+  return FALSE;
+}
+
+/* 
+ * decode pages we can not copy through libtiff rgba interface 
+ */
+static ho_pixbuf *
+ho_pixbuf_tiff_read_rgba (TIFF * tiff, int width, int height)
+{
+  ho_pixbuf *pix;
+  uint32 *raster;
+  uint32 value;
+  int i;
+
+  raster = (uint32 *) malloc ((size_t) width * height * sizeof (uint32));
+  if (!raster)
+    return NULL;
+
+  if (!TIFFReadRGBAImageOriented (tiff, width, height, raster,
+      ORIENTATION_TOPLEFT, 0))
+  {
+    free (raster);
+    return NULL;
+  }
+
+  pix = ho_pixbuf_new (3, width, height, 0);
+  if (pix)
+    for (i = 0; i < width * height; i++)
+    {
+      value = raster[i];
+      pix->data[3 * i] = TIFFGetR (value);
+      pix->data[3 * i + 1] = TIFFGetG (value);
+      pix->data[3 * i + 2] = TIFFGetB (value);
+    }
+
+  free (raster);
+
+  return pix;
+}
+
+/* 
+ * decode the current directory, 1 bit pages to a bitmap and other pages 
+ * to a gray or color pixbuf 
+ */
+static int
+ho_pixbuf_tiff_read_page (TIFF * tiff, ho_bitmap ** m_out,
+  ho_pixbuf ** pix_out)
+{
+  ho_pixbuf_tiff_page page;
+  uint32 width, height;
+  uint16 planar;
+  unsigned char mask;
+  int y, direct, error;
+
+  *m_out = NULL;
+  *pix_out = NULL;
+
+  if (!TIFFGetField (tiff, TIFFTAG_IMAGEWIDTH, &width)
+    || !TIFFGetField (tiff, TIFFTAG_IMAGELENGTH, &height)
+    || width < 1 || height < 1)
+    return TRUE;
+
+  TIFFGetFieldDefaulted (tiff, TIFFTAG_BITSPERSAMPLE, &page.bps);
+  TIFFGetFieldDefaulted (tiff, TIFFTAG_SAMPLESPERPIXEL, &page.spp);
+  TIFFGetFieldDefaulted (tiff, TIFFTAG_PLANARCONFIG, &planar);
+  if (!TIFFGetField (tiff, TIFFTAG_PHOTOMETRIC, &page.photo))
+    page.photo = PHOTOMETRIC_MINISWHITE;
+
+  page.width = width;
+  page.height = height;
+  page.m = NULL;
+  page.pix = NULL;
+
+  /* can we copy decoded samples as is ? */
+  direct = (page.spp == 1 && (page.bps == 1 || page.bps == 8)
+    && (page.photo == PHOTOMETRIC_MINISWHITE
+      || page.photo == PHOTOMETRIC_MINISBLACK))
+    || (page.bps == 8 && page.spp >= 3 && page.photo == PHOTOMETRIC_RGB
+    && planar == PLANARCONFIG_CONTIG);
+
+  if (!direct)
+  {
+    *pix_out = ho_pixbuf_tiff_read_rgba (tiff, page.width, page.height);
+    return (*pix_out == NULL);
+  }
+
+  if (page.bps == 1)
+    page.m = ho_bitmap_new (page.width, page.height);
+  else
+    page.pix = ho_pixbuf_new ((page.spp == 1) ? 1 : 3, page.width,
+      page.height, 0);
+  if (!page.m && !page.pix)
+    return TRUE;
+
+  if (TIFFIsTiled (tiff))
+    error = ho_pixbuf_tiff_read_tiles (tiff, &page);
+  else
+    error = ho_pixbuf_tiff_read_strips (tiff, &page);
+
+  if (error)
+  {
+    if (page.m)
+      ho_bitmap_free (page.m);
+    if (page.pix)
+      ho_pixbuf_free (page.pix);
+    return TRUE;
+  }
+
+  if (page.m)
+  {
+    /* clear the padding bits at the end of rows */
+    mask = (page.width % 8) ? (0xff << (8 - page.width % 8)) : 0xff;
+    for (y = 0; y < page.height; y++)
+      page.m->data[y * page.m->rowstride + page.m->rowstride - 1] &= mask;
+  }
+
+  *m_out = page.m;
+  *pix_out = page.pix;
+
+  return FALSE;
+}
+
+/* 
+ * decode the current page to the reader slot and move to the next one 
+ */
+static void
+ho_pixbuf_tiff_reader_decode (ho_pixbuf_tiff_reader * reader,
+  ho_bitmap ** m_out, ho_pixbuf ** pix_out, int *error, int *end)
+{
+  *error = ho_pixbuf_tiff_read_page (reader->tiff, m_out, pix_out);
+  *end = !TIFFReadDirectory (reader->tiff);
+}
+
+#ifdef USE_PTHREADS
+static void *
+ho_pixbuf_tiff_reader_thread (void *data)
+{
+  ho_pixbuf_tiff_reader *reader = (ho_pixbuf_tiff_reader *) data;
+  ho_bitmap *m;
+  ho_pixbuf *pix;
+  int error, end;
+
+  pthread_mutex_lock (&reader->lock);
+  while (!reader->stop && !reader->end)
+  {
+    /* wait for the user to take the last page */
+    if (reader->ready)
+    {
+      pthread_cond_wait (&reader->cond, &reader->lock);
+      continue;
+    }
+
+    /* decode the next page while the user works on this one */
+    pthread_mutex_unlock (&reader->lock);
+    ho_pixbuf_tiff_reader_decode (reader, &m, &pix, &error, &end);
+    pthread_mutex_lock (&reader->lock);
+
+    /* publish the page and the end mark together */
+    reader->end = end;
+    reader->m = m;
+    reader->pix = pix;
+    reader->error = error;
+    reader->ready = TRUE;
+    pthread_cond_broadcast (&reader->cond);
+  }
+  pthread_mutex_unlock (&reader->lock);
+
+  return NULL;
+}
+#endif /* USE_PTHREADS */
+
+ho_pixbuf_tiff_reader *
+ho_pixbuf_tiff_reader_new (const char *filename, const unsigned char prefetch)
+{
+  ho_pixbuf_tiff_reader *reader;
+  TIFF *tiff;
+
+  tiff = TIFFOpen (filename, "r");
+  if (!tiff)
+    return NULL;
+
+  reader = (ho_pixbuf_tiff_reader *) calloc (1, sizeof (ho_pixbuf_tiff_reader));
+  if (!reader)
+  {
+    TIFFClose (tiff);
+    return NULL;
+  }
+
+  reader->tiff = tiff;
+  reader->n_pages = TIFFNumberOfDirectories (tiff);
+
+#ifdef USE_PTHREADS
+  if (prefetch)
+  {
+    pthread_mutex_init (&reader->lock, NULL);
+    pthread_cond_init (&reader->cond, NULL);
+    reader->prefetch = !pthread_create (&reader->thread, NULL,
+      ho_pixbuf_tiff_reader_thread, reader);
+    if (!reader->prefetch)
+    {
+      pthread_mutex_destroy (&reader->lock);
+      pthread_cond_destroy (&reader->cond);
+    }
+  }
+#endif
+
+  return reader;
+}
+
+int
+ho_pixbuf_tiff_reader_n_pages (const ho_pixbuf_tiff_reader * reader)
+{
+  return reader->n_pages;
+}
+
+int
+ho_pixbuf_tiff_reader_next (ho_pixbuf_tiff_reader * reader,
+  ho_bitmap ** m_out, ho_pixbuf ** pix_out)
+{
+  int error;
+
+  *m_out = NULL;
+  *pix_out = NULL;
+  reader->failed = FALSE;
+
+#ifdef USE_PTHREADS
+  if (reader->prefetch)
+  {
+    pthread_mutex_lock (&reader->lock);
+    while (!reader->ready && !reader->end)
+      pthread_cond_wait (&reader->cond, &reader->lock);
+
+    /* no pages left */
+    if (!reader->ready)
+    {
+      pthread_mutex_unlock (&reader->lock);
+      return TRUE;
+    }
+
+    *m_out = reader->m;
+    *pix_out = reader->pix;
+    error = reader->error;
+    reader->m = NULL;
+    reader->pix = NULL;
+    reader->ready = FALSE;
+    pthread_cond_broadcast (&reader->cond);
+    pthread_mutex_unlock (&reader->lock);
+
+    reader->failed = error;
+
+    return error;
+  }
+#endif
+
+  if (reader->end)
+    return TRUE;
+
+  ho_pixbuf_tiff_reader_decode (reader, m_out, pix_out, &error, &reader->end);
+  reader->failed = error;
+
+  return error;
+}
+
+int
+ho_pixbuf_tiff_reader_failed (const ho_pixbuf_tiff_reader * reader)
+{
+  return reader->failed;
+}
+
+int
+ho_pixbuf_tiff_reader_free (ho_pixbuf_tiff_reader * reader)
+{
+  if (!reader)
+    return TRUE;
+
+#ifdef USE_PTHREADS
+  if (reader->prefetch)
+  {
+    pthread_mutex_lock (&reader->lock);
+    reader->stop = TRUE;
+    pthread_cond_broadcast (&reader->cond);
+    pthread_mutex_unlock (&reader->lock);
+
+    pthread_join (reader->thread, NULL);
+    pthread_mutex_destroy (&reader->lock);
+    pthread_cond_destroy (&reader->cond);
+  }
+#endif
+
+  /* a prefetched page nobody took */
+  if (reader->m)
+    ho_bitmap_free (reader->m);
+  if (reader->pix)
+    ho_pixbuf_free (reader->pix);
+
+  TIFFClose (reader->tiff);
+  free (reader);
+
+  return FALSE;
+}
+
+#endif /* USE_TIFF */
@@ -70,6 +70,8 @@ typedef struct
   int width;
   int rowstride;
   unsigned char *data;
+  unsigned char *map;           /* file mapping holding data, or NULL */
+  size_t map_size;
 } ho_pixbuf;
 
 ho_pixbuf* ho_pixbuf_new( int n_channels, int width, int height, int rowstride );
@@ -237,6 +239,16 @@ ho_pixbuf *ho_pixbuf_scale4 (const ho_pixbuf * pix);
  */
 ho_pixbuf *ho_pixbuf_scale8 (const ho_pixbuf * pix);
 
+/**
+ scale a gray pixbuf by num / den, up or down
+ @param pix the input ho_pixbuf
+ @param num numerator of scale factor
+ @param den denominator of scale factor
+ @return newly allocated gray ho_pixbuf
+ */
+ho_pixbuf *ho_pixbuf_resample (const ho_pixbuf * pix, const int num,
+  const int den);
+
 /**
  scale a gray pixbuf
  @param pix the input ho_pixbuf
@@ -311,6 +323,50 @@ ho_bitmap *ho_pixbuf_to_bitmap_adaptive_fine (const ho_pixbuf *
   unsigned char threshold,
   unsigned char size, unsigned char adaptive_threshold);
 
+/**
+ convert a gray pixbuf to bitmap using bradley thresholding, a pixel is
+ black if it is darker then the mean of the window around it times
+ adaptive_threshold
+ @param pix the input ho_pixbuf
+ @param threshold the minimal threshold to use 0..100
+ @param size window size
+ @param adaptive_threshold the percent of the window mean to use 0..100 (0-auto)
+ @return newly allocated b/w ho_bitmap
+ */
+ho_bitmap *ho_pixbuf_to_bitmap_bradley (const ho_pixbuf * pix,
+  unsigned char threshold,
+  unsigned char size, unsigned char adaptive_threshold);
+
+/**
+ convert a gray pixbuf to bitmap using sauvola thresholding, the window
+ threshold is mean * (1 + k * (deviation / 128 - 1))
+ @param pix the input ho_pixbuf
+ @param threshold the minimal threshold to use 0..100
+ @param size window size
+ @param adaptive_threshold k in percent 0..100 (0-auto)
+ @return newly allocated b/w ho_bitmap
+ */
+ho_bitmap *ho_pixbuf_to_bitmap_sauvola (const ho_pixbuf * pix,
+  unsigned char threshold,
+  unsigned char size, unsigned char adaptive_threshold);
+
+/**
+ get a global threshold for a pixbuf by otsu's method, color pixbufs are
+ converted to gray
+ @param pix the input ho_pixbuf
+ @return the threshold 1..255, grays below it are black, 0 on error
+ */
+unsigned char ho_pixbuf_otsu_threshold (const ho_pixbuf * pix);
+
+/**
+ convert a gray or color pixbuf to bitmap using a global threshold
+ @param pix the input ho_pixbuf
+ @param threshold the threshold to use 0..100 (0-otsu)
+ @return newly allocated b/w ho_bitmap
+ */
+ho_bitmap *ho_pixbuf_to_bitmap_otsu (const ho_pixbuf * pix,
+  unsigned char threshold);
+
 ho_bitmap* ho_pixbuf_to_bitmap_wrapper( const ho_pixbuf * pix_in, HEBOCR_IMAGE_OPTIONS *image_options, size_t size );
 
 /**
@@ -482,6 +538,21 @@ ho_pixbuf_draw_bitmap_at (ho_pixbuf * m, const ho_bitmap * bit_in,
  */
 ho_pixbuf *ho_pixbuf_pnm_load (const char *filename);
 
+/**
+ read ho_pixbuf from pnm file 1, 8 or 24 bpp, the file is mapped to memory 
+ and 8 and 24 bpp pixels are used in place without copying
+ @param filename file name of pnm file 
+ @return newly allocated ho_pixbuf
+ */
+ho_pixbuf *ho_pixbuf_pnm_map (const char *filename);
+
+/**
+ read ho_bitmap from a 1 bpp pnm (P4) file
+ @param filename file name of pnm file 
+ @return newly allocated ho_bitmap, NULL if file is not a P4 file
+ */
+ho_bitmap *ho_pixbuf_pnm_load_bitmap (const char *filename);
+
 /**
  writes ho_pixbuf to pnm file
  @param pix ho_pixbuf 8 or 24 bpp
@@ -505,4 +576,54 @@ ho_pixbuf *ho_pixbuf_bw_tiff_load (const char *filename);
  */
 int ho_pixbuf_bw_tiff_save (const ho_pixbuf * pix, const char *filename);
 
+/** @struct ho_pixbuf_tiff_reader
+  @brief page by page reader of a multi page tiff file
+*/
+typedef struct ho_pixbuf_tiff_reader ho_pixbuf_tiff_reader;
+
+/**
+ open a tiff file for reading page by page
+ @param filename file name of tiff file 
+ @param prefetch if TRUE decode the next page in the background while the
+  user works on the current one
+ @return newly allocated ho_pixbuf_tiff_reader
+ */
+ho_pixbuf_tiff_reader *ho_pixbuf_tiff_reader_new (const char *filename,
+  const unsigned char prefetch);
+
+/**
+ number of pages in a tiff file
+ @param reader the ho_pixbuf_tiff_reader
+ @return number of pages
+ */
+int ho_pixbuf_tiff_reader_n_pages (const ho_pixbuf_tiff_reader * reader);
+
+/**
+ get the next page of a tiff file, 1 bpp pages are returned as a bitmap,
+ gray pages as a gray pixbuf and other pages as a color pixbuf
+ @param reader the ho_pixbuf_tiff_reader
+ @param m_out a pointer to the newly allocated bitmap of the page or NULL
+ @param pix_out a pointer to the newly allocated pixbuf of the page or NULL
+ @return FALSE if a page was read, TRUE at end of file or if the page
+  could not be decoded, use ho_pixbuf_tiff_reader_failed to tell them apart
+ */
+int ho_pixbuf_tiff_reader_next (ho_pixbuf_tiff_reader * reader,
+  ho_bitmap ** m_out, ho_pixbuf ** pix_out);
+
+/**
+ did the last ho_pixbuf_tiff_reader_next fail to decode a page, the next
+ call goes on to the following page
+ @param reader the ho_pixbuf_tiff_reader
+ @return TRUE if the last page could not be decoded, FALSE if it was read
+  or if there are no more pages
+ */
+int ho_pixbuf_tiff_reader_failed (const ho_pixbuf_tiff_reader * reader);
+
+/**
+ free a ho_pixbuf_tiff_reader and close its file
+ @param reader the ho_pixbuf_tiff_reader
+ @return FALSE
+ */
+int ho_pixbuf_tiff_reader_free (ho_pixbuf_tiff_reader * reader);
+
 #endif /* HO_PIXBUF_H */
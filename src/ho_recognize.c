@@ -60,8 +60,7 @@ ho_recognize_array_out_size ()
 }
 
 int
-ho_recognize_dimentions (const ho_bitmap * m_text,
-  const ho_bitmap * m_mask, double *height,
+ho_recognize_glyph_dimentions (ho_glyph_ctx * glyph, double *height,
   double *width, double *top, double *bottom,
   double *top_left, double *top_mid, double *top_right,
   double *mid_left, double *mid_right,
@@ -71,6 +70,8 @@ ho_recognize_dimentions (const ho_bitmap * m_text,
   double *has_two_hlines_down,
   double *has_three_hlines_up, double *has_three_hlines_down)
 {
+  const ho_bitmap *m_text = glyph->m_text;
+  const ho_bitmap *m_mask = glyph->m_mask;
   int sum, x, y;
 
   int font_start;
@@ -88,24 +89,13 @@ ho_recognize_dimentions (const ho_bitmap * m_text,
   ho_bitmap *m_clean = NULL;
 
   /* get line start and end */
-  x = m_mask->width / 2;
-  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
-  line_start = y - 1;
-  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
-  line_end = y;
-  line_height = line_end - line_start;
+  line_start = glyph->line_start;
+  line_end = glyph->line_end;
+  line_height = glyph->line_height;
 
   /* get font start and end */
-  sum = 0;
-  for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_start = y - 1;
-  sum = 0;
-  for (y = m_mask->height - 4; y > font_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_end = y + 1;
+  font_start = glyph->font_start;
+  font_end = glyph->font_end;
   font_height = font_end - font_start;
 
   if (!font_height || !line_height)
@@ -264,13 +254,41 @@ ho_recognize_dimentions (const ho_bitmap * m_text,
 }
 
 int
-ho_recognize_bars (const ho_bitmap * m_text,
-  const ho_bitmap * m_mask, double *has_top_bar,
+ho_recognize_dimentions (const ho_bitmap * m_text,
+  const ho_bitmap * m_mask, double *height,
+  double *width, double *top, double *bottom,
+  double *top_left, double *top_mid, double *top_right,
+  double *mid_left, double *mid_right,
+  double *bottom_left, double *bottom_mid,
+  double *bottom_right, double *has_two_hlines_up,
+  double *has_two_hlines_down,
+  double *has_three_hlines_up, double *has_three_hlines_down)
+{
+  ho_glyph_ctx *glyph = NULL;
+  int return_val;
+
+  glyph = ho_glyph_ctx_new (m_text, m_mask);
+  if (!glyph)
+    return TRUE;
+
+  return_val = ho_recognize_glyph_dimentions (glyph, height, width, top,
+    bottom, top_left, top_mid, top_right, mid_left, mid_right, bottom_left,
+    bottom_mid, bottom_right, has_two_hlines_up, has_two_hlines_down,
+    has_three_hlines_up, has_three_hlines_down);
+  ho_glyph_ctx_free (glyph);
+
+  return return_val;
+}
+
+int
+ho_recognize_glyph_bars (ho_glyph_ctx * glyph, double *has_top_bar,
   double *has_mid_hbar, double *has_bottom_bar, double *has_left_bar,
   double *has_mid_vbar, double *has_right_bar, double *has_diagonal_bar,
   double *has_diagonal_left_bar)
 {
-  int sum, x, y;
+  const ho_bitmap *m_text = glyph->m_text;
+  const ho_bitmap *m_mask = glyph->m_mask;
+  int x, y;
 
   int font_start;
 
@@ -278,10 +296,6 @@ ho_recognize_bars (const ho_bitmap * m_text,
 
   int font_height;
 
-  int line_start;
-
-  int line_end;
-
   int line_height;
 
   ho_bitmap *m_bars = NULL;
@@ -295,25 +309,12 @@ ho_recognize_bars (const ho_bitmap * m_text,
   *has_diagonal_bar = 0.0;
   *has_diagonal_left_bar = 0.0;
 
-  /* get line start and end */
-  x = m_mask->width / 2;
-  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
-  line_start = y - 1;
-  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
-  line_end = y;
-  line_height = line_end - line_start;
+  /* get line height */
+  line_height = glyph->line_height;
 
   /* get font start and end */
-  sum = 0;
-  for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_start = y - 1;
-  sum = 0;
-  for (y = m_mask->height - 4; y > font_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_end = y + 1;
+  font_start = glyph->font_start;
+  font_end = glyph->font_end;
   font_height = font_end - font_start;
 
   if (!font_height || !line_height)
@@ -402,8 +403,29 @@ ho_recognize_bars (const ho_bitmap * m_text,
 }
 
 int
-ho_recognize_edges (const ho_bitmap * m_text,
-  const ho_bitmap * m_mask,
+ho_recognize_bars (const ho_bitmap * m_text,
+  const ho_bitmap * m_mask, double *has_top_bar,
+  double *has_mid_hbar, double *has_bottom_bar, double *has_left_bar,
+  double *has_mid_vbar, double *has_right_bar, double *has_diagonal_bar,
+  double *has_diagonal_left_bar)
+{
+  ho_glyph_ctx *glyph = NULL;
+  int return_val;
+
+  glyph = ho_glyph_ctx_new (m_text, m_mask);
+  if (!glyph)
+    return TRUE;
+
+  return_val = ho_recognize_glyph_bars (glyph, has_top_bar, has_mid_hbar,
+    has_bottom_bar, has_left_bar, has_mid_vbar, has_right_bar,
+    has_diagonal_bar, has_diagonal_left_bar);
+  ho_glyph_ctx_free (glyph);
+
+  return return_val;
+}
+
+int
+ho_recognize_glyph_edges (ho_glyph_ctx * glyph,
   double *has_top_left_edge,
   double *has_mid_left_edge,
   double *has_bottom_left_edge,
@@ -416,7 +438,9 @@ ho_recognize_edges (const ho_bitmap * m_text,
   double *has_left_bottom_edge,
   double *has_mid_bottom_edge, double *has_right_bottom_edge)
 {
-  int sum, x, y;
+  const ho_bitmap *m_text = glyph->m_text;
+  const ho_bitmap *m_mask = glyph->m_mask;
+  int x, y;
 
   int font_start;
 
@@ -424,10 +448,6 @@ ho_recognize_edges (const ho_bitmap * m_text,
 
   int font_height;
 
-  int line_start;
-
-  int line_end;
-
   int line_height;
 
   ho_bitmap *m_bars = NULL;
@@ -445,25 +465,12 @@ ho_recognize_edges (const ho_bitmap * m_text,
   *has_mid_bottom_edge = 0.0;
   *has_right_bottom_edge = 0.0;
 
-  /* get line start and end */
-  x = m_mask->width / 2;
-  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
-  line_start = y - 1;
-  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
-  line_end = y;
-  line_height = line_end - line_start;
+  /* get line height */
+  line_height = glyph->line_height;
 
   /* get font start and end */
-  sum = 0;
-  for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_start = y - 1;
-  sum = 0;
-  for (y = m_mask->height - 4; y > font_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_end = y + 1;
+  font_start = glyph->font_start;
+  font_end = glyph->font_end;
   font_height = font_end - font_start;
 
   if (!font_height || !line_height)
@@ -581,7 +588,7 @@ ho_recognize_edges (const ho_bitmap * m_text,
 }
 
 int
-ho_recognize_edges_big (const ho_bitmap * m_text,
+ho_recognize_edges (const ho_bitmap * m_text,
   const ho_bitmap * m_mask,
   double *has_top_left_edge,
   double *has_mid_left_edge,
@@ -595,7 +602,40 @@ ho_recognize_edges_big (const ho_bitmap * m_text,
   double *has_left_bottom_edge,
   double *has_mid_bottom_edge, double *has_right_bottom_edge)
 {
-  int sum, x, y;
+  ho_glyph_ctx *glyph = NULL;
+  int return_val;
+
+  glyph = ho_glyph_ctx_new (m_text, m_mask);
+  if (!glyph)
+    return TRUE;
+
+  return_val = ho_recognize_glyph_edges (glyph, has_top_left_edge,
+    has_mid_left_edge, has_bottom_left_edge, has_top_right_edge,
+    has_mid_right_edge, has_bottom_right_edge, has_left_top_edge,
+    has_mid_top_edge, has_right_top_edge, has_left_bottom_edge,
+    has_mid_bottom_edge, has_right_bottom_edge);
+  ho_glyph_ctx_free (glyph);
+
+  return return_val;
+}
+
+int
+ho_recognize_glyph_edges_big (ho_glyph_ctx * glyph,
+  double *has_top_left_edge,
+  double *has_mid_left_edge,
+  double *has_bottom_left_edge,
+  double *has_top_right_edge,
+  double *has_mid_right_edge,
+  double *has_bottom_right_edge,
+  double *has_left_top_edge,
+  double *has_mid_top_edge,
+  double *has_right_top_edge,
+  double *has_left_bottom_edge,
+  double *has_mid_bottom_edge, double *has_right_bottom_edge)
+{
+  const ho_bitmap *m_text = glyph->m_text;
+  const ho_bitmap *m_mask = glyph->m_mask;
+  int x, y;
 
   int font_start;
 
@@ -603,10 +643,6 @@ ho_recognize_edges_big (const ho_bitmap * m_text,
 
   int font_height;
 
-  int line_start;
-
-  int line_end;
-
   int line_height;
 
   ho_bitmap *m_bars = NULL;
@@ -624,25 +660,12 @@ ho_recognize_edges_big (const ho_bitmap * m_text,
   *has_mid_bottom_edge = 0.0;
   *has_right_bottom_edge = 0.0;
 
-  /* get line start and end */
-  x = m_mask->width / 2;
-  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
-  line_start = y - 1;
-  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
-  line_end = y;
-  line_height = line_end - line_start;
+  /* get line height */
+  line_height = glyph->line_height;
 
   /* get font start and end */
-  sum = 0;
-  for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_start = y - 1;
-  sum = 0;
-  for (y = m_mask->height - 4; y > font_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_end = y + 1;
+  font_start = glyph->font_start;
+  font_end = glyph->font_end;
   font_height = font_end - font_start;
 
   if (!font_height || !line_height)
@@ -760,8 +783,39 @@ ho_recognize_edges_big (const ho_bitmap * m_text,
 }
 
 int
-ho_recognize_notches (const ho_bitmap * m_text,
+ho_recognize_edges_big (const ho_bitmap * m_text,
   const ho_bitmap * m_mask,
+  double *has_top_left_edge,
+  double *has_mid_left_edge,
+  double *has_bottom_left_edge,
+  double *has_top_right_edge,
+  double *has_mid_right_edge,
+  double *has_bottom_right_edge,
+  double *has_left_top_edge,
+  double *has_mid_top_edge,
+  double *has_right_top_edge,
+  double *has_left_bottom_edge,
+  double *has_mid_bottom_edge, double *has_right_bottom_edge)
+{
+  ho_glyph_ctx *glyph = NULL;
+  int return_val;
+
+  glyph = ho_glyph_ctx_new (m_text, m_mask);
+  if (!glyph)
+    return TRUE;
+
+  return_val = ho_recognize_glyph_edges_big (glyph, has_top_left_edge,
+    has_mid_left_edge, has_bottom_left_edge, has_top_right_edge,
+    has_mid_right_edge, has_bottom_right_edge, has_left_top_edge,
+    has_mid_top_edge, has_right_top_edge, has_left_bottom_edge,
+    has_mid_bottom_edge, has_right_bottom_edge);
+  ho_glyph_ctx_free (glyph);
+
+  return return_val;
+}
+
+int
+ho_recognize_glyph_notches (ho_glyph_ctx * glyph,
   double *has_top_left_notch,
   double *has_mid_left_notch,
   double *has_bottom_left_notch,
@@ -774,7 +828,9 @@ ho_recognize_notches (const ho_bitmap * m_text,
   double *has_left_bottom_notch,
   double *has_mid_bottom_notch, double *has_right_bottom_notch)
 {
-  int sum, x, y;
+  const ho_bitmap *m_text = glyph->m_text;
+  const ho_bitmap *m_mask = glyph->m_mask;
+  int x, y;
 
   int font_start;
 
@@ -782,10 +838,6 @@ ho_recognize_notches (const ho_bitmap * m_text,
 
   int font_height;
 
-  int line_start;
-
-  int line_end;
-
   int line_height;
 
   ho_bitmap *m_bars = NULL;
@@ -803,25 +855,12 @@ ho_recognize_notches (const ho_bitmap * m_text,
   *has_mid_bottom_notch = 0.0;
   *has_right_bottom_notch = 0.0;
 
-  /* get line start and end */
-  x = m_mask->width / 2;
-  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
-  line_start = y - 1;
-  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
-  line_end = y;
-  line_height = line_end - line_start;
+  /* get line height */
+  line_height = glyph->line_height;
 
   /* get font start and end */
-  sum = 0;
-  for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_start = y - 1;
-  sum = 0;
-  for (y = m_mask->height - 4; y > font_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_end = y + 1;
+  font_start = glyph->font_start;
+  font_end = glyph->font_end;
   font_height = font_end - font_start;
 
   if (!font_height || !line_height)
@@ -937,8 +976,39 @@ ho_recognize_notches (const ho_bitmap * m_text,
 }
 
 int
-ho_recognize_parts (const ho_bitmap * m_text,
-  const ho_bitmap * m_mask, double *has_one_hole,
+ho_recognize_notches (const ho_bitmap * m_text,
+  const ho_bitmap * m_mask,
+  double *has_top_left_notch,
+  double *has_mid_left_notch,
+  double *has_bottom_left_notch,
+  double *has_top_right_notch,
+  double *has_mid_right_notch,
+  double *has_bottom_right_notch,
+  double *has_left_top_notch,
+  double *has_mid_top_notch,
+  double *has_right_top_notch,
+  double *has_left_bottom_notch,
+  double *has_mid_bottom_notch, double *has_right_bottom_notch)
+{
+  ho_glyph_ctx *glyph = NULL;
+  int return_val;
+
+  glyph = ho_glyph_ctx_new (m_text, m_mask);
+  if (!glyph)
+    return TRUE;
+
+  return_val = ho_recognize_glyph_notches (glyph, has_top_left_notch,
+    has_mid_left_notch, has_bottom_left_notch, has_top_right_notch,
+    has_mid_right_notch, has_bottom_right_notch, has_left_top_notch,
+    has_mid_top_notch, has_right_top_notch, has_left_bottom_notch,
+    has_mid_bottom_notch, has_right_bottom_notch);
+  ho_glyph_ctx_free (glyph);
+
+  return return_val;
+}
+
+int
+ho_recognize_glyph_parts (ho_glyph_ctx * glyph, double *has_one_hole,
   double *has_two_holes, double *has_hey_part,
   double *has_dot_part, double *has_comma_part)
 {
@@ -950,10 +1020,6 @@ ho_recognize_parts (const ho_bitmap * m_text,
 
   int font_height;
 
-  int line_start;
-
-  int line_end;
-
   int line_height;
 
   int parts_start;
@@ -970,46 +1036,27 @@ ho_recognize_parts (const ho_bitmap * m_text,
   *has_dot_part = 0.0;
   *has_comma_part = 0.0;
 
-  /* get line start and end */
-  x = m_mask->width / 2;
-  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
-  line_start = y - 1;
-  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
-  line_end = y;
-  line_height = line_end - line_start;
+  /* get line height */
+  line_height = glyph->line_height;
 
   /* get font start and end */
-  sum = 0;
-  for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_start = y - 1;
-  sum = 0;
-  for (y = m_mask->height - 4; y > font_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_end = y + 1;
+  font_start = glyph->font_start;
+  font_end = glyph->font_end;
   font_height = font_end - font_start;
 
   if (!font_height || !line_height)
     return TRUE;
 
   /* holes */
-  m_parts = ho_font_holes (m_text, m_mask);
-  if (m_parts)
-  {
-    sum = ho_bitmap_filter_count_objects (m_parts);
-    if (sum == 1)
-      *has_one_hole = 1.0;
-    else if (sum == 2)
-      *has_two_holes = 1.0;
-  }
+  sum = ho_glyph_ctx_get_n_holes (glyph);
+  if (sum == 1)
+    *has_one_hole = 1.0;
+  else if (sum == 2)
+    *has_two_holes = 1.0;
 
   /* hey and kuf part */
 
-  if (m_parts)
-    ho_bitmap_free (m_parts);
-  m_parts = ho_font_second_object (m_text, m_mask);
+  m_parts = ho_font_glyph_second_object (glyph);
   if (m_parts)
   {
     /* get font start and end */
@@ -1060,8 +1107,27 @@ ho_recognize_parts (const ho_bitmap * m_text,
 }
 
 int
-ho_recognize_ends (const ho_bitmap * m_text,
-  const ho_bitmap * m_mask,
+ho_recognize_parts (const ho_bitmap * m_text,
+  const ho_bitmap * m_mask, double *has_one_hole,
+  double *has_two_holes, double *has_hey_part,
+  double *has_dot_part, double *has_comma_part)
+{
+  ho_glyph_ctx *glyph = NULL;
+  int return_val;
+
+  glyph = ho_glyph_ctx_new (m_text, m_mask);
+  if (!glyph)
+    return TRUE;
+
+  return_val = ho_recognize_glyph_parts (glyph, has_one_hole, has_two_holes,
+    has_hey_part, has_dot_part, has_comma_part);
+  ho_glyph_ctx_free (glyph);
+
+  return return_val;
+}
+
+int
+ho_recognize_glyph_ends (ho_glyph_ctx * glyph,
   double *has_top_left_end,
   double *has_top_mid_end,
   double *has_top_right_end,
@@ -1088,10 +1154,6 @@ ho_recognize_ends (const ho_bitmap * m_text,
 
   int font_height;
 
-  int line_start;
-
-  int line_end;
-
   int line_height;
 
   ho_bitmap *m_parts = NULL;
@@ -1121,25 +1183,12 @@ ho_recognize_ends (const ho_bitmap * m_text,
   *has_bottom_mid_cross = 0.0;
   *has_bottom_right_cross = 0.0;
 
-  /* get line start and end */
-  x = m_mask->width / 2;
-  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
-  line_start = y - 1;
-  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
-  line_end = y;
-  line_height = line_end - line_start;
+  /* get line height */
+  line_height = glyph->line_height;
 
   /* get font start and end */
-  sum = 0;
-  for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_start = y - 1;
-  sum = 0;
-  for (y = m_mask->height - 4; y > font_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_text, x, y);
-  font_end = y + 1;
+  font_start = glyph->font_start;
+  font_end = glyph->font_end;
   if (font_start < 1)
     font_start = 1;
 
@@ -1149,7 +1198,7 @@ ho_recognize_ends (const ho_bitmap * m_text,
     return TRUE;
 
   /* ends */
-  m_parts = ho_font_ends (m_text, m_mask);
+  m_parts = ho_font_glyph_ends (glyph);
   if (!m_parts)
     return TRUE;
 
@@ -1224,7 +1273,7 @@ ho_recognize_ends (const ho_bitmap * m_text,
 
   /* crosses */
   ho_bitmap_free (m_parts);
-  m_parts = ho_font_cross (m_text, m_mask);
+  m_parts = ho_font_glyph_cross (glyph);
   if (!m_parts)
     return TRUE;
 
@@ -1303,12 +1352,53 @@ ho_recognize_ends (const ho_bitmap * m_text,
 }
 
 int
-ho_recognize_holes_dimentions (const ho_bitmap * m_text,
-  const ho_bitmap * m_mask, double *height,
+ho_recognize_ends (const ho_bitmap * m_text,
+  const ho_bitmap * m_mask,
+  double *has_top_left_end,
+  double *has_top_mid_end,
+  double *has_top_right_end,
+  double *has_mid_left_end,
+  double *has_mid_mid_end,
+  double *has_mid_right_end,
+  double *has_bottom_left_end,
+  double *has_bottom_mid_end,
+  double *has_bottom_right_end,
+  double *has_top_left_cross,
+  double *has_top_mid_cross,
+  double *has_top_right_cross,
+  double *has_mid_left_cross,
+  double *has_mid_mid_cross,
+  double *has_mid_right_cross,
+  double *has_bottom_left_cross,
+  double *has_bottom_mid_cross, double *has_bottom_right_cross)
+{
+  ho_glyph_ctx *glyph = NULL;
+  int return_val;
+
+  glyph = ho_glyph_ctx_new (m_text, m_mask);
+  if (!glyph)
+    return TRUE;
+
+  return_val = ho_recognize_glyph_ends (glyph, has_top_left_end,
+    has_top_mid_end, has_top_right_end, has_mid_left_end, has_mid_mid_end,
+    has_mid_right_end, has_bottom_left_end, has_bottom_mid_end,
+    has_bottom_right_end, has_top_left_cross, has_top_mid_cross,
+    has_top_right_cross, has_mid_left_cross, has_mid_mid_cross,
+    has_mid_right_cross, has_bottom_left_cross, has_bottom_mid_cross,
+    has_bottom_right_cross);
+  ho_glyph_ctx_free (glyph);
+
+  return return_val;
+}
+
+int
+ho_recognize_glyph_holes_dimentions (ho_glyph_ctx * glyph, double *height,
   double *width, double *top, double *bottom,
   double *top_left, double *top_right,
   double *bottom_left, double *bottom_right)
 {
+  const ho_bitmap *m_text = glyph->m_text;
+  const ho_bitmap *m_mask = glyph->m_mask;
   int sum, x, y;
 
   int font_start;
@@ -1329,7 +1419,7 @@ ho_recognize_holes_dimentions (const ho_bitmap * m_text,
 
   int line_height;
 
-  ho_bitmap *m_holes = NULL;
+  const ho_bitmap *m_holes = NULL;
 
   *height = 0.0;
   *width = 0.0;
@@ -1340,41 +1430,32 @@ ho_recognize_holes_dimentions (const ho_bitmap * m_text,
   *bottom_left = 0.0;
   *bottom_right = 0.0;
 
-  m_holes = ho_font_holes (m_text, m_mask);
+  m_holes = ho_glyph_ctx_get_holes (glyph);
   if (!m_holes)
     return TRUE;
 
-  sum = ho_bitmap_filter_count_objects (m_holes);
-  if (sum > 2 || sum < 1) {
-    ho_bitmap_free(m_holes);
+  sum = ho_glyph_ctx_get_n_holes (glyph);
+  if (sum > 2 || sum < 1)
     return TRUE;
-  }
 
   /* get line start and end */
-  x = m_mask->width / 2;
-  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
-  line_start = y - 1;
-  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
-  line_end = y;
-  line_height = line_end - line_start;
+  line_start = glyph->line_start;
+  line_end = glyph->line_end;
+  line_height = glyph->line_height;
 
   /* get font start and end */
   sum = 0;
   for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_holes, x, y);
+    sum = ho_bitmap_count_row (m_holes, 0, y, m_text->width);
   font_start = y - 1;
   sum = 0;
   for (y = m_mask->height - 4; y > font_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_holes, x, y);
+    sum = ho_bitmap_count_row (m_holes, 0, y, m_text->width);
   font_end = y + 1;
   font_height = font_end - font_start;
 
-  if (!font_height || !line_height) {
-    ho_bitmap_free(m_holes);
+  if (!font_height || !line_height)
     return TRUE;
-  }
 
   sum = 0;
   for (x = 0; x < m_mask->width && sum == 0; x++)
@@ -1388,10 +1469,8 @@ ho_recognize_holes_dimentions (const ho_bitmap * m_text,
   font_end_x = x + 1;
   font_width = font_end_x - font_start_x;
 
-  if (!font_width) {
-    ho_bitmap_free(m_holes);
+  if (!font_width)
     return TRUE;
-  }
 
   *height = (double) font_height / (double) line_height;
   *width = (double) font_width / (double) line_height;
@@ -1478,13 +1557,32 @@ ho_recognize_holes_dimentions (const ho_bitmap * m_text,
   if (*bottom_right > 1.0)
     *bottom_right = 1.0;
 
-  ho_bitmap_free(m_holes);
   return FALSE;
 }
 
 int
-ho_recognize_holes_edges (const ho_bitmap * m_text,
-  const ho_bitmap * m_mask,
+ho_recognize_holes_dimentions (const ho_bitmap * m_text,
+  const ho_bitmap * m_mask, double *height,
+  double *width, double *top, double *bottom,
+  double *top_left, double *top_right,
+  double *bottom_left, double *bottom_right)
+{
+  ho_glyph_ctx *glyph = NULL;
+  int return_val;
+
+  glyph = ho_glyph_ctx_new (m_text, m_mask);
+  if (!glyph)
+    return TRUE;
+
+  return_val = ho_recognize_glyph_holes_dimentions (glyph, height, width, top,
+    bottom, top_left, top_right, bottom_left, bottom_right);
+  ho_glyph_ctx_free (glyph);
+
+  return return_val;
+}
+
+int
+ho_recognize_glyph_holes_edges (ho_glyph_ctx * glyph,
   double *has_top_left_edge,
   double *has_mid_left_edge,
   double *has_bottom_left_edge,
@@ -1497,6 +1595,8 @@ ho_recognize_holes_edges (const ho_bitmap * m_text,
   double *has_left_bottom_edge,
   double *has_mid_bottom_edge, double *has_right_bottom_edge)
 {
+  const ho_bitmap *m_text = glyph->m_text;
+  const ho_bitmap *m_mask = glyph->m_mask;
   int sum, x, y;
 
   int font_start;
@@ -1511,15 +1611,11 @@ ho_recognize_holes_edges (const ho_bitmap * m_text,
 
   int font_width;
 
-  int line_start;
-
-  int line_end;
-
   int line_height;
 
   ho_bitmap *m_bars = NULL;
 
-  ho_bitmap *m_holes = NULL;
+  const ho_bitmap *m_holes = NULL;
 
   *has_top_left_edge = 0.0;
   *has_mid_left_edge = 0.0;
@@ -1534,41 +1630,30 @@ ho_recognize_holes_edges (const ho_bitmap * m_text,
   *has_mid_bottom_edge = 0.0;
   *has_right_bottom_edge = 0.0;
 
-  m_holes = ho_font_holes (m_text, m_mask);
+  m_holes = ho_glyph_ctx_get_holes (glyph);
   if (!m_holes)
     return TRUE;
 
-  sum = ho_bitmap_filter_count_objects (m_holes);
-  if (sum > 2 || sum < 1) {
-    ho_bitmap_free(m_holes);
+  sum = ho_glyph_ctx_get_n_holes (glyph);
+  if (sum > 2 || sum < 1)
     return TRUE;
-  }
 
-  /* get line start and end */
-  x = m_mask->width / 2;
-  for (y = 0; y < m_mask->height && !ho_bitmap_get (m_mask, x, y); y++) ;
-  line_start = y - 1;
-  for (; y < m_mask->height && ho_bitmap_get (m_mask, x, y); y++) ;
-  line_end = y;
-  line_height = line_end - line_start;
+  /* get line height */
+  line_height = glyph->line_height;
 
   /* get font start and end */
   sum = 0;
   for (y = 0; y < m_mask->height && sum == 0; y++)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_holes, x, y);
+    sum = ho_bitmap_count_row (m_holes, 0, y, m_text->width);
   font_start = y - 1;
   sum = 0;
   for (y = m_mask->height - 4; y > font_start && sum == 0; y--)
-    for (sum = 0, x = 0; x < m_text->width; x++)
-      sum += ho_bitmap_get (m_holes, x, y);
+    sum = ho_bitmap_count_row (m_holes, 0, y, m_text->width);
   font_end = y + 1;
   font_height = font_end - font_start;
 
-  if (!font_height || !line_height) {
-    ho_bitmap_free(m_holes);
+  if (!font_height || !line_height)
     return TRUE;
-  }
 
   sum = 0;
   for (x = 0; x < m_mask->width && sum == 0; x++)
@@ -1582,17 +1667,13 @@ ho_recognize_holes_edges (const ho_bitmap * m_text,
   font_end_x = x + 1;
   font_width = font_end_x - font_start_x;
 
-  if (!font_width) {
-    ho_bitmap_free(m_holes);
+  if (!font_width)
     return TRUE;
-  }
 
   /* get horizontal left egdes */
   m_bars = ho_font_edges_left (m_holes, m_mask);
-  if (!m_bars) {
-    ho_bitmap_free(m_holes);
+  if (!m_bars)
     return TRUE;
-  }
 
   /* look for a horizontal line in bitmap */
   x = m_bars->width / 2;
@@ -1618,10 +1699,8 @@ ho_recognize_holes_edges (const ho_bitmap * m_text,
   /* get horizontal right edges */
   ho_bitmap_free (m_bars);
   m_bars = ho_font_edges_right (m_holes, m_mask);
-  if (!m_bars) {
-    ho_bitmap_free(m_holes);
+  if (!m_bars)
     return TRUE;
-  }
 
   /* look for a horizontal line in bitmap */
   x = m_bars->width / 2;
@@ -1646,10 +1725,8 @@ ho_recognize_holes_edges (const ho_bitmap * m_text,
 
   ho_bitmap_free (m_bars);
   m_bars = ho_font_edges_top (m_holes, m_mask);
-  if (!m_bars) {
-    ho_bitmap_free(m_holes);
+  if (!m_bars)
     return TRUE;
-  }
 
   /* look for a vertical line in bitmap */
   y = m_bars->height / 2;
@@ -1675,10 +1752,8 @@ ho_recognize_holes_edges (const ho_bitmap * m_text,
   /* get horizontal right edges */
   ho_bitmap_free (m_bars);
   m_bars = ho_font_edges_bottom (m_holes, m_mask);
-  if (!m_bars) {
-    ho_bitmap_free(m_holes);
+  if (!m_bars)
     return TRUE;
-  }
 
   /* look for a vertical line in bitmap */
   y = m_bars->height / 2;
@@ -1706,6 +1781,38 @@ ho_recognize_holes_edges (const ho_bitmap * m_text,
   return FALSE;
 }
 
+int
+ho_recognize_holes_edges (const ho_bitmap * m_text,
+  const ho_bitmap * m_mask,
+  double *has_top_left_edge,
+  double *has_mid_left_edge,
+  double *has_bottom_left_edge,
+  double *has_top_right_edge,
+  double *has_mid_right_edge,
+  double *has_bottom_right_edge,
+  double *has_left_top_edge,
+  double *has_mid_top_edge,
+  double *has_right_top_edge,
+  double *has_left_bottom_edge,
+  double *has_mid_bottom_edge, double *has_right_bottom_edge)
+{
+  ho_glyph_ctx *glyph = NULL;
+  int return_val;
+
+  glyph = ho_glyph_ctx_new (m_text, m_mask);
+  if (!glyph)
+    return TRUE;
+
+  return_val = ho_recognize_glyph_holes_edges (glyph, has_top_left_edge,
+    has_mid_left_edge, has_bottom_left_edge, has_top_right_edge,
+    has_mid_right_edge, has_bottom_right_edge, has_left_top_edge,
+    has_mid_top_edge, has_right_top_edge, has_left_bottom_edge,
+    has_mid_bottom_edge, has_right_bottom_edge);
+  ho_glyph_ctx_free (glyph);
+
+  return return_val;
+}
+
 int
 ho_recognize_create_array_in (const ho_bitmap * m_text,
   const ho_bitmap * m_mask, double *array_in)
@@ -1854,13 +1961,20 @@ ho_recognize_create_array_in (const ho_bitmap * m_text,
 
   double has_bottom_right_cross;
 
+  ho_glyph_ctx *glyph = NULL;
+
   /* init values to zero, if some function fails */
   for (i = 0; i < HO_ARRAY_IN_SIZE; i++)
     array_in[i] = 0.0;
 
+  /* measure the font once, and share its images between the features */
+  glyph = ho_glyph_ctx_new (m_text, m_mask);
+  if (!glyph)
+    return TRUE;
+
   /* fill array with values */
 
-  ho_recognize_dimentions (m_text, m_mask,
+  ho_recognize_glyph_dimentions (glyph,
     &height, &width, &top, &bottom,
     &top_left, &top_mid, &top_right,
     &mid_left, &mid_right,
@@ -1889,7 +2003,7 @@ ho_recognize_create_array_in (const ho_bitmap * m_text,
   array_in[15] = has_three_hlines_up;
   array_in[16] = has_three_hlines_down;
 
-  ho_recognize_bars (m_text, m_mask,
+  ho_recognize_glyph_bars (glyph,
     &has_top_bar, &has_mid_hbar,
     &has_bottom_bar,
     &has_left_bar, &has_mid_vbar, &has_right_bar, &has_diagonal_bar,
@@ -1906,7 +2020,7 @@ ho_recognize_create_array_in (const ho_bitmap * m_text,
   array_in[23] = has_diagonal_bar;
   array_in[24] = has_diagonal_left_bar;
 
-  ho_recognize_edges (m_text, m_mask,
+  ho_recognize_glyph_edges (glyph,
     &has_top_left_edge,
     &has_mid_left_edge,
     &has_bottom_left_edge,
@@ -1934,8 +2048,7 @@ ho_recognize_create_array_in (const ho_bitmap * m_text,
   array_in[35] = has_mid_bottom_edge;
   array_in[36] = has_right_bottom_edge;
 
-  ho_recognize_notches (m_text,
-    m_mask,
+  ho_recognize_glyph_notches (glyph,
     &has_top_left_notch,
     &has_mid_left_notch,
     &has_bottom_left_notch,
@@ -1963,8 +2076,7 @@ ho_recognize_create_array_in (const ho_bitmap * m_text,
   array_in[47] = has_mid_bottom_notch;
   array_in[48] = has_right_bottom_notch;
 
-  ho_recognize_ends (m_text,
-    m_mask,
+  ho_recognize_glyph_ends (glyph,
     &has_top_left_end,
     &has_top_mid_end,
     &has_top_right_end,
@@ -2006,8 +2118,7 @@ ho_recognize_create_array_in (const ho_bitmap * m_text,
   array_in[65] = has_bottom_mid_cross;
   array_in[66] = has_bottom_right_cross;
 
-  ho_recognize_parts (m_text,
-    m_mask, &has_one_hole, &has_two_holes, &has_hey_part,
+  ho_recognize_glyph_parts (glyph, &has_one_hole, &has_two_holes, &has_hey_part,
     &has_dot_part, &has_comma_part);
 
   array_in[67] = has_one_hole;
@@ -2016,7 +2127,7 @@ ho_recognize_create_array_in (const ho_bitmap * m_text,
   array_in[70] = has_dot_part;
   array_in[71] = has_comma_part;
 
-  ho_recognize_holes_edges (m_text, m_mask,
+  ho_recognize_glyph_holes_edges (glyph,
     &has_top_left_edge,
     &has_mid_left_edge,
     &has_bottom_left_edge,
@@ -2044,7 +2155,7 @@ ho_recognize_create_array_in (const ho_bitmap * m_text,
   array_in[82] = has_mid_bottom_edge;
   array_in[83] = has_right_bottom_edge;
 
-  ho_recognize_holes_dimentions (m_text, m_mask,
+  ho_recognize_glyph_holes_dimentions (glyph,
     &height, &width, &top, &bottom,
     &top_left, &top_right, &bottom_left, &bottom_right);
 
@@ -2057,7 +2168,7 @@ ho_recognize_create_array_in (const ho_bitmap * m_text,
   array_in[90] = bottom_left;
   array_in[91] = bottom_right;
 
-  ho_recognize_edges_big (m_text, m_mask,
+  ho_recognize_glyph_edges_big (glyph,
     &has_top_left_edge,
     &has_mid_left_edge,
     &has_bottom_left_edge,
@@ -2085,6 +2196,8 @@ ho_recognize_create_array_in (const ho_bitmap * m_text,
   array_in[102] = has_mid_bottom_edge;
   array_in[103] = has_right_bottom_edge;
 
+  ho_glyph_ctx_free (glyph);
+
   return 0;
 }
 
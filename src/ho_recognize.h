@@ -33,6 +33,7 @@
 
 #include <ho_bitmap.h>
 #include <ho_objmap.h>
+#include <ho_font.h>
 
 #define HO_ARRAY_IN_SIZE 104
 #define HO_ARRAY_OUT_SIZE 51
@@ -170,4 +171,109 @@ ho_recognize_holes_edges (const ho_bitmap * m_text,
   double *has_left_bottom_edge,
   double *has_mid_bottom_edge, double *has_right_bottom_edge);
 
+/* the same features, read from a ho_glyph_ctx shared between them */
+
+int
+ho_recognize_glyph_dimentions (ho_glyph_ctx * glyph, double *height,
+  double *width, double *top, double *bottom,
+  double *top_left, double *top_mid, double *top_right,
+  double *mid_left, double *mid_right,
+  double *bottom_left, double *bottom_mid,
+  double *bottom_right, double *has_two_hlines_up,
+  double *has_two_hlines_down,
+  double *has_three_hlines_up, double *has_three_hlines_down);
+
+int
+ho_recognize_glyph_bars (ho_glyph_ctx * glyph, double *has_top_bar,
+  double *has_mid_hbar, double *has_bottom_bar, double *has_left_bar,
+  double *has_mid_vbar, double *has_right_bar, double *has_diagonal_bar,
+  double *has_diagonal_left_bar);
+
+int
+ho_recognize_glyph_edges (ho_glyph_ctx * glyph,
+  double *has_top_left_edge,
+  double *has_mid_left_edge,
+  double *has_bottom_left_edge,
+  double *has_top_right_edge,
+  double *has_mid_right_edge,
+  double *has_bottom_right_edge,
+  double *has_left_top_edge,
+  double *has_mid_top_edge,
+  double *has_right_top_edge,
+  double *has_left_bottom_edge,
+  double *has_mid_bottom_edge, double *has_right_bottom_edge);
+
+int
+ho_recognize_glyph_edges_big (ho_glyph_ctx * glyph,
+  double *has_top_left_edge,
+  double *has_mid_left_edge,
+  double *has_bottom_left_edge,
+  double *has_top_right_edge,
+  double *has_mid_right_edge,
+  double *has_bottom_right_edge,
+  double *has_left_top_edge,
+  double *has_mid_top_edge,
+  double *has_right_top_edge,
+  double *has_left_bottom_edge,
+  double *has_mid_bottom_edge, double *has_right_bottom_edge);
+
+int
+ho_recognize_glyph_notches (ho_glyph_ctx * glyph,
+  double *has_top_left_notch,
+  double *has_mid_left_notch,
+  double *has_bottom_left_notch,
+  double *has_top_right_notch,
+  double *has_mid_right_notch,
+  double *has_bottom_right_notch,
+  double *has_left_top_notch,
+  double *has_mid_top_notch,
+  double *has_right_top_notch,
+  double *has_left_bottom_notch,
+  double *has_mid_bottom_notch, double *has_right_bottom_notch);
+
+int
+ho_recognize_glyph_parts (ho_glyph_ctx * glyph, double *has_one_hole,
+  double *has_two_holes, double *has_hey_part,
+  double *has_dot_part, double *has_comma_part);
+
+int
+ho_recognize_glyph_ends (ho_glyph_ctx * glyph,
+  double *has_top_left_end,
+  double *has_top_mid_end,
+  double *has_top_right_end,
+  double *has_mid_left_end,
+  double *has_mid_mid_end,
+  double *has_mid_right_end,
+  double *has_bottom_left_end,
+  double *has_bottom_mid_end,
+  double *has_bottom_right_end,
+  double *has_top_left_cross,
+  double *has_top_mid_cross,
+  double *has_top_right_cross,
+  double *has_mid_left_cross,
+  double *has_mid_mid_cross,
+  double *has_mid_right_cross,
+  double *has_bottom_left_cross,
+  double *has_bottom_mid_cross, double *has_bottom_right_cross);
+
+int
+ho_recognize_glyph_holes_dimentions (ho_glyph_ctx * glyph, double *height,
+  double *width, double *top, double *bottom,
+  double *top_left, double *top_right,
+  double *bottom_left, double *bottom_right);
+
+int
+ho_recognize_glyph_holes_edges (ho_glyph_ctx * glyph,
+  double *has_top_left_edge,
+  double *has_mid_left_edge,
+  double *has_bottom_left_edge,
+  double *has_top_right_edge,
+  double *has_mid_right_edge,
+  double *has_bottom_right_edge,
+  double *has_left_top_edge,
+  double *has_mid_top_edge,
+  double *has_right_top_edge,
+  double *has_left_bottom_edge,
+  double *has_mid_bottom_edge, double *has_right_bottom_edge);
+
 #endif /* HO_RECOGNIZE_H */
@@ -125,7 +125,7 @@ ho_recognize_nikud_dimentions (const ho_bitmap * m_text,
   *font_width_by_height = (double) m_mask->width / (double) line_height;
 
   /* get all the objects of nikud */
-  o_obj = ho_objmap_new_from_bitmap (m_text);
+  o_obj = ho_objmap_new_from_bitmap_runs (m_text);
   if (!o_obj)
     return TRUE;
 
@@ -497,13 +497,15 @@ ho_segment_fonts (const ho_bitmap * m, const ho_bitmap * m_line_map,
   if (!line_fill)
     return NULL;
 
-  for (x = 0; x < m->width; x++)
-    for (y = line_start - lee_way; 
-         y < (line_end + lee_way) &&  y < m->height; y++)
+  if (ho_bitmap_count_columns (m, line_start - lee_way,
+      line_height + 2 * lee_way, line_fill))
   {
-      line_fill[x] += ho_bitmap_get (m, x, y);
-      avg_line_fill += ho_bitmap_get (m, x, y);
+    free (line_fill);
+    return NULL;
   }
+
+  for (x = 0; x < m->width; x++)
+    avg_line_fill += line_fill[x];
   
   avg_line_fill /= m->width;
   
@@ -553,7 +555,7 @@ ho_segment_fonts (const ho_bitmap * m, const ho_bitmap * m_line_map,
         m_font_temp =
           ho_bitmap_filter_by_size (m_font, m->font_height / 4,
           2 * m->font_height, m->font_width / 5, 3 * m->font_width);
-        o_obj = ho_objmap_new_from_bitmap (m_font_temp);
+        o_obj = ho_objmap_new_from_bitmap_runs (m_font_temp);
         ho_bitmap_free (m_font_temp);
 
         ho_objmap_sort_by_reading_index (o_obj, 255, FALSE);
@@ -635,7 +637,7 @@ ho_segment_fonts (const ho_bitmap * m, const ho_bitmap * m_line_map,
         m_font =
           ho_bitmap_clone_window (m_temp, font_start, 0,
           font_end - font_start, m->height);
-        o_obj = ho_objmap_new_from_bitmap (m_font);
+        o_obj = ho_objmap_new_from_bitmap_runs (m_font);
         ho_bitmap_free (m_font);
 
         /* check that it is not a long _ or - 's */
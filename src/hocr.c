@@ -22,18 +22,232 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+
 #include <ho_layout.h>
 #include <ho_dimentions.h>
 #include <ho_font.h>
 #include <ho_recognize.h>
 #include <ho_recognize_nikud.h>
+#include <ho_linguistics.h>
 
 #include "hebocr_globals.h"
 #include "hocr.h"
 
 
+/* deskew angles up to this many degrees are done by shears */
+#define HOCR_SHEAR_MAX_ANGLE 10.0
+
+/* guessed angles that stand out less than this are not trusted */
+#define HOCR_MIN_SKEW_CONFIDENCE 0.2
+
+/* 
+ * threads asked for by an options struct, callers that predate the threads
+ * fields may leave them unset, so values out of range use one thread 
+ */
+static int
+hocr_threads (const int threads)
+{
+  if (threads < 1 || threads > HEBOCR_MAX_THREADS)
+    return 1;
+
+  return threads;
+}
+
+/* 
+ * remove noise from a b/w bitmap and rotate it, metrics is the page probe
+ * or NULL to measure the bitmap itself 
+ */
+static ho_bitmap *
+hocr_bitmap_clean (const ho_bitmap * m_in,
+  HEBOCR_IMAGE_OPTIONS * image_options, const ho_page_metrics * metrics,
+  int *progress)
+{
+  ho_bitmap *bitmap_out = NULL;
+  ho_bitmap *bitmap_temp = NULL;
+  ho_page_metrics page_metrics;
+  double angle = 0.0;
+
+  /* remove very small and very large things */
+  bitmap_out =
+    ho_bitmap_filter_by_size_threads (m_in, 3,
+    3 * m_in->height / 4, 3, 3 * m_in->width / 4,
+    hocr_threads (image_options->threads));
+  if (!bitmap_out)
+    return NULL;
+
+  /* update progress */
+  *progress = 75;
+
+  /* rotate image */
+  if (image_options->rotation_angle != 0)
+    angle = image_options->rotation_angle;
+  else if (image_options->auto_rotate)
+  {
+    /* get fonts size and angle */
+    if (!metrics)
+    {
+      if (ho_dimentions_page_metrics (bitmap_out, 1,
+          hocr_threads (image_options->threads), &page_metrics))
+        return NULL;
+      metrics = &page_metrics;
+    }
+
+    /* a page with no clear lines is left as is */
+    if (metrics->angle_confidence >= HOCR_MIN_SKEW_CONFIDENCE)
+      angle = metrics->angle;
+  }
+
+  if (angle)
+  {
+    /* whole quarter turns are exact, small angles are sheared */
+    if (fmod (angle, 90.0) == 0.0)
+      bitmap_temp = ho_bitmap_rotate_right_angle (bitmap_out,
+        (int) (angle / 90.0));
+    else if (fabs (angle) <= HOCR_SHEAR_MAX_ANGLE)
+      bitmap_temp = ho_bitmap_shear_rotate (bitmap_out, angle);
+    else
+      bitmap_temp = ho_bitmap_rotate (bitmap_out, angle);
+    ho_bitmap_free (bitmap_out);
+    if (!bitmap_temp)
+      return NULL;
+
+    bitmap_out = bitmap_temp;
+  }
+
+  return bitmap_out;
+}
+
+/* auto scale makes fonts at least this many pixels high */
+#define HOCR_AUTO_SCALE_FONT_HEIGHT 30
+
+/* and scales images by at most this factor */
+#define HOCR_AUTO_SCALE_MAX 4
+
+/* 
+ * font height to scale the page from so fonts are 
+ * HOCR_AUTO_SCALE_FONT_HEIGHT pixels high, 0 if fonts are big enough 
+ */
+static int
+hocr_auto_scale_font_height (const ho_page_metrics * metrics)
+{
+  int font_height;
+
+  if (metrics->font_height <= 0
+    || metrics->font_height >= HOCR_AUTO_SCALE_FONT_HEIGHT)
+    return 0;
+
+  font_height = metrics->font_height;
+  if (font_height * HOCR_AUTO_SCALE_MAX < HOCR_AUTO_SCALE_FONT_HEIGHT)
+    font_height = (HOCR_AUTO_SCALE_FONT_HEIGHT + HOCR_AUTO_SCALE_MAX - 1)
+      / HOCR_AUTO_SCALE_MAX;
+
+  return font_height;
+}
+
+/* 
+ * threshold pix_in scaled by num / den 
+ */
+static ho_bitmap *
+hocr_pixbuf_to_bitmap_resampled (const ho_pixbuf * pix_in,
+  HEBOCR_IMAGE_OPTIONS * image_options, unsigned char size, int num, int den)
+{
+  HEBOCR_IMAGE_OPTIONS scaled_options = *image_options;
+  ho_pixbuf *pix_gray = NULL;
+  ho_pixbuf *pix_scaled = NULL;
+  ho_bitmap *bitmap_out = NULL;
+
+  /* if pix is color convert to gray scale */
+  if (pix_in->n_channels > 1)
+  {
+    pix_gray = ho_pixbuf_color_to_gray (pix_in);
+    if (!pix_gray)
+      return NULL;
+    pix_scaled = ho_pixbuf_resample (pix_gray, num, den);
+    ho_pixbuf_free (pix_gray);
+  }
+  else
+    pix_scaled = ho_pixbuf_resample (pix_in, num, den);
+  if (!pix_scaled)
+    return NULL;
+
+  /* the pixbuf is already scaled */
+  scaled_options.scale = 1;
+  bitmap_out = ho_pixbuf_to_bitmap_wrapper (pix_scaled, &scaled_options, size);
+  ho_pixbuf_free (pix_scaled);
+
+  return bitmap_out;
+}
+
+/* the page probe works on a copy this many times smaller */
+#define HOCR_PROBE_FACTOR 2
+
+/* 
+ * measure fonts and lines angle of pix_in on a decimated copy 
+ */
+static int
+hocr_page_probe (const ho_pixbuf * pix_in,
+  HEBOCR_IMAGE_OPTIONS * image_options, unsigned char size,
+  ho_page_metrics * metrics)
+{
+  ho_bitmap *bitmap_probe = NULL;
+  ho_bitmap *bitmap_temp = NULL;
+  int return_val;
+
+  bitmap_temp = hocr_pixbuf_to_bitmap_resampled (pix_in, image_options,
+    size, 1, HOCR_PROBE_FACTOR);
+  if (!bitmap_temp)
+    return TRUE;
+
+  /* remove very small and very large things */
+  bitmap_probe =
+    ho_bitmap_filter_by_size_threads (bitmap_temp, 2,
+    3 * bitmap_temp->height / 4, 2, 3 * bitmap_temp->width / 4,
+    hocr_threads (image_options->threads));
+  ho_bitmap_free (bitmap_temp);
+  if (!bitmap_probe)
+    return TRUE;
+
+  return_val =
+    ho_dimentions_page_metrics (bitmap_probe, HOCR_PROBE_FACTOR,
+    hocr_threads (image_options->threads), metrics);
+  ho_bitmap_free (bitmap_probe);
+
+  return return_val;
+}
+
+/* 
+ * measure fonts and lines angle of a b/w page 
+ */
+static int
+hocr_bitmap_probe (const ho_bitmap * m_in,
+  HEBOCR_IMAGE_OPTIONS * image_options, ho_page_metrics * metrics)
+{
+  ho_bitmap *bitmap_probe = NULL;
+  int return_val;
+
+  /* remove very small and very large things */
+  bitmap_probe =
+    ho_bitmap_filter_by_size_threads (m_in, 3,
+    3 * m_in->height / 4, 3, 3 * m_in->width / 4,
+    hocr_threads (image_options->threads));
+  if (!bitmap_probe)
+    return TRUE;
+
+  return_val =
+    ho_dimentions_page_metrics (bitmap_probe, 1,
+    hocr_threads (image_options->threads), metrics);
+  ho_bitmap_free (bitmap_probe);
+
+  return return_val;
+}
+
 /**
  convert a gray pixbuf to bitmap
 
@@ -47,88 +261,111 @@ ho_bitmap *hocr_image_processing (const ho_pixbuf * pix_in, HEBOCR_IMAGE_OPTIONS
 
   ho_bitmap *bitmap_out = NULL;
   ho_bitmap *bitmap_temp = NULL;
-  double angle = 0.0;
-  int scale_by = 0;
+  ho_page_metrics metrics;
+  int auto_scale, auto_rotate;
+  int font_height = 0;
   unsigned char size = 0;
 
   /* init progress */
   *progress = 0;
 
-  /* get the raw b/w bitmap from the pixbuf */
-  bitmap_temp = ho_pixbuf_to_bitmap_wrapper(pix_in, image_options, size);
-  if (!bitmap_temp)
-    return NULL;
-
-  /* update progress */
-  *progress = 25;
+  auto_scale = !image_options->scale && image_options->auto_scale;
+  auto_rotate = !image_options->rotation_angle && image_options->auto_rotate;
 
-  /* do we want to auto scale ? */
-  if (!image_options->scale && image_options->auto_scale)
+  /* measure the page once, for both scale and angle */
+  if (auto_scale || auto_rotate)
   {
-    /* get fonts size for autoscale */
-    if (ho_dimentions_font_width_height_nikud (bitmap_temp, 6, 200, 6, 200))
+    if (hocr_page_probe (pix_in, image_options, size, &metrics))
       return NULL;
 
-    /* if fonts are too small, re-scale image */
-    if (bitmap_temp->font_height < 15)
-      scale_by = 3;
-    else if (bitmap_temp->font_height < 30)
-      scale_by = 2;
-    else
-      scale_by = 1;
-
-    if (scale_by > 1)
-    {
-      /* re-create bitmap */
-      ho_bitmap_free (bitmap_temp);
-      bitmap_temp = ho_pixbuf_to_bitmap_wrapper (pix_in, image_options, size);
-      if (!bitmap_temp)
-        return NULL;
-    }
+    /* if fonts are too small, scale image just enough to make them
+     * HOCR_AUTO_SCALE_FONT_HEIGHT pixels high */
+    if (auto_scale)
+      font_height = hocr_auto_scale_font_height (&metrics);
   }
 
   /* update progress */
-  *progress = 50;
+  *progress = 25;
 
-  /* remove very small and very large things */
-  bitmap_out =
-    ho_bitmap_filter_by_size (bitmap_temp, 3, 3 * bitmap_temp->height / 4, 3,
-    3 * bitmap_temp->width / 4);
-  ho_bitmap_free (bitmap_temp);
-  if (!bitmap_out)
+  /* get the raw b/w bitmap from the pixbuf */
+  if (font_height)
+    bitmap_temp = hocr_pixbuf_to_bitmap_resampled (pix_in, image_options,
+      size, HOCR_AUTO_SCALE_FONT_HEIGHT, font_height);
+  else
+    bitmap_temp = ho_pixbuf_to_bitmap_wrapper (pix_in, image_options, size);
+  if (!bitmap_temp)
     return NULL;
 
   /* update progress */
-  *progress = 75;
+  *progress = 50;
 
-  /* rotate image */
-  if (image_options->rotation_angle != 0)
+  bitmap_out = hocr_bitmap_clean (bitmap_temp, image_options,
+    (auto_rotate) ? &metrics : NULL, progress);
+  ho_bitmap_free (bitmap_temp);
+
+  return bitmap_out;
+}
+
+ho_bitmap *
+hocr_bitmap_processing (const ho_bitmap * m_in,
+  HEBOCR_IMAGE_OPTIONS * image_options, int *progress)
+{
+  ho_pixbuf *pix = NULL;
+  ho_bitmap *bitmap_out = NULL;
+  ho_bitmap *bitmap_temp = NULL;
+  ho_page_metrics metrics;
+  int auto_scale, auto_rotate;
+  int font_height = 0;
+
+  /* init progress */
+  *progress = 0;
+
+  auto_scale = !image_options->scale && image_options->auto_scale;
+  auto_rotate = !image_options->rotation_angle && image_options->auto_rotate;
+
+  /* measure the page once, for both scale and angle */
+  if (auto_scale || auto_rotate)
   {
-    bitmap_temp = ho_bitmap_rotate(bitmap_out, image_options->rotation_angle);
-    ho_bitmap_free (bitmap_out);
-    if (!bitmap_temp)
+    if (hocr_bitmap_probe (m_in, image_options, &metrics))
       return NULL;
 
-    bitmap_out = bitmap_temp;
+    if (auto_scale)
+      font_height = hocr_auto_scale_font_height (&metrics);
   }
-  else if (image_options->auto_rotate)
-  {
-    /* get fonts size for auto angle */
-    if (ho_dimentions_font_width_height_nikud (bitmap_out, 6, 200, 6, 200))
-      return NULL;
 
-    angle = ho_dimentions_get_lines_angle (bitmap_out);
-    if (angle)
-    {
-      bitmap_temp = ho_bitmap_rotate (bitmap_out, angle);
-      ho_bitmap_free (bitmap_out);
-      if (!bitmap_temp)
-        return NULL;
+  /* update progress */
+  *progress = 25;
 
-      bitmap_out = bitmap_temp;
-    }
+  /* the input is already b/w, no need to threshold */
+  if (image_options->scale <= 1 && !font_height)
+  {
+    *progress = 50;
+
+    return hocr_bitmap_clean (m_in, image_options,
+      (auto_rotate) ? &metrics : NULL, progress);
   }
 
+  /* scaling needs the gray pixels */
+  pix = ho_pixbuf_new_from_bitmap (m_in);
+  if (!pix)
+    return NULL;
+
+  if (font_height)
+    bitmap_temp = hocr_pixbuf_to_bitmap_resampled (pix, image_options, 0,
+      HOCR_AUTO_SCALE_FONT_HEIGHT, font_height);
+  else
+    bitmap_temp = ho_pixbuf_to_bitmap_wrapper (pix, image_options, 0);
+  ho_pixbuf_free (pix);
+  if (!bitmap_temp)
+    return NULL;
+
+  /* update progress */
+  *progress = 50;
+
+  bitmap_out = hocr_bitmap_clean (bitmap_temp, image_options,
+    (auto_rotate) ? &metrics : NULL, progress);
+  ho_bitmap_free (bitmap_temp);
+
   return bitmap_out;
 }
 
@@ -150,202 +387,324 @@ hocr_layout_analysis (const ho_bitmap * m_in,
   int *progress)
 {
   int cols = layout_options->paragraph_setup;
-  int block_index;
-  int line_index;
-  int word_index;
 
   ho_layout *layout_out = NULL;
 
   /* init progress */
   *progress = 0;
 
-  /* check paragraph_setup */
-  if (!cols)
-    cols = ho_dimentions_get_columns (m_in);
-
   /* create a new layout */
   layout_out = ho_layout_new (m_in, layout_options->font_spacing_code, cols, layout_options->dir_ltr);
   if (!layout_out)
     return NULL;
 
+  /* check paragraph_setup, the page was labeled by the new layout */
+  if (!cols)
+    layout_out->type = layout_out->page_analysis->n_columns;
+
   *progress = 10;
   ho_layout_create_block_mask (layout_out);
 
-  /* look for lines inside blocks */
-  for (block_index = 0; block_index < layout_out->n_blocks; block_index++)
+  /* look for lines, words and fonts inside blocks */
+  ho_layout_create_masks_threads (layout_out,
+    layout_options->slicing_threshold, layout_options->slicing_width,
+    layout_options->line_leeway, hocr_threads (layout_options->threads),
+    progress);
+
+  return layout_out;
+}
+
+/* 
+ * a glyph recognized on its own, the linguistics adjustment that needs the
+ * glyph before it is done later in reading order 
+ */
+typedef struct
+{
+  unsigned char has_font;
+  unsigned char has_nikud;
+  double array_out[HO_ARRAY_OUT_SIZE];
+  const char *font_nikud;
+  const char *font_dagesh;
+  const char *font_shin;
+} hocr_glyph;
+
+/* 
+ * recognize the main sign and nikud of one font of a flat layout 
+ */
+static int
+hocr_glyph_recognize (const ho_layout_flat * l_flat, const int font_index,
+  const HEBOCR_FONT_OPTIONS * font_options, hocr_glyph * glyph)
+{
+  ho_bitmap_view v_text;
+  ho_bitmap *m_mask = NULL;
+  ho_bitmap *m_font_main_sign = NULL;
+  ho_bitmap *m_font_nikud = NULL;
+  double array_in[HO_ARRAY_IN_SIZE];
+
+  glyph->has_font = FALSE;
+  glyph->has_nikud = FALSE;
+
+  /* get the font, a view into the page text */
+  if (ho_layout_flat_get_font_view (l_flat, font_index, &v_text))
+    return TRUE;
+
+  /* get font line mask */
+  m_mask = ho_layout_flat_get_font_line_mask (l_flat, font_index);
+  if (!m_mask)
+    return TRUE;
+
+  /* get font main sign */
+  m_font_main_sign = ho_font_main_sign_view (&v_text, m_mask);
+  if (!m_font_main_sign)
   {
-    ho_layout_create_line_mask (layout_out, block_index);
+    ho_bitmap_free (m_mask);
+    return TRUE;
+  }
 
-    /* look for words inside line */
-    for (line_index = 0; line_index < layout_out->n_lines[block_index];
-      line_index++)
+  /* recognize font from images */
+  ho_recognize_create_array_in (m_font_main_sign, m_mask, array_in);
+  ho_recognize_create_array_out (array_in, glyph->array_out,
+    font_options->font_code);
+  glyph->has_font = TRUE;
+
+  /* get font nikud */
+  if (font_options->nikud)
+  {
+    m_font_nikud = ho_bitmap_new_from_view (&v_text);
+    if (m_font_nikud)
     {
-      ho_layout_create_word_mask (layout_out, block_index, line_index);
+      ho_bitmap_andnot (m_font_nikud, m_font_main_sign);
 
-      /* look for fonts inside word */
-      for (word_index = 0;
-        word_index < layout_out->n_words[block_index][line_index]; word_index++)
-      {
-        ho_layout_create_font_mask (layout_out, block_index, line_index,
-	  word_index, layout_options->slicing_threshold, layout_options->slicing_width, layout_options->line_leeway);
-      }
+      /* recognize font from images */
+      glyph->font_nikud = ho_recognize_nikud (m_font_nikud, m_mask,
+        font_options->font_code, &(glyph->font_dagesh),
+        &(glyph->font_shin));
+      glyph->has_nikud = TRUE;
 
-      /* update progress */
-      *progress = 100 *
-        ((double) block_index /
-        (double) layout_out->n_blocks +
-        (double) line_index /
-        (double) (layout_out->n_lines[block_index] * layout_out->n_blocks));
+      ho_bitmap_free (m_font_nikud);
     }
   }
 
-  return layout_out;
+  /* free bitmaps */
+  ho_bitmap_free (m_font_main_sign);
+  ho_bitmap_free (m_mask);
+
+  return (font_options->nikud && !glyph->has_nikud);
 }
 
-/**
- fill a text buffer with fonts recognized from a page layout
+#ifdef USE_PTHREADS
 
- @param l_page the page layout to recognize
- @param s_text_out the text buffer to fill
- @param html output format is html
- @param font_code code for the font to use
- @param nikud recognize nikud
- @param progress a progress indicator 0..100
- @return FALSE
+/* fonts taken by a thread at a time */
+#define HOCR_GLYPHS_PER_JOB 8
+
+/* fonts of a page shared by the recognition threads */
+typedef struct
+{
+  const ho_layout_flat *l_flat;
+  const HEBOCR_FONT_OPTIONS *font_options;
+  hocr_glyph *glyphs;
+  pthread_mutex_t lock;
+  int next_glyph;
+  int n_done;
+  int *progress;
+} hocr_glyph_jobs;
+
+static void *
+hocr_glyph_worker (void *arg)
+{
+  hocr_glyph_jobs *jobs = (hocr_glyph_jobs *) arg;
+  int n_fonts = jobs->l_flat->n_fonts;
+  int first, last;
+  int i;
+
+  pthread_mutex_lock (&jobs->lock);
+
+  while (jobs->next_glyph < n_fonts)
+  {
+    /* take the next fonts waiting */
+    first = jobs->next_glyph;
+    last = first + HOCR_GLYPHS_PER_JOB;
+    if (last > n_fonts)
+      last = n_fonts;
+    jobs->next_glyph = last;
+    pthread_mutex_unlock (&jobs->lock);
+
+    for (i = first; i < last; i++)
+      hocr_glyph_recognize (jobs->l_flat, i, jobs->font_options,
+        jobs->glyphs + i);
+
+    pthread_mutex_lock (&jobs->lock);
+
+    /* update progress */
+    jobs->n_done += last - first;
+    *(jobs->progress) = 100 * jobs->n_done / n_fonts;
+  }
+
+  pthread_mutex_unlock (&jobs->lock);
+
+  return NULL;
+}
+
+#endif /* USE_PTHREADS */
+
+/* 
+ * recognize all the fonts of a flat layout, each into its own glyph 
  */
-int hocr_font_recognition( const ho_layout* l_page, ho_string* s_text_out, HEBOCR_FONT_OPTIONS *font_options, int html, int* progress )
+static void
+hocr_glyphs_recognize (const ho_layout_flat * l_flat,
+  const HEBOCR_FONT_OPTIONS * font_options, hocr_glyph * glyphs,
+  int *progress)
+{
+  int i;
+#ifdef USE_PTHREADS
+  hocr_glyph_jobs jobs;
+  pthread_t threads[HEBOCR_MAX_THREADS];
+  int started[HEBOCR_MAX_THREADS];
+  int n_threads;
+
+  /* one thread is the serial recognizer */
+  n_threads = hocr_threads (font_options->threads);
+  if (n_threads > l_flat->n_fonts / HOCR_GLYPHS_PER_JOB)
+    n_threads = l_flat->n_fonts / HOCR_GLYPHS_PER_JOB;
+
+  if (n_threads > 1)
+  {
+    jobs.l_flat = l_flat;
+    jobs.font_options = font_options;
+    jobs.glyphs = glyphs;
+    jobs.next_glyph = 0;
+    jobs.n_done = 0;
+    jobs.progress = progress;
+    pthread_mutex_init (&jobs.lock, NULL);
+
+    /* threads that failed to start leave their share to the others */
+    for (i = 1; i < n_threads; i++)
+      started[i] =
+        !pthread_create (&threads[i], NULL, hocr_glyph_worker, &jobs);
+
+    hocr_glyph_worker (&jobs);
+
+    for (i = 1; i < n_threads; i++)
+      if (started[i])
+        pthread_join (threads[i], NULL);
+
+    pthread_mutex_destroy (&jobs.lock);
+
+    return;
+  }
+#endif /* USE_PTHREADS */
+
+  for (i = 0; i < l_flat->n_fonts; i++)
+  {
+    hocr_glyph_recognize (l_flat, i, font_options, glyphs + i);
+
+    /* update progress */
+    *progress = 100 * (i + 1) / l_flat->n_fonts;
+  }
+}
+
+/* 
+ * fill a text buffer with fonts recognized from a flat page layout 
+ */
+static int
+hocr_flat_font_recognition (const ho_layout_flat * l_flat,
+  ho_string * s_text_out, HEBOCR_FONT_OPTIONS * font_options, int html,
+  int *progress)
 {
+  const ho_layout_block *block;
+  const ho_layout_line *line;
+  const ho_layout_word *word;
+  hocr_glyph *glyphs;
+  hocr_glyph *glyph;
   int block_index;
   int line_index;
   int word_index;
   int font_index;
-  int current_font_number = 0;
-  int number_of_fonts = l_page->number_of_fonts;
-  ho_bitmap *m_text = NULL;
-  ho_bitmap *m_mask = NULL;
-  ho_bitmap *m_font_main_sign = NULL;
-  ho_bitmap *m_font_nikud = NULL;
+  unsigned char word_end;
+  unsigned char word_start;
+  int last_char_i;
+  int char_i;
 
   char text_out[200];
+  double array_out[HO_ARRAY_OUT_SIZE];
   const char *font;
-  const char *font_nikud;
-  const char *font_dagesh;
-  const char *font_shin;
-
-  /* init progress */
-  *progress = 0;
 
-  /* did we get a text buffer and a layout ? */
-  if (!s_text_out || !l_page)
+  /* recognize all fonts, they do not depend on each other */
+  glyphs = (hocr_glyph *) malloc ((l_flat->n_fonts + 1) * sizeof (hocr_glyph));
+  if (!glyphs)
     return TRUE;
 
+  hocr_glyphs_recognize (l_flat, font_options, glyphs, progress);
+
   /* loop over the layout */
-  for (block_index = 0; block_index < l_page->n_blocks; block_index++)
+  for (block_index = 0; block_index < l_flat->n_blocks; block_index++)
   {
+    block = l_flat->blocks + block_index;
+
     /* start of paragraph */
     if (html)
     {
       /* FIXME: text overflow ?! */
       sprintf (text_out,
         "    <div class=\"ocr_par\" id=\"par_%d\" title=\"bbox %d %d %d %d\">\n",
-        block_index + 1, l_page->m_blocks_text[block_index]->x,
-        l_page->m_blocks_text[block_index]->y,
-        l_page->m_blocks_text[block_index]->x +
-        l_page->m_blocks_text[block_index]->width,
-        l_page->m_blocks_text[block_index]->y +
-        l_page->m_blocks_text[block_index]->height);
+        block_index + 1, block->x, block->y, block->x + block->width,
+        block->y + block->height);
       ho_string_cat (s_text_out, text_out);
     }
 
-    for (line_index = 0; line_index < l_page->n_lines[block_index];
-      line_index++)
+    for (line_index = block->first_line;
+      line_index < block->first_line + block->n_lines; line_index++)
     {
+      line = l_flat->lines + line_index;
+
       /* start of line */
 
       /* loop on all the words in this line */
-      for (word_index = 0;
-        word_index < l_page->n_words[block_index][line_index]; word_index++)
+      for (word_index = line->first_word;
+        word_index < line->first_word + line->n_words; word_index++)
       {
-        int word_length = l_page->n_fonts[block_index][line_index][word_index];
-
-        unsigned char word_end = FALSE;
-
-        unsigned char word_start = TRUE;
-
-        int last_char_i = 0;
-
-        int char_i = 0;
+        word = l_flat->words + word_index;
+        char_i = 0;
 
         /* start of word */
-        for (font_index = 0; font_index < word_length; font_index++)
+        for (font_index = word->first_font;
+          font_index < word->first_font + word->n_fonts; font_index++)
         {
-          word_end = (font_index == (word_length - 1));
-          word_start = (font_index == 0);
+          word_end = (font_index == (word->first_font + word->n_fonts - 1));
+          word_start = (font_index == word->first_font);
+          glyph = glyphs + font_index;
 
-          /* get font images */
-
-          /* get the font */
-          m_text =
-            ho_layout_get_font_text (l_page, block_index,
-            line_index, word_index, font_index);
-          if (!m_text)
-            return TRUE;
-
-          /* get font line mask */
-          m_mask =
-            ho_layout_get_font_line_mask (l_page, block_index,
-            line_index, word_index, font_index);
-          if (!m_mask)
-            return TRUE;
-
-          /* get font main sign */
-          m_font_main_sign = ho_font_main_sign (m_text, m_mask);
-          if (!m_font_main_sign)
+          if (!glyph->has_font)
+          {
+            free (glyphs);
             return TRUE;
+          }
 
-          /* recognize font from images */
+          /* linguistics need the font before this one */
           last_char_i = char_i;
-          font =
-            ho_recognize_font (m_font_main_sign, m_mask,
-	    font_options->font_code, font_options->do_linguistics, word_end, word_start, &char_i,
-            last_char_i);
+          memcpy (array_out, glyph->array_out, sizeof (array_out));
+          if (font_options->do_linguistics)
+            ho_linguistics_adjust_array_out (array_out, word_end,
+              word_start, last_char_i);
+
+          font = ho_recognize_array_out_to_font (array_out, &char_i);
 
           /* insert font to text out */
           ho_string_cat (s_text_out, font);
 
-          /* get font nikud */
-	  if (font_options->nikud)
+          /* insert font nikud to text out */
+          if (font_options->nikud)
           {
-            m_font_nikud = ho_bitmap_clone (m_text);
-            if (!m_font_nikud)
+            if (!glyph->has_nikud)
+            {
+              free (glyphs);
               return TRUE;
-            ho_bitmap_andnot (m_font_nikud, m_font_main_sign);
-
-            /* recognize font from images */
-            font_nikud = ho_recognize_nikud (m_font_nikud, m_mask,
-	      font_options->font_code, &font_dagesh, &font_shin);
-
-            /* free bitmaps */
-            ho_bitmap_free (m_font_nikud);
-            m_font_nikud = NULL;
+            }
 
-            /* insert font nikud to text out */
-            ho_string_cat (s_text_out, font_shin);
-            ho_string_cat (s_text_out, font_dagesh);
-            ho_string_cat (s_text_out, font_nikud);
+            ho_string_cat (s_text_out, glyph->font_shin);
+            ho_string_cat (s_text_out, glyph->font_dagesh);
+            ho_string_cat (s_text_out, glyph->font_nikud);
           }
-
-          /* free bitmaps */
-          ho_bitmap_free (m_font_main_sign);
-          ho_bitmap_free (m_text);
-          ho_bitmap_free (m_mask);
-
-          /* this are empty pointers */
-          m_text = m_mask = m_font_main_sign = NULL;
-
-          /* update progress */
-          current_font_number++;
-          *progress = 100 * current_font_number / number_of_fonts;
         }
 
         /* end of word */
@@ -366,29 +725,143 @@ int hocr_font_recognition( const ho_layout* l_page, ho_string* s_text_out, HEBOC
       ho_string_cat (s_text_out, "\n");
   }
 
+  free (glyphs);
+
   return FALSE;
 }
 
+/**
+ fill a text buffer with fonts recognized from a page layout
+
+ @param l_page the page layout to recognize
+ @param s_text_out the text buffer to fill
+ @param html output format is html
+ @param font_code code for the font to use
+ @param nikud recognize nikud
+ @param progress a progress indicator 0..100
+ @return FALSE
+ */
+int hocr_font_recognition( const ho_layout* l_page, ho_string* s_text_out, HEBOCR_FONT_OPTIONS *font_options, int html, int* progress )
+{
+  ho_layout_flat *l_flat = NULL;
+  int return_val;
+
+  /* init progress */
+  *progress = 0;
+
+  /* did we get a text buffer and a layout ? */
+  if (!s_text_out || !l_page)
+    return TRUE;
+
+  /* fonts are read from the flat copy of the layout */
+  l_flat = ho_layout_flat_new (l_page);
+  if (!l_flat)
+    return TRUE;
+
+  return_val = hocr_flat_font_recognition (l_flat, s_text_out, font_options,
+    html, progress);
+  ho_layout_flat_free (l_flat);
+
+  return return_val;
+}
+
+/* 
+ * layout and recognize a processed page, m_in is freed once the layout is 
+ * made 
+ */
+static int
+hocr_page_ocr (ho_bitmap * m_in, ho_string * s_text_out,
+  HEBOCR_LAYOUT_OPTIONS * layout_options, HEBOCR_FONT_OPTIONS * font_options,
+  int *progress)
+{
+  ho_layout *l_page = NULL;
+  ho_layout_flat *l_flat = NULL;
+  int return_val;
+
+  l_page = hocr_layout_analysis (m_in, layout_options, progress);
+  ho_bitmap_free (m_in);
+  if (!l_page)
+    return TRUE;
+
+  /* keep only the flat layout while fonts are recognized */
+  l_flat = ho_layout_flat_new (l_page);
+  ho_layout_free (l_page);
+  if (!l_flat)
+    return TRUE;
+
+  /* init progress */
+  *progress = 0;
+
+  return_val = hocr_flat_font_recognition (l_flat, s_text_out, font_options,
+    layout_options->html, progress);
+  ho_layout_flat_free (l_flat);
+
+  return return_val;
+}
+
 int hocr_do_ocr_fine (const ho_pixbuf * pix_in, ho_string * s_text_out, HEBOCR_IMAGE_OPTIONS *options, HEBOCR_LAYOUT_OPTIONS* layout_options, HEBOCR_FONT_OPTIONS *font_options, int *progress)
 {
   ho_bitmap *m_in = NULL;
-  ho_layout *l_page = NULL;
-  if (!pix_in)
+
+  if (!pix_in || !s_text_out)
     return TRUE;
 
   m_in = hocr_image_processing( pix_in, options,progress);
   if (!m_in)
     return TRUE;
 
-  l_page = hocr_layout_analysis (m_in, layout_options, progress);
+  return hocr_page_ocr (m_in, s_text_out, layout_options, font_options,
+    progress);
+}
 
-  if (!l_page)
-  {
-    ho_bitmap_free (m_in);
+int
+hocr_do_ocr_bitmap_fine (const ho_bitmap * m_in, ho_string * s_text_out,
+  HEBOCR_IMAGE_OPTIONS * options, HEBOCR_LAYOUT_OPTIONS * layout_options,
+  HEBOCR_FONT_OPTIONS * font_options, int *progress)
+{
+  ho_bitmap *m_clean = NULL;
+
+  if (!m_in || !s_text_out)
     return TRUE;
-  }
 
-  return hocr_font_recognition( l_page, s_text_out, font_options, layout_options->html, progress );
+  m_clean = hocr_bitmap_processing (m_in, options, progress);
+  if (!m_clean)
+    return TRUE;
+
+  return hocr_page_ocr (m_clean, s_text_out, layout_options, font_options,
+    progress);
+}
+
+/* 
+ * fill the options hocr_do_ocr uses 
+ */
+static void
+hocr_default_options (const unsigned char html, int font_code,
+  const unsigned char do_linguistics, HEBOCR_IMAGE_OPTIONS * options,
+  HEBOCR_LAYOUT_OPTIONS * layout_options, HEBOCR_FONT_OPTIONS * font_options)
+{
+  options->adaptive = 0;
+  options->a_threshold = 0;
+  options->auto_rotate = 1;
+  options->auto_scale = 1;
+  options->rotation_angle = 0;
+  options->scale = 0;
+  options->threshold = 0;
+  options->threads = HEBOCR_DEFAULT_THREADS;
+
+  layout_options->font_spacing_code = 0;
+  layout_options->paragraph_setup = 0;
+  layout_options->slicing_threshold = 0;
+  layout_options->slicing_width = 0;
+  layout_options->line_leeway = 0;
+  layout_options->dir_ltr = 0;
+  layout_options->html = html;
+  layout_options->threads = HEBOCR_DEFAULT_THREADS;
+
+  font_options->do_linguistics = do_linguistics;
+  font_options->font_code = font_code;
+  font_options->nikud = 1;
+  font_options->threads = HEBOCR_DEFAULT_THREADS;
 }
 
 int hocr_do_ocr( const ho_pixbuf * pix_in, ho_string * s_text_out, const unsigned char html, int font_code, const unsigned char do_linguistics, int *progress )
@@ -397,29 +870,84 @@ int hocr_do_ocr( const ho_pixbuf * pix_in, ho_string * s_text_out, const unsigne
 	HEBOCR_LAYOUT_OPTIONS layout_options;
 	HEBOCR_FONT_OPTIONS   font_options;
 
-	options.adaptive = 0;
-	options.a_threshold = 0;
-	options.auto_rotate = 1;
-	options.auto_scale = 1;
-	options.rotation_angle = 0;
-	options.scale = 0;
-	options.threshold = 0;
-	
-	layout_options.font_spacing_code = 0;
-	layout_options.paragraph_setup = 0;
-	layout_options.slicing_threshold = 0;
-	layout_options.slicing_width = 0;
-	layout_options.line_leeway = 0;
-	layout_options.dir_ltr = 0;
-	layout_options.html = html;
-
-	font_options.do_linguistics = do_linguistics;
-	font_options.font_code = font_code;
-	font_options.nikud  = 1;
+	hocr_default_options (html, font_code, do_linguistics, &options,
+		&layout_options, &font_options);
 
 	return hocr_do_ocr_fine( pix_in, s_text_out, &options, &layout_options, &font_options, progress);
 }
 
+int
+hocr_do_ocr_bitmap (const ho_bitmap * m_in, ho_string * s_text_out,
+  const unsigned char html, int font_code,
+  const unsigned char do_linguistics, int *progress)
+{
+  HEBOCR_IMAGE_OPTIONS options;
+  HEBOCR_LAYOUT_OPTIONS layout_options;
+  HEBOCR_FONT_OPTIONS font_options;
+
+  hocr_default_options (html, font_code, do_linguistics, &options,
+    &layout_options, &font_options);
+
+  return hocr_do_ocr_bitmap_fine (m_in, s_text_out, &options,
+    &layout_options, &font_options, progress);
+}
+
+#ifdef USE_TIFF
+int
+hocr_do_ocr_tiff (const char *filename, ho_string * s_text_out,
+  const unsigned char html, int font_code,
+  const unsigned char do_linguistics, int *progress)
+{
+  HEBOCR_IMAGE_OPTIONS options;
+  HEBOCR_LAYOUT_OPTIONS layout_options;
+  HEBOCR_FONT_OPTIONS font_options;
+  ho_pixbuf_tiff_reader *reader = NULL;
+  ho_bitmap *m = NULL;
+  ho_pixbuf *pix = NULL;
+  int return_val = FALSE;
+
+  if (!filename || !s_text_out)
+    return TRUE;
+
+  hocr_default_options (html, font_code, do_linguistics, &options,
+    &layout_options, &font_options);
+
+  /* the next page is decoded while this one is recognized */
+  reader = ho_pixbuf_tiff_reader_new (filename, TRUE);
+  if (!reader)
+    return TRUE;
+
+  while (!ho_pixbuf_tiff_reader_next (reader, &m, &pix)
+    || ho_pixbuf_tiff_reader_failed (reader))
+  {
+    /* a broken page, go on to the next one */
+    if (ho_pixbuf_tiff_reader_failed (reader))
+    {
+      return_val = TRUE;
+      continue;
+    }
+
+    /* b/w pages are not thresholded again */
+    if (m)
+    {
+      return_val |= hocr_do_ocr_bitmap_fine (m, s_text_out, &options,
+        &layout_options, &font_options, progress);
+      ho_bitmap_free (m);
+    }
+    else
+    {
+      return_val |= hocr_do_ocr_fine (pix, s_text_out, &options,
+        &layout_options, &font_options, progress);
+      ho_pixbuf_free (pix);
+    }
+  }
+
+  ho_pixbuf_tiff_reader_free (reader);
+
+  return return_val;
+}
+#endif /* USE_TIFF */
+
 const char *
 hocr_get_build_string ()
 {
@@ -59,12 +59,34 @@ extern "C"
 #include <ho_bitmap.h>
 #include <ho_string.h>
 
+/**
+ threshold, clean and rotate a pixbuf
+
+ @param pix_in the input ho_pixbuf
+ @param image_options image process options, threads must be set to
+  1..HEBOCR_MAX_THREADS, other values use one thread
+ @param progress a progress indicator 0..100
+ @return newly allocated b/w ho_bitmap
+ */
 ho_bitmap *hocr_image_processing( const ho_pixbuf* pix_in, HEBOCR_IMAGE_OPTIONS* image_options, int* progress );
 
+/**
+ clean and rotate a b/w bitmap, like hocr_image_processing without the 
+ thresholding
+
+ @param m_in the input b/w ho_bitmap
+ @param image_options image process options, threads must be set as for
+  hocr_image_processing
+ @param progress a progress indicator 0..100
+ @return newly allocated b/w ho_bitmap
+ */
+ho_bitmap *hocr_bitmap_processing( const ho_bitmap* m_in, HEBOCR_IMAGE_OPTIONS* image_options, int* progress );
+
 /**
  new ho_layout 
  @param m_in a pointer to a text bitmap
- @param layout_options image layout options
+ @param layout_options image layout options, threads must be set to
+  1..HEBOCR_MAX_THREADS, other values use one thread
  @param progress a progress indicator 0..100
  @return a newly allocated and filled layout
  */
@@ -75,7 +97,8 @@ ho_layout *hocr_layout_analysis( const ho_bitmap* m_in, HEBOCR_LAYOUT_OPTIONS* l
 
  @param l_page the page layout to recognize
  @param s_text_out the text buffer to fill
- @param font_options  the font options to be used when recognizing text
+ @param font_options  the font options to be used when recognizing text,
+  threads must be set to 1..HEBOCR_MAX_THREADS, other values use one thread
  @param html output HTML or plain text
  @param progress a progress indicator 0..100
  @return FALSE
@@ -87,9 +110,12 @@ int hocr_font_recognition( const ho_layout* l_page, ho_string* s_text_out, HEBOC
 
  @param pix_in the input ho_pixbuf
  @param s_text_out the text buffer to fill
- @param options image options to be used
- @param layout_options layout options to be used
- @param font_options font options to be user
+ @param options image options to be used, threads must be set as for
+  hocr_image_processing
+ @param layout_options layout options to be used, threads must be set as
+  for hocr_layout_analysis
+ @param font_options font options to be user, threads must be set as for
+  hocr_font_recognition
  @param progress a progress indicator 0..100
  @return FALSE
  */
@@ -107,6 +133,47 @@ int hocr_do_ocr_fine( const ho_pixbuf * pix_in, ho_string * s_text_out, HEBOCR_I
  */
 int hocr_do_ocr( const ho_pixbuf * pix_in, ho_string * s_text_out, const unsigned char html, int font_code, const unsigned char do_linguistics, int *progress );
 
+ /**
+ do ocr on a b/w bitmap, like hocr_do_ocr_fine without the thresholding
+
+ @param m_in the input b/w ho_bitmap, e.g. from ho_pixbuf_pnm_load_bitmap
+ @param s_text_out the text buffer to fill
+ @param options image options to be used, threads must be set as for
+  hocr_image_processing
+ @param layout_options layout options to be used, threads must be set as
+  for hocr_layout_analysis
+ @param font_options font options to be user, threads must be set as for
+  hocr_font_recognition
+ @param progress a progress indicator 0..100
+ @return FALSE
+ */
+int hocr_do_ocr_bitmap_fine( const ho_bitmap * m_in, ho_string * s_text_out, HEBOCR_IMAGE_OPTIONS *options, HEBOCR_LAYOUT_OPTIONS *layout_options, HEBOCR_FONT_OPTIONS *font_options, int *progress);
+
+ /**
+ do ocr on a b/w bitmap, using default values
+
+ @param m_in the input b/w ho_bitmap, e.g. from ho_pixbuf_pnm_load_bitmap
+ @param s_text_out the text buffer to fill
+ @param html output format is html
+ @param font_code code for the font to use
+ @param progress a progress indicator 0..100
+ @return FALSE
+ */
+int hocr_do_ocr_bitmap( const ho_bitmap * m_in, ho_string * s_text_out, const unsigned char html, int font_code, const unsigned char do_linguistics, int *progress );
+
+ /**
+ do ocr on all the pages of a tiff file, using default values
+
+ @param filename file name of tiff file
+ @param s_text_out the text buffer to fill, pages are added one after the
+  other
+ @param html output format is html
+ @param font_code code for the font to use
+ @param progress a progress indicator 0..100 of the current page
+ @return FALSE, TRUE if the file or one of its pages could not be read
+ */
+int hocr_do_ocr_tiff( const char *filename, ho_string * s_text_out, const unsigned char html, int font_code, const unsigned char do_linguistics, int *progress );
+
 /**
  return the build string
 